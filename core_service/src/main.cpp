@@ -24,11 +24,15 @@ int main(int argc, char** argv)
 
     parse_settings(std::string(argv[1]), network, host, tx_port, path, known_hash, key, core_list);
 
-    auto thread_count = std::thread::hardware_concurrency() - 1;
-    boost::asio::io_context io_context(thread_count);
-    auto&& [threads, work] = metahash::pool::thread_pool(io_context, thread_count);
-
-    BlockChainController blockChainController(io_context, key, path, known_hash, core_list, { host, tx_port });
+    // io_context только для сети и консенсуса: подписи проверяются в cpu_pool,
+    // у цепочки и записи на диск свои потоки внутри контроллера
+    auto cpu_thread_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    auto io_thread_count = std::max(std::thread::hardware_concurrency() / 4, 2u);
+    metahash::pool::CpuPool cpu_pool(cpu_thread_count);
+    boost::asio::io_context io_context(io_thread_count);
+    auto&& [threads, work] = metahash::pool::thread_pool(io_context, io_thread_count);
+
+    BlockChainController blockChainController(io_context, cpu_pool, key, path, known_hash, core_list, { host, tx_port });
 
     libevent(io_context, blockChainController.get_wallet_statistics(), blockChainController.get_wallet_request_addresses(), "wsstata.metahash.io", 80, "net-test");
 
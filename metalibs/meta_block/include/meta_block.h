@@ -6,6 +6,20 @@
 
 namespace metahash::block {
 
+// Доказательство включения транзакции: позиция листа, число листьев и соседние узлы до корня
+struct TxProof {
+    uint64_t index = 0;
+    uint64_t count = 0;
+    std::vector<sha256_2> path;
+};
+
+// Дерево Меркла хешей транзакций; непарный узел переходит на уровень выше без изменений.
+// Лист - SHA-256d(0x00 || хеш транзакции), узел - SHA-256d(0x01 || левый || правый),
+// корень - SHA-256d(0x02 || число листьев, 8 байт LE || вершина дерева)
+sha256_2 get_merkle_root(std::vector<sha256_2> hashes);
+bool get_merkle_proof(std::vector<sha256_2> hashes, uint64_t index, TxProof& proof);
+bool check_tx_proof(const sha256_2& tx_hash, const TxProof& proof, const sha256_2& root);
+
 class Block {
 protected:
     std::vector<char> data;
@@ -30,14 +44,49 @@ class CommonBlock : public Block {
 private:
     static const uint8_t tx_buff = 80;
 
+    std::vector<sha256_2> tx_hashes;
+
 public:
     virtual ~CommonBlock() override = default;
 
     uint64_t get_block_type() const override;
+    sha256_2 get_tx_hash() const;
+    bool has_tx_merkle_root() const;
 
-    const std::vector<transaction::TX> get_txs(boost::asio::io_context& io_context) const;
+    const std::vector<transaction::TX> get_txs(pool::CpuPool& cpu_pool) const;
+    bool get_tx_proof(const sha256_2& tx_hash, TxProof& proof) const;
 
     bool parse(std::string_view block_sw) override;
+    bool make(std::vector<char>&& block_buff, std::vector<sha256_2>&& new_tx_hashes);
+};
+
+// Сборка блока в одном буфере: место под заголовок резервируется сразу, хеш транзакций
+// считается по мере записи, готовый буфер переходит в блок без копии и повторного разбора
+class BlockBuilder {
+private:
+    static const uint8_t tx_buff = 80;
+
+    std::vector<char> buff;
+    bool merkle_root;
+    crypto::Sha256Stream tx_stream;
+    std::vector<sha256_2> tx_hashes;
+    uint64_t unhashed_offset = tx_buff;
+
+    void hash_txs(uint64_t offset);
+    void hash_pending();
+
+public:
+    BlockBuilder(uint64_t block_type, uint64_t timestamp, const sha256_2& prev_hash);
+
+    bool has_merkle_root() const;
+    void reserve(uint64_t txs_size);
+
+    void add_tx(const std::vector<char>& tx);
+    void add_tx(const std::vector<char>& raw_tx, uint64_t state);
+    void add_txs(const std::vector<char>& txs);
+    void add_txs(const std::vector<char>& txs, const std::vector<sha256_2>& hashes);
+
+    CommonBlock* make();
 };
 
 class ApproveBlock : public Block {
@@ -0,0 +1,115 @@
+#include <meta_block.h>
+#include <meta_constants.hpp>
+#include <meta_crypto.h>
+#include <meta_log.hpp>
+
+namespace metahash::block {
+
+BlockBuilder::BlockBuilder(uint64_t block_type, uint64_t timestamp, const sha256_2& prev_hash)
+    : merkle_root(timestamp >= TX_MERKLE_ROOT_TIMESTAMP)
+{
+    buff.reserve(tx_buff + 1);
+
+    buff.insert(buff.end(), reinterpret_cast<char*>(&block_type), reinterpret_cast<char*>(&block_type) + sizeof(uint64_t));
+    buff.insert(buff.end(), reinterpret_cast<char*>(&timestamp), reinterpret_cast<char*>(&timestamp) + sizeof(uint64_t));
+    buff.insert(buff.end(), prev_hash.begin(), prev_hash.end());
+    buff.resize(tx_buff, 0);
+}
+
+bool BlockBuilder::has_merkle_root() const
+{
+    return merkle_root;
+}
+
+void BlockBuilder::reserve(uint64_t txs_size)
+{
+    buff.reserve(buff.size() + txs_size + 1);
+}
+
+void BlockBuilder::hash_txs(uint64_t offset)
+{
+    // листья дерева копятся и считаются пачкой в hash_pending
+    if (!merkle_root) {
+        tx_stream.update(&buff[offset], buff.size() - offset);
+    }
+}
+
+void BlockBuilder::hash_pending()
+{
+    if (!merkle_root) {
+        return;
+    }
+
+    // листья - хеши транзакций целиком, как их считает TX::parse
+    std::vector<std::string_view> txs;
+    crypto::ByteReader reader(std::string_view(buff.data(), buff.size()), unhashed_offset);
+    std::string_view tx;
+    while (reader.remaining() && reader.read_frame(tx)) {
+        txs.push_back(tx);
+    }
+    unhashed_offset = buff.size();
+
+    std::vector<sha256_2> hashes;
+    crypto::get_sha256_batch(txs, hashes);
+    tx_hashes.insert(tx_hashes.end(), hashes.begin(), hashes.end());
+}
+
+void BlockBuilder::add_tx(const std::vector<char>& tx)
+{
+    uint64_t offset = buff.size();
+    crypto::append_varint(buff, tx.size());
+    buff.insert(buff.end(), tx.begin(), tx.end());
+    hash_txs(offset);
+}
+
+void BlockBuilder::add_tx(const std::vector<char>& raw_tx, uint64_t state)
+{
+    uint64_t offset = buff.size();
+    crypto::append_varint(buff, raw_tx.size() + crypto::get_varint_size(state));
+    buff.insert(buff.end(), raw_tx.begin(), raw_tx.end());
+    crypto::append_varint(buff, state);
+    hash_txs(offset);
+}
+
+void BlockBuilder::add_txs(const std::vector<char>& txs)
+{
+    uint64_t offset = buff.size();
+    buff.insert(buff.end(), txs.begin(), txs.end());
+    hash_txs(offset);
+}
+
+void BlockBuilder::add_txs(const std::vector<char>& txs, const std::vector<sha256_2>& hashes)
+{
+    hash_pending();
+    buff.insert(buff.end(), txs.begin(), txs.end());
+    if (merkle_root) {
+        unhashed_offset = buff.size();
+        tx_hashes.insert(tx_hashes.end(), hashes.begin(), hashes.end());
+    } else {
+        tx_stream.update(txs.data(), txs.size());
+    }
+}
+
+CommonBlock* BlockBuilder::make()
+{
+    hash_pending();
+    buff.push_back(0);
+
+    sha256_2 tx_hash;
+    if (merkle_root) {
+        tx_hash = get_merkle_root(tx_hashes);
+    } else {
+        tx_stream.update(&buff.back(), 1);
+        tx_hash = tx_stream.finish();
+    }
+    std::copy(tx_hash.begin(), tx_hash.end(), buff.begin() + 48);
+
+    auto* block = new CommonBlock();
+    if (!block->make(std::move(buff), std::move(tx_hashes))) {
+        delete block;
+        return nullptr;
+    }
+    return block;
+}
+
+}
@@ -2,57 +2,29 @@
 #include <meta_constants.hpp>
 #include <meta_crypto.h>
 
-#include <future>
-#include <list>
-
 namespace metahash::block {
 
-const std::vector<transaction::TX> CommonBlock::get_txs(boost::asio::io_context& io_context) const
+const std::vector<transaction::TX> CommonBlock::get_txs(pool::CpuPool& cpu_pool) const
 {
     if (data.empty()) {
         return std::vector<transaction::TX>();
     }
 
-    uint64_t cur_pos = tx_buff;
-    uint64_t tx_size = 0;
-    {
-        std::string_view tx_size_arr(&data[cur_pos], data.size() - cur_pos);
-        uint64_t varint_size = crypto::read_varint(tx_size, tx_size_arr);
-        cur_pos += varint_size;
-    }
-
     bool SKIP_CHECK_SIGN = (get_block_type() == BLOCK_TYPE_STATE || get_block_type() == BLOCK_TYPE_FORGING || get_prev_hash() == sha256_2 {});
 
     std::vector<std::string_view> tx_buffs;
-    while (tx_size > 0) {
-        std::string_view tx_sw(&data[cur_pos], tx_size);
-        cur_pos += tx_size;
-        tx_buffs.push_back(tx_sw);
+    crypto::ByteReader reader(std::string_view(data.data(), data.size()), tx_buff);
+    reader.read_frames(tx_buffs);
 
-        {
-            std::string_view tx_size_arr = std::string_view(&data[cur_pos], data.size() - cur_pos);
-            uint64_t varint_size = crypto::read_varint(tx_size, tx_size_arr);
-            cur_pos += varint_size;
-        }
-    }
+    std::vector<sha256_2> tx_hashes;
+    crypto::get_sha256_batch(tx_buffs, tx_hashes);
 
-    std::list<std::future<bool>> pending_data;
     std::vector<transaction::TX> txs(tx_buffs.size());
-    uint64_t i = 0;
-    for (auto&& tx_data : tx_buffs) {
-        auto promise = std::make_shared<std::promise<bool>>();
-        pending_data.push_back(promise->get_future());
-
-        io_context.post([&txs, promise, i, tx_data, SKIP_CHECK_SIGN] {
-            promise->set_value(txs[i].parse(tx_data, !SKIP_CHECK_SIGN));
-        });
-
-        i++;
-    }
-
-    for (auto&& fut : pending_data) {
-        fut.get();
-    }
+    pool::parallel_for(cpu_pool, tx_buffs.size(), TX_PARSE_CHUNK_MIN, [&txs, &tx_buffs, &tx_hashes, SKIP_CHECK_SIGN](uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; i++) {
+            txs[i].parse(tx_buffs[i], tx_hashes[i], !SKIP_CHECK_SIGN);
+        }
+    });
 
     std::sort(txs.begin(), txs.end(), [](transaction::TX& lh, transaction::TX& rh) { return lh.nonce < rh.nonce; });
 
@@ -0,0 +1,20 @@
+#include <meta_block.h>
+#include <meta_constants.hpp>
+#include <meta_log.hpp>
+
+namespace metahash::block {
+
+bool CommonBlock::make(std::vector<char>&& block_buff, std::vector<sha256_2>&& new_tx_hashes)
+{
+    if (block_buff.size() <= tx_buff) {
+        DEBUG_COUT("if (size <= 80)");
+        return false;
+    }
+
+    data = std::move(block_buff);
+    tx_hashes = std::move(new_tx_hashes);
+
+    return true;
+}
+
+}
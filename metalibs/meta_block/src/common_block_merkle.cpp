@@ -0,0 +1,175 @@
+#include <meta_block.h>
+#include <meta_constants.hpp>
+#include <meta_crypto.h>
+
+namespace metahash::block {
+
+namespace {
+
+    // префиксы разделяют лист, внутренний узел и итоговый корень: узел нельзя выдать за лист
+    const unsigned char LEAF_PREFIX = 0x00;
+    const unsigned char NODE_PREFIX = 0x01;
+    const unsigned char ROOT_PREFIX = 0x02;
+
+    const uint64_t LEAF_SIZE = 1 + 32;
+    const uint64_t NODE_SIZE = 1 + 2 * 32;
+
+    sha256_2 get_leaf_hash(const sha256_2& tx_hash)
+    {
+        std::array<unsigned char, LEAF_SIZE> buff;
+        buff[0] = LEAF_PREFIX;
+        std::copy(tx_hash.begin(), tx_hash.end(), buff.begin() + 1);
+        return crypto::get_sha256(buff);
+    }
+
+    sha256_2 get_node_hash(const sha256_2& left, const sha256_2& right)
+    {
+        std::array<unsigned char, NODE_SIZE> buff;
+        buff[0] = NODE_PREFIX;
+        std::copy(left.begin(), left.end(), buff.begin() + 1);
+        std::copy(right.begin(), right.end(), buff.begin() + 33);
+        return crypto::get_sha256(buff);
+    }
+
+    // число листьев входит в корень, поэтому доказательство с чужим count или index не сходится
+    sha256_2 get_root_hash(uint64_t count, const sha256_2& tree_root)
+    {
+        std::array<unsigned char, 1 + 8 + 32> buff;
+        buff[0] = ROOT_PREFIX;
+        for (uint64_t i = 0; i < 8; i++) {
+            buff[1 + i] = static_cast<unsigned char>(count >> (8 * i));
+        }
+        std::copy(tree_root.begin(), tree_root.end(), buff.begin() + 9);
+        return crypto::get_sha256(buff);
+    }
+
+    void hash_leaves(std::vector<sha256_2>& hashes)
+    {
+        std::vector<char> buff(hashes.size() * LEAF_SIZE);
+        std::vector<std::string_view> leaves(hashes.size());
+        for (uint64_t i = 0; i < hashes.size(); i++) {
+            char* leaf = buff.data() + i * LEAF_SIZE;
+            leaf[0] = LEAF_PREFIX;
+            std::copy(hashes[i].begin(), hashes[i].end(), leaf + 1);
+            leaves[i] = std::string_view(leaf, LEAF_SIZE);
+        }
+        crypto::get_sha256_batch(leaves, hashes);
+    }
+
+    void next_level(std::vector<sha256_2>& level)
+    {
+        std::vector<char> buff(level.size() / 2 * NODE_SIZE);
+        std::vector<std::string_view> pairs(level.size() / 2);
+        for (uint64_t i = 0; i < pairs.size(); i++) {
+            char* node = buff.data() + i * NODE_SIZE;
+            node[0] = NODE_PREFIX;
+            std::copy(level[2 * i].begin(), level[2 * i].end(), node + 1);
+            std::copy(level[2 * i + 1].begin(), level[2 * i + 1].end(), node + 33);
+            pairs[i] = std::string_view(node, NODE_SIZE);
+        }
+
+        std::vector<sha256_2> parents;
+        crypto::get_sha256_batch(pairs, parents);
+        if (level.size() % 2) {
+            parents.push_back(level.back());
+        }
+        level.swap(parents);
+    }
+
+    uint64_t get_path_size(uint64_t index, uint64_t count)
+    {
+        uint64_t size = 0;
+        while (count > 1) {
+            if ((index ^ 1) < count) {
+                size++;
+            }
+            index >>= 1;
+            count = (count + 1) / 2;
+        }
+        return size;
+    }
+
+}
+
+sha256_2 get_merkle_root(std::vector<sha256_2> hashes)
+{
+    if (hashes.empty()) {
+        return sha256_2 { { 0 } };
+    }
+    const uint64_t count = hashes.size();
+    hash_leaves(hashes);
+    while (hashes.size() > 1) {
+        next_level(hashes);
+    }
+    return get_root_hash(count, hashes.front());
+}
+
+bool get_merkle_proof(std::vector<sha256_2> hashes, uint64_t index, TxProof& proof)
+{
+    if (index >= hashes.size()) {
+        return false;
+    }
+
+    proof.index = index;
+    proof.count = hashes.size();
+    proof.path.clear();
+    hash_leaves(hashes);
+    while (hashes.size() > 1) {
+        if ((index ^ 1) < hashes.size()) {
+            proof.path.push_back(hashes[index ^ 1]);
+        }
+        next_level(hashes);
+        index >>= 1;
+    }
+    return true;
+}
+
+bool check_tx_proof(const sha256_2& tx_hash, const TxProof& proof, const sha256_2& root)
+{
+    if (proof.index >= proof.count || proof.path.size() != get_path_size(proof.index, proof.count)) {
+        return false;
+    }
+
+    sha256_2 hash = get_leaf_hash(tx_hash);
+    uint64_t index = proof.index;
+    uint64_t count = proof.count;
+    auto sibling = proof.path.begin();
+    while (count > 1) {
+        if ((index ^ 1) < count) {
+            hash = (index & 1) ? get_node_hash(*sibling, hash) : get_node_hash(hash, *sibling);
+            sibling++;
+        }
+        index >>= 1;
+        count = (count + 1) / 2;
+    }
+
+    return get_root_hash(proof.count, hash) == root;
+}
+
+sha256_2 CommonBlock::get_tx_hash() const
+{
+    sha256_2 tx_hash;
+    std::copy_n(data.begin() + 48, 32, tx_hash.begin());
+    return tx_hash;
+}
+
+bool CommonBlock::has_tx_merkle_root() const
+{
+    return get_block_timestamp() >= TX_MERKLE_ROOT_TIMESTAMP;
+}
+
+bool CommonBlock::get_tx_proof(const sha256_2& tx_hash, TxProof& proof) const
+{
+    if (!has_tx_merkle_root()) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < tx_hashes.size(); i++) {
+        if (tx_hashes[i] == tx_hash) {
+            return get_merkle_proof(tx_hashes, i, proof);
+        }
+    }
+    return false;
+}
+
+}
@@ -15,6 +15,8 @@ bool CommonBlock::parse(std::string_view block_sw)
     }
 
     uint64_t block_type = *(reinterpret_cast<const uint64_t*>(&block_sw[0]));
+    uint64_t block_timestamp = *(reinterpret_cast<const uint64_t*>(&block_sw[8]));
+    bool merkle_root = block_timestamp >= TX_MERKLE_ROOT_TIMESTAMP;
 
     sha256_2 prev_hash;
     std::copy_n(block_sw.begin() + 16, 32, prev_hash.begin());
@@ -24,52 +26,38 @@ bool CommonBlock::parse(std::string_view block_sw)
     sha256_2 tx_hash;
     std::copy_n(block_sw.begin() + 48, 32, tx_hash.begin());
 
-    uint64_t cur_pos = tx_buff;
-    uint64_t tx_size;
-    {
-        std::string_view tx_size_arr(
-            block_sw.begin() + cur_pos,
-            block_sw.size() - cur_pos);
-        uint64_t varint_size = crypto::read_varint(tx_size, tx_size_arr);
-        if (varint_size < 1) {
-            DEBUG_COUT("VARINT READ ERROR");
-            return false;
-        }
-        cur_pos += varint_size;
+    crypto::ByteReader reader(block_sw, tx_buff);
+    std::vector<std::string_view> tx_buffs;
+    if (!reader.read_frames(tx_buffs)) {
+        DEBUG_COUT("TX BUFF ERROR");
+        return false;
     }
 
-    while (tx_size > 0) {
-        if (cur_pos + tx_size >= block_sw.size()) {
-            DEBUG_COUT("TX BUFF ERROR");
-            return false;
-        }
-        std::string_view tx_sw(block_sw.begin() + cur_pos, tx_size);
-        cur_pos += tx_size;
+    std::vector<sha256_2> hashes;
+    crypto::get_sha256_batch(tx_buffs, hashes);
 
+    bool SKIP_CHECK_SIGN = (block_type == BLOCK_TYPE_STATE || block_type == BLOCK_TYPE_FORGING || prev_is_zero);
+    for (uint64_t i = 0; i < tx_buffs.size(); i++) {
         auto* tx = new transaction::TX;
-        bool SKIP_CHECK_SIGN = (block_type == BLOCK_TYPE_STATE || block_type == BLOCK_TYPE_FORGING || prev_is_zero);
-        if (!tx->parse(tx_sw, !SKIP_CHECK_SIGN)) {
+        if (!tx->parse(tx_buffs[i], hashes[i], !SKIP_CHECK_SIGN)) {
             DEBUG_COUT("tx->parse");
             delete tx;
             return false;
         }
         delete tx;
-
-        {
-            std::string_view tx_size_arr = std::string_view(
-                block_sw.begin() + cur_pos,
-                block_sw.size() - cur_pos);
-            uint64_t varint_size = crypto::read_varint(tx_size, tx_size_arr);
-            if (varint_size < 1) {
-                DEBUG_COUT("VARINT READ ERROR");
-                return false;
-            }
-            cur_pos += varint_size;
-        }
+    }
+    if (!merkle_root) {
+        hashes.clear();
     }
 
-    std::string_view txs_sw(block_sw.begin() + tx_buff, cur_pos - tx_buff);
-    tx_hash_calc = crypto::get_sha256(txs_sw);
+    const uint64_t cur_pos = reader.position();
+
+    if (merkle_root) {
+        tx_hash_calc = get_merkle_root(hashes);
+    } else {
+        std::string_view txs_sw(block_sw.begin() + tx_buff, cur_pos - tx_buff);
+        tx_hash_calc = crypto::get_sha256(txs_sw);
+    }
     if (tx_hash_calc != tx_hash) {
         DEBUG_COUT("tx_hash_calc != tx_hash");
         return false;
@@ -77,6 +65,7 @@ bool CommonBlock::parse(std::string_view block_sw)
 
     data.clear();
     data.insert(data.end(), block_sw.begin(), block_sw.begin() + cur_pos);
+    tx_hashes = std::move(hashes);
 
     return true;
 }
@@ -26,26 +26,9 @@ const std::vector<transaction::RejectedTXInfo> RejectedTXBlock::get_txs() const
         return txs;
     }
 
-    uint64_t cur_pos = tx_buff;
-    uint64_t tx_size = 0;
-    {
-        std::string_view tx_size_arr(&data[cur_pos], data.size() - cur_pos);
-        uint64_t varint_size = crypto::read_varint(tx_size, tx_size_arr);
-        cur_pos += varint_size;
-    }
-
     std::vector<std::string_view> tx_buffs;
-    while (tx_size > 0) {
-        std::string_view tx_sw(&data[cur_pos], tx_size);
-        cur_pos += tx_size;
-        tx_buffs.push_back(tx_sw);
-
-        {
-            std::string_view tx_size_arr = std::string_view(&data[cur_pos], data.size() - cur_pos);
-            uint64_t varint_size = crypto::read_varint(tx_size, tx_size_arr);
-            cur_pos += varint_size;
-        }
-    }
+    crypto::ByteReader reader(std::string_view(data.data(), data.size()), tx_buff);
+    reader.read_frames(tx_buffs);
 
     txs.resize(tx_buffs.size());
     uint64_t i = 0;
@@ -11,6 +11,7 @@ bool RejectedTXBlock::make(
     crypto::Signer& signer)
 {
     std::vector<char> tx_data_buff;
+    crypto::ByteWriter tx_writer(tx_data_buff);
 
     std::map<sha256_2, transaction::RejectedTXInfo*> tx_map;
     for (auto tx : new_txs) {
@@ -19,10 +20,9 @@ bool RejectedTXBlock::make(
 
     {
         for (auto [hash, tx] : tx_map) {
-            crypto::append_varint(tx_data_buff, tx->data.size());
-            tx_data_buff.insert(tx_data_buff.end(), tx->data.begin(), tx->data.end());
+            tx_writer.write_frame(tx->data);
         }
-        crypto::append_varint(tx_data_buff, 0);
+        tx_writer.write_varint(0);
     }
 
     std::vector<char> sign_buff = signer.sign(tx_data_buff);
@@ -30,15 +30,15 @@ bool RejectedTXBlock::make(
 
     uint64_t b_type = BLOCK_TYPE_TECH_BAD_TX;
     std::vector<char> block_buff;
-
-    block_buff.insert(block_buff.end(), reinterpret_cast<char*>(&b_type), (reinterpret_cast<char*>(&b_type) + sizeof(uint64_t)));
-    block_buff.insert(block_buff.end(), reinterpret_cast<char*>(&timestamp), (reinterpret_cast<char*>(&timestamp) + sizeof(uint64_t)));
-    block_buff.insert(block_buff.end(), new_prev_hash.begin(), new_prev_hash.end());
-    crypto::append_varint(block_buff, sign_buff.size());
-    block_buff.insert(block_buff.end(), sign_buff.begin(), sign_buff.end());
-    crypto::append_varint(block_buff, PubKey.size());
-    block_buff.insert(block_buff.end(), PubKey.begin(), PubKey.end());
-    block_buff.insert(block_buff.end(), tx_data_buff.begin(), tx_data_buff.end());
+    crypto::ByteWriter writer(block_buff);
+    writer.reserve(48 + sign_buff.size() + PubKey.size() + tx_data_buff.size() + 2 * 9);
+
+    writer.write(&b_type, sizeof(uint64_t));
+    writer.write(&timestamp, sizeof(uint64_t));
+    writer.write(new_prev_hash);
+    writer.write_frame(sign_buff);
+    writer.write_frame(PubKey);
+    writer.write(tx_data_buff);
 
     std::string_view block_as_sw(block_buff.data(), block_buff.size());
 
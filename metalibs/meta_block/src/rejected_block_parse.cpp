@@ -22,46 +22,38 @@ bool RejectedTXBlock::parse(std::string_view block_sw)
     uint64_t data_size = 0;
     std::string_view tmp_data_for_sign;
 
-    uint64_t cur_pos = 48;
+    crypto::ByteReader reader(block_sw, 48);
 
     {
-        std::string_view varint_arr(&block_sw[cur_pos], block_sw.size() - cur_pos);
-        uint64_t varint_size = crypto::read_varint(sign_size, varint_arr);
-        if (varint_size < 1) {
+        if (!reader.read_varint(sign_size)) {
             DEBUG_COUT("corrupt varint size");
             return false;
         }
-        cur_pos += varint_size;
-        sign_start = cur_pos;
+        sign_start = reader.position();
 
-        if (cur_pos + sign_size >= block_sw.size()) {
+        if (reader.remaining() <= sign_size) {
             DEBUG_COUT("corrupt sign size");
             return false;
         }
-        tmp_sign = std::string_view(&block_sw[cur_pos], sign_size);
-        cur_pos += sign_size;
+        reader.read(tmp_sign, sign_size);
     }
 
     {
-        std::string_view varint_arr(&block_sw[cur_pos], block_sw.size() - cur_pos);
-        uint64_t varint_size = crypto::read_varint(pubk_size, varint_arr);
-        if (varint_size < 1) {
+        if (!reader.read_varint(pubk_size)) {
             DEBUG_COUT("corrupt varint size");
             return false;
         }
-        cur_pos += varint_size;
-        pubk_start = cur_pos;
+        pubk_start = reader.position();
 
-        if (cur_pos + pubk_size >= block_sw.size()) {
+        if (reader.remaining() <= pubk_size) {
             DEBUG_COUT("corrupt pubk size");
             return false;
         }
-        tmp_pubk = std::string_view(&block_sw[cur_pos], pubk_size);
-        cur_pos += pubk_size;
+        reader.read(tmp_pubk, pubk_size);
     }
 
-    data_start = cur_pos;
-    data_size = block_sw.size() - cur_pos;
+    data_start = reader.position();
+    data_size = reader.remaining();
     tmp_data_for_sign = std::string_view(&block_sw[data_start], data_size);
 
     if (!crypto::check_sign(tmp_data_for_sign, tmp_sign, tmp_pubk)) {
@@ -69,28 +61,15 @@ bool RejectedTXBlock::parse(std::string_view block_sw)
         return false;
     }
 
-    tx_buff = cur_pos;
+    tx_buff = reader.position();
 
-    uint64_t tx_size;
-    {
-        std::string_view tx_size_arr(
-            block_sw.begin() + cur_pos,
-            block_sw.size() - cur_pos);
-        uint64_t varint_size = crypto::read_varint(tx_size, tx_size_arr);
-        if (varint_size < 1) {
-            DEBUG_COUT("VARINT READ ERROR");
-            return false;
-        }
-        cur_pos += varint_size;
+    std::string_view tx_as_sw;
+    if (!reader.read_frame(tx_as_sw)) {
+        DEBUG_COUT("TX BUFF ERROR");
+        return false;
     }
 
-    while (tx_size > 0) {
-        if (cur_pos + tx_size >= block_sw.size()) {
-            DEBUG_COUT("TX BUFF ERROR");
-            return false;
-        }
-
-        std::string_view tx_as_sw(&block_sw[cur_pos], tx_size);
+    while (!tx_as_sw.empty()) {
         auto* tx = new transaction::RejectedTXInfo;
         if (!tx->parse(tx_as_sw)) {
             DEBUG_COUT("TX PARSE ERROR");
@@ -98,18 +77,10 @@ bool RejectedTXBlock::parse(std::string_view block_sw)
             return false;
         }
         delete tx;
-        cur_pos += tx_size;
-
-        {
-            std::string_view tx_size_arr = std::string_view(
-                block_sw.begin() + cur_pos,
-                block_sw.size() - cur_pos);
-            uint64_t varint_size = crypto::read_varint(tx_size, tx_size_arr);
-            if (varint_size < 1) {
-                DEBUG_COUT("VARINT READ ERROR");
-                return false;
-            }
-            cur_pos += varint_size;
+
+        if (!reader.read_frame(tx_as_sw)) {
+            DEBUG_COUT("TX BUFF ERROR");
+            return false;
         }
     }
 
@@ -0,0 +1,247 @@
+#include <meta_block.h>
+#include <meta_constants.hpp>
+#include <meta_test.hpp>
+
+#include <openssl/sha.h>
+
+#include <iostream>
+
+using namespace metahash;
+using test::check;
+
+namespace {
+
+const std::string TEST_PRIVATE_KEY = "307402010104202b4ffad2c308f2ec5d06617593613ea562ac745621f92ea8479fb883c9dc98c0a00706052b8104000aa14403420004bbbbfb34e8a914ecf7ae196f445b0c167a0fa5c621f7be6bc05e57e20dcb9a83f500aeb0cfdc766b2d8a41ba0f6d6103db5b2d15816456516b84550e1c4d12ed";
+const uint64_t TX_COUNT = 5;
+
+// двойной SHA-256 напрямую через OpenSSL, независимо от meta_crypto
+sha256_2 double_sha256(const char* data, uint64_t size)
+{
+    sha256_2 first;
+    sha256_2 second;
+    SHA256(reinterpret_cast<const unsigned char*>(data), size, first.data());
+    SHA256(first.data(), first.size(), second.data());
+    return second;
+}
+
+sha256_2 double_sha256(const std::vector<char>& data)
+{
+    return double_sha256(data.data(), data.size());
+}
+
+sha256_2 reference_leaf(const sha256_2& tx_hash)
+{
+    std::vector<char> leaf(1, 0x00);
+    leaf.insert(leaf.end(), tx_hash.begin(), tx_hash.end());
+    return double_sha256(leaf);
+}
+
+sha256_2 reference_node(const sha256_2& left, const sha256_2& right)
+{
+    std::vector<char> node(1, 0x01);
+    node.insert(node.end(), left.begin(), left.end());
+    node.insert(node.end(), right.begin(), right.end());
+    return double_sha256(node);
+}
+
+sha256_2 reference_root(uint64_t count, const sha256_2& top)
+{
+    std::vector<char> root(1, 0x02);
+    for (uint64_t i = 0; i < 8; i++) {
+        root.push_back(static_cast<char>(count >> (8 * i)));
+    }
+    root.insert(root.end(), top.begin(), top.end());
+    return double_sha256(root);
+}
+
+// уровни дерева от листьев до вершины
+std::vector<std::vector<sha256_2>> reference_levels(const std::vector<sha256_2>& tx_hashes)
+{
+    std::vector<std::vector<sha256_2>> levels(1);
+    for (const auto& tx_hash : tx_hashes) {
+        levels[0].push_back(reference_leaf(tx_hash));
+    }
+    while (levels.back().size() > 1) {
+        const auto& level = levels.back();
+        std::vector<sha256_2> parents;
+        for (uint64_t i = 0; i + 1 < level.size(); i += 2) {
+            parents.push_back(reference_node(level[i], level[i + 1]));
+        }
+        if (level.size() % 2) {
+            parents.push_back(level.back());
+        }
+        levels.push_back(parents);
+    }
+    return levels;
+}
+
+sha256_2 reference_merkle_root(const std::vector<sha256_2>& tx_hashes)
+{
+    return reference_root(tx_hashes.size(), reference_levels(tx_hashes).back().front());
+}
+
+std::vector<char> make_raw_tx(crypto::Signer& signer, uint64_t nonce)
+{
+    std::vector<char> raw(25, 0x11);
+    crypto::append_varint(raw, 1000 + nonce);
+    crypto::append_varint(raw, 10);
+    crypto::append_varint(raw, nonce);
+    crypto::append_varint(raw, 0);
+
+    auto sign = signer.sign(raw);
+    auto& pub_key = signer.get_pub_key();
+    crypto::append_varint(raw, sign.size());
+    raw.insert(raw.end(), sign.begin(), sign.end());
+    crypto::append_varint(raw, pub_key.size());
+    raw.insert(raw.end(), pub_key.begin(), pub_key.end());
+    return raw;
+}
+
+sha256_2 header_tx_hash(const std::vector<char>& data)
+{
+    sha256_2 tx_hash;
+    std::copy_n(data.begin() + 48, 32, tx_hash.begin());
+    return tx_hash;
+}
+
+std::vector<char> make_block_data(uint64_t timestamp, const std::vector<std::vector<char>>& frames, const sha256_2& prev_hash)
+{
+    block::BlockBuilder builder(BLOCK_TYPE_COMMON, timestamp, prev_hash);
+    check(builder.has_merkle_root() == (timestamp >= TX_MERKLE_ROOT_TIMESTAMP), "builder picked the wrong commitment at " + std::to_string(timestamp));
+    for (const auto& frame : frames) {
+        builder.add_tx(frame);
+    }
+
+    auto* block = builder.make();
+    if (!block) {
+        check(false, "builder failed at " + std::to_string(timestamp));
+        return {};
+    }
+    auto data = block->get_data();
+    check(block->get_block_hash() == double_sha256(data), "built block hash is not the double SHA-256 of its data");
+    delete block;
+    return data;
+}
+
+void check_block(uint64_t timestamp, const std::vector<std::vector<char>>& frames, const sha256_2& prev_hash)
+{
+    const std::string at = " at " + std::to_string(timestamp);
+    const bool merkle_root = timestamp >= TX_MERKLE_ROOT_TIMESTAMP;
+
+    auto data = make_block_data(timestamp, frames, prev_hash);
+    if (data.empty()) {
+        return;
+    }
+
+    std::vector<sha256_2> leaves;
+    for (const auto& frame : frames) {
+        leaves.push_back(double_sha256(frame));
+    }
+    // до активации заголовок хранит хеш буфера транзакций вместе с завершающим нулём
+    const sha256_2 expected_tx_hash = merkle_root ? reference_merkle_root(leaves) : double_sha256(data.data() + 80, data.size() - 80);
+    check(header_tx_hash(data) == expected_tx_hash, "header commitment" + at);
+
+    auto* parsed = block::parse_block(std::string_view(data.data(), data.size()));
+    auto* common = dynamic_cast<block::CommonBlock*>(parsed);
+    check(common != nullptr, "block does not parse" + at);
+    if (common) {
+        check(common->has_tx_merkle_root() == merkle_root, "parsed commitment kind" + at);
+        check(common->get_tx_hash() == expected_tx_hash, "parsed tx hash" + at);
+        check(common->get_block_hash() == double_sha256(data), "parsed block hash" + at);
+
+        for (uint64_t i = 0; i < leaves.size(); i++) {
+            block::TxProof proof;
+            bool has_proof = common->get_tx_proof(leaves[i], proof);
+            check(has_proof == merkle_root, "proof availability" + at);
+            if (has_proof) {
+                check(block::check_tx_proof(leaves[i], proof, common->get_tx_hash()), "proof of tx " + std::to_string(i) + at);
+            }
+        }
+    }
+    delete parsed;
+
+    // тот же блок с отметкой времени по другую сторону границы обязан отвергаться
+    uint64_t other_timestamp = merkle_root ? TX_MERKLE_ROOT_TIMESTAMP - 1 : TX_MERKLE_ROOT_TIMESTAMP;
+    auto moved = data;
+    std::copy_n(reinterpret_cast<const char*>(&other_timestamp), 8, moved.begin() + 8);
+    auto* moved_block = block::parse_block(std::string_view(moved.data(), moved.size()));
+    check(moved_block == nullptr, "block accepted with a commitment of the other side" + at);
+    delete moved_block;
+}
+
+// 5 листьев: вершина = node(node(node(L0, L1), node(L2, L3)), L4)
+void check_forged_proofs(const std::vector<sha256_2>& tx_hashes)
+{
+    const auto levels = reference_levels(tx_hashes);
+    const sha256_2 root = block::get_merkle_root(tx_hashes);
+    check(root == reference_merkle_root(tx_hashes), "get_merkle_root differs from reference");
+
+    for (uint64_t i = 0; i < tx_hashes.size(); i++) {
+        block::TxProof proof;
+        check(block::get_merkle_proof(tx_hashes, i, proof), "no proof for leaf " + std::to_string(i));
+        check(block::check_tx_proof(tx_hashes[i], proof, root), "proof for leaf " + std::to_string(i));
+
+        auto forged = proof;
+        forged.path.push_back(levels[0][0]);
+        check(!block::check_tx_proof(tx_hashes[i], forged, root), "proof with extra sibling, leaf " + std::to_string(i));
+
+        forged = proof;
+        forged.path.pop_back();
+        check(!block::check_tx_proof(tx_hashes[i], forged, root), "proof with missing sibling, leaf " + std::to_string(i));
+
+        forged = proof;
+        forged.count++;
+        check(!block::check_tx_proof(tx_hashes[i], forged, root), "proof with another count, leaf " + std::to_string(i));
+    }
+
+    // внутренний узел node(L0, L1), выданный за лист дерева из трёх элементов: путь node(L2, L3), L4
+    {
+        block::TxProof forged;
+        forged.index = 0;
+        forged.count = 3;
+        forged.path = { levels[1][1], levels[0][4] };
+        check(!block::check_tx_proof(levels[1][0], forged, root), "internal node accepted as a leaf");
+    }
+
+    // L4 с тем же путём node(L0..L3), но объявленный вторым из двух листьев
+    {
+        block::TxProof proof;
+        block::get_merkle_proof(tx_hashes, 4, proof);
+        check(proof.path.size() == 1 && proof.path[0] == levels[2][0], "proof path of the odd leaf");
+
+        auto forged = proof;
+        forged.index = 1;
+        forged.count = 2;
+        check(!block::check_tx_proof(tx_hashes[4], forged, root), "odd leaf accepted with another index and count");
+    }
+}
+
+}
+
+int main()
+{
+    auto private_key = crypto::hex2bin(TEST_PRIVATE_KEY);
+    crypto::Signer signer(private_key);
+
+    std::vector<std::vector<char>> frames;
+    for (uint64_t nonce = 1; nonce <= TX_COUNT; nonce++) {
+        auto raw = make_raw_tx(signer, nonce);
+        // кадр транзакции в блоке - подписанная транзакция и её состояние
+        crypto::append_varint(raw, 20);
+        frames.push_back(raw);
+    }
+
+    sha256_2 prev_hash;
+    prev_hash.fill(0x42);
+
+    check_block(TX_MERKLE_ROOT_TIMESTAMP - 1, frames, prev_hash);
+    check_block(TX_MERKLE_ROOT_TIMESTAMP, frames, prev_hash);
+
+    std::vector<sha256_2> tx_hashes;
+    for (const auto& frame : frames) {
+        tx_hashes.push_back(double_sha256(frame));
+    }
+    check_forged_proofs(tx_hashes);
+
+    return test::result();
+}
@@ -1,21 +1,176 @@
 #ifndef CHAIN_H
 #define CHAIN_H
 
+#include <array>
 #include <atomic>
+#include <functional>
 #include <set>
+#include <shared_mutex>
 #include <unordered_set>
 
 #include <meta_block.h>
+#include <meta_constants.hpp>
 #include <meta_pool.hpp>
 #include <meta_wallet.h>
 
 namespace metahash::meta_chain {
 
+// Копия применённого состояния всех кошельков для проверки транзакций из сетевых потоков.
+// Обновляется только после применения блока, изменения шаблона блока в неё не попадают.
+// Кошелька нет в копии - у него состояние по умолчанию.
+class WalletSnapshot {
+private:
+    static const uint64_t SHARD_COUNT = 64;
+
+    struct Shard {
+        std::shared_mutex lock;
+        std::unordered_map<std::string, meta_wallet::WalletState, crypto::Hasher> wallets;
+    };
+
+    std::array<Shard, SHARD_COUNT> shards;
+    std::atomic<bool> ready = false;
+
+    Shard& get_shard(const std::string& addr);
+
+public:
+    bool is_ready();
+    bool get(const std::string& addr, meta_wallet::WalletState& state);
+    void set(const std::string& addr, const meta_wallet::WalletState& state);
+    // полная перезапись: до set_ready() проверка при приёме не выполняется
+    void clear();
+    void set_ready();
+};
+
+// Дневная статистика узлов. Записи тестовых узлов разбираются один раз при применении блока
+// и складываются в плоские массивы: роль -> узел -> гео тестового узла.
+class NodeStatistics {
+public:
+    struct Record {
+        uint64_t role = 0;
+        std::string address;
+        uint64_t geo = 0;
+        bool success = false;
+        uint64_t value = 0;
+    };
+
+    struct Node {
+        std::string address;
+        uint64_t count = 0;
+        std::vector<std::pair<uint64_t, uint64_t>> geo_stats; // по индексу гео: число успешных тестов и сумма значений
+    };
+
+private:
+    std::vector<std::string> role_names; // в порядке ROLES
+    std::vector<std::string> geo_names; // по возрастанию
+    std::unordered_map<std::string, uint64_t, crypto::Hasher> test_node_geo;
+
+    std::vector<std::unordered_map<std::string, uint64_t, crypto::Hasher>> node_index;
+    std::vector<std::vector<Node>> nodes;
+    // роли со статистикой. Обходятся в порядке этой хеш-таблицы, как обходилась прежняя node_statistics:
+    // от порядка зависит, под какой ролью награждается адрес с записями в нескольких ролях
+    std::unordered_map<std::string, uint64_t, crypto::Hasher> active_roles;
+
+public:
+    NodeStatistics(const std::map<std::string, std::string>& test_nodes);
+
+    bool decode(const transaction::TX& tx, Record& record) const;
+    void add(const Record& record);
+    void clear();
+
+    const std::unordered_map<std::string, uint64_t, crypto::Hasher>& get_active_roles() const;
+    const std::vector<std::string>& get_geos() const;
+    const std::vector<Node>& get_nodes(uint64_t role) const;
+};
+
+// Доказательство состояния кошелька: листья его корзины и соседние узлы от корзины до корня
+struct StateProof {
+    std::string address;
+    uint64_t value = 0;
+    uint64_t nonce = 0;
+    std::string data;
+    std::vector<sha256_2> bucket;
+    std::vector<sha256_2> path;
+};
+
+// Корень дерева состояния после последнего применённого блока
+struct StateRoot {
+    sha256_2 block_hash = { { 0 } };
+    sha256_2 root = { { 0 } };
+};
+
+// Дерево Меркла над состоянием кошельков. Листья разложены по корзинам по первым байтам адреса
+// и упорядочены внутри корзины; после каждого блока обновляются затронутые им кошельки и пересчитываются
+// только изменённые корзины и их путь до корня. Кошельки в состоянии по умолчанию в дерево не входят.
+class StateTree {
+public:
+    struct Leaf {
+        const std::string* address;
+        uint64_t bucket;
+        sha256_2 hash;
+    };
+
+private:
+    std::vector<std::vector<Leaf>> buckets;
+    std::vector<sha256_2> nodes; // nodes[1] - корень, nodes[STATE_TREE_BUCKETS + i] - корзина i
+    std::vector<uint64_t> dirty_buckets;
+    std::vector<uint8_t> dirty;
+
+    void mark_dirty(uint64_t bucket);
+
+public:
+    StateTree();
+
+    static uint64_t get_bucket(const std::vector<unsigned char>& bin_addr);
+    static sha256_2 get_leaf_hash(const std::vector<unsigned char>& bin_addr, uint64_t value, uint64_t nonce, const std::string& data);
+    static bool make_leaf(const std::string& addr, meta_wallet::Wallet* wallet, Leaf& leaf);
+    static bool verify(const sha256_2& root, const StateProof& proof);
+
+    void update(const std::string& addr, meta_wallet::Wallet* wallet);
+    void rebuild(std::vector<Leaf>& leaves);
+    void commit();
+
+    const sha256_2& get_root() const;
+    bool get_proof(const std::string& addr, meta_wallet::Wallet* wallet, StateProof& proof) const;
+};
+
 class BlockChain {
+public:
+    using NodeRoles = std::unordered_map<std::string, uint64_t, crypto::Hasher>;
+
 private:
-    struct ProxyStat {
-        std::map<std::string, std::pair<uint64_t, uint64_t>> stats;
-        uint64_t count;
+    // Билеты случайного форжинга: число билетов каждого кошелька, без развёртки в список адресов
+    struct ForgingTickets {
+        std::vector<std::string> addresses;
+        std::vector<uint32_t> counts;
+    };
+
+    enum FeeCredit : uint8_t {
+        FEE_CREDIT_NONE,
+        FEE_CREDIT_BEFORE_METHOD,
+        FEE_CREDIT_AFTER_METHOD,
+    };
+
+    struct TxApply {
+        const transaction::TX* tx;
+        meta_wallet::Wallet* wallet_from;
+        meta_wallet::Wallet* wallet_to;
+        uint64_t real_fee;
+        FeeCredit fee_credit;
+        bool apply_method;
+        bool required;
+
+        uint64_t status = 0;
+        bool method_ok = true;
+        uint64_t credited = 0;
+    };
+
+    struct TemplateEntry {
+        transaction::TX* tx;
+        meta_wallet::Wallet* wallet_from;
+        meta_wallet::Wallet* wallet_to;
+
+        uint64_t status = 0;
+        bool deferred = false; // конфликтует с уже применёнными, переносится в следующий шаблон
     };
 
     const std::map<std::string, std::string> test_nodes = {
@@ -31,63 +186,109 @@ private:
 
     meta_wallet::WalletMap wallet_map;
 
-    std::unordered_map<std::string, std::set<std::string>, crypto::Hasher> node_state;
-    std::unordered_map<std::string, std::map<std::string, ProxyStat>, crypto::Hasher> node_statistics;
+    NodeRoles node_roles;
+    pool::RcuSnapshot<NodeRoles> node_roles_snapshot;
+    NodeStatistics node_statistics;
 
     std::unordered_set<sha256_2, crypto::Hasher> applied_transactions;
     std::unordered_set<sha256_2, crypto::Hasher> temp_apply_tx;
 
+    WalletSnapshot wallet_snapshot;
+    StateTree state_tree;
+    pool::RcuSnapshot<StateRoot> state_root_snapshot;
+    std::unordered_set<std::string, crypto::Hasher> temp_touched_wallets;
+
+    // транзакции шаблона в порядке поступления
+    std::vector<TemplateEntry> block_template;
+    // хеши транзакций шаблона, которые применены или отброшены, для Mempool::release
+    std::vector<sha256_2> released_transactions;
+    // транзакции последнего собранного блока, отпускаются при применении следующего блока
+    std::vector<sha256_2> built_transactions;
+    // применённые транзакции в порядке применения, транзакция комиссии добавляется при сборке блока
+    std::vector<char> block_template_buff;
+    uint64_t block_template_applied = 0;
+    uint64_t block_template_candidates = 0;
+    uint64_t block_template_fee = 0;
+    uint64_t block_template_savepoint = 0;
+    // наибольший nonce применённых транзакций, затронувших кошелёк
+    std::unordered_map<meta_wallet::Wallet*, uint64_t> block_template_nonces;
+    uint64_t block_template_max_nonce = 0;
+    // транзакции, ждущие пропущенный nonce отправителя: nonce -> индекс в шаблоне
+    std::unordered_map<meta_wallet::Wallet*, std::map<uint64_t, uint64_t>> block_template_gaps;
+
     std::vector<transaction::TX*> statistics_tx_list;
     std::vector<transaction::RejectedTXInfo*> rejected_tx_list;
 
     std::atomic<std::map<std::string, std::pair<uint, uint>>*> wallet_statistics = nullptr;
     std::atomic<std::deque<std::pair<std::string, uint64_t>>*> wallet_request_addreses = nullptr;
 
-    boost::asio::io_context& io_context;
+    pool::CpuPool& cpu_pool;
+    // пакеты транзакций меньше порога выполняются в вызывающем потоке
+    const uint64_t parallel_tx_batch_min;
 
     bool clear = true;
 
 public:
-    BlockChain(boost::asio::io_context& io_context);
+    BlockChain(pool::CpuPool& cpu_pool, uint64_t parallel_tx_batch_min = PARALLEL_TX_BATCH_MIN);
 
     bool can_apply_block(block::Block* block);
     bool apply_block(block::Block* block);
 
     block::Block* make_forging_block(uint64_t timestamp);
     block::Block* make_state_block(uint64_t timestamp);
-    block::Block* make_common_block(uint64_t timestamp, std::vector<transaction::TX*>& transactions);
+    block::Block* make_common_block(uint64_t timestamp);
     block::Block* make_statistics_block(uint64_t timestamp);
 
     std::vector<transaction::RejectedTXInfo*>* make_rejected_tx_block(uint64_t timestamp);
 
+    void add_to_block_template(std::vector<transaction::TX*>& transactions);
+    void update_block_template();
+    uint64_t get_block_template_size();
+    std::vector<sha256_2> take_released_transactions();
+
+    uint64_t check_admission(const transaction::TX* tx);
+
+    // вызывать из потока цепочки
+    bool get_state_proof(const std::string& addr, StateProof& proof);
+    pool::RcuSnapshot<StateRoot>::Reader get_last_state_root();
+
     std::atomic<std::map<std::string, std::pair<uint, uint>>*>& get_wallet_statistics();
     std::atomic<std::deque<std::pair<std::string, uint64_t>>*>& get_wallet_request_addresses();
 
-    std::set<std::string> check_addr(const std::string& addr);
-    const std::unordered_map<std::string, std::set<std::string>, crypto::Hasher>& get_node_state();
+    uint64_t check_addr(const std::string& addr);
+    pool::RcuSnapshot<NodeRoles>::Reader get_node_state();
 
 private:
-    block::Block* make_block(uint64_t b_type, uint64_t b_time, sha256_2 prev_b_hash, std::vector<char>& tx_buff);
 
     std::vector<char> make_forging_tx(const std::string& address, uint64_t reward, const std::vector<unsigned char>& data, uint64_t tx_type);
     std::pair<std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>>>, std::map<std::string, uint64_t>> make_forging_block_get_node_stats();
-    std::pair<std::deque<std::string>, std::map<std::string, uint64_t>> make_forging_block_get_wallet_stats();
+    std::pair<ForgingTickets, std::map<std::string, uint64_t>> make_forging_block_get_wallet_stats();
 
-    void make_forging_block_node_reward(const uint64_t pool, std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>>>& type_geo_node_delegates, std::vector<char>& txs_buff);
-    void make_forging_block_coin_reward(const uint64_t pool, std::map<std::string, uint64_t>& delegates, std::vector<char>& txs_buff);
-    void make_forging_block_random_reward(const uint64_t pool, std::deque<std::string>& active_forging, std::vector<char>& txs_buff);
-    void make_forging_block_wallet_reward(const uint64_t pool, std::map<std::string, uint64_t>& pasive_forging, std::vector<char>& txs_buff);
+    void make_forging_block_node_reward(const uint64_t pool, std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>>>& type_geo_node_delegates, block::BlockBuilder& builder);
+    void make_forging_block_coin_reward(const uint64_t pool, std::map<std::string, uint64_t>& delegates, block::BlockBuilder& builder);
+    void make_forging_block_random_reward(const uint64_t pool, ForgingTickets& active_forging, block::BlockBuilder& builder);
+    void make_forging_block_wallet_reward(const uint64_t pool, std::map<std::string, uint64_t>& pasive_forging, block::BlockBuilder& builder);
 
     static uint64_t get_fee(uint64_t cnt);
     static uint64_t FORGING_POOL(uint64_t ts);
 
+    uint64_t apply_template_entry(uint64_t index, meta_wallet::Wallet* state_fee);
+    void rollback_block_template();
+    void clear_block_template();
+
+    uint64_t get_chunk_count(uint64_t item_count, uint64_t chunk_min);
+    void run_chunks(uint64_t chunk_count, std::function<void(uint64_t)> work);
+    bool execute_txs(std::vector<TxApply>& txs, meta_wallet::Wallet* fee_wallet, bool stop_on_error);
+
     bool try_apply_block(block::Block* block, bool apply);
     bool can_apply_common_block(block::Block* block);
     bool can_apply_state_block(block::Block* block, bool);
     bool can_apply_forging_block(block::Block* block);
     void reject(const transaction::TX* tx, uint64_t reason);
 
-    void fill_node_state();
+    void update_node_roles();
+    void update_wallet_snapshot(bool full);
+    void update_state_tree(bool full);
 };
 
 }
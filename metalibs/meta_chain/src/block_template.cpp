@@ -0,0 +1,206 @@
+#include <meta_chain.h>
+
+#include <meta_constants.hpp>
+#include <meta_log.hpp>
+
+#include <limits>
+
+namespace metahash::meta_chain {
+
+namespace {
+
+    const uint64_t NO_ENTRY = std::numeric_limits<uint64_t>::max();
+
+}
+
+void BlockChain::add_to_block_template(std::vector<transaction::TX*>& transactions)
+{
+    block_template_candidates += transactions.size();
+
+    for (auto* tx : transactions) {
+        if (applied_transactions.find(tx->hash) != applied_transactions.end()) {
+            released_transactions.push_back(tx->hash);
+            delete tx;
+            continue;
+        }
+
+        const std::string& addr_from = tx->addr_from;
+        const std::string& addr_to = tx->addr_to;
+
+        if (test_nodes.find(addr_from) != test_nodes.end() && tx->json_rpc) {
+            released_transactions.push_back(tx->hash);
+            statistics_tx_list.push_back(tx);
+            continue;
+        }
+        if (addr_from == ZERO_WALLET) {
+            reject(tx, TX_REJECT_ZERO);
+            released_transactions.push_back(tx->hash);
+            delete tx;
+            continue;
+        }
+
+        auto wallet_to = wallet_map.get_wallet(addr_to);
+        auto wallet_from = wallet_map.get_wallet(addr_from);
+
+        if (!wallet_to || !wallet_from) {
+            reject(tx, TX_REJECT_INVALID_WALLET);
+            released_transactions.push_back(tx->hash);
+            delete tx;
+            continue;
+        }
+
+        block_template.push_back({ tx, wallet_from, wallet_to });
+    }
+
+    transactions.clear();
+}
+
+void BlockChain::update_block_template()
+{
+    auto& journal = wallet_map.get_journal();
+    auto state_fee = wallet_map.get_wallet(STATE_FEE_WALLET);
+
+    // комиссия выбирается, когда шаблон начинает применяться, и до его сборки или отката не меняется:
+    // она уже списана с применённых транзакций. Проверяющие берут комиссию из транзакции комиссии блока.
+    if (block_template_applied == 0) {
+        block_template_fee = get_fee(block_template_candidates);
+        block_template_savepoint = journal.savepoint();
+    }
+
+    while (block_template_applied < block_template.size()) {
+        uint64_t index = block_template_applied++;
+        while (index != NO_ENTRY) {
+            index = apply_template_entry(index, state_fee);
+        }
+    }
+}
+
+uint64_t BlockChain::apply_template_entry(uint64_t index, meta_wallet::Wallet* state_fee)
+{
+    auto& entry = block_template[index];
+    auto* tx = entry.tx;
+    if (!tx) {
+        return NO_ENTRY;
+    }
+
+    if (applied_transactions.find(tx->hash) != applied_transactions.end()) {
+        released_transactions.push_back(tx->hash);
+        delete tx;
+        entry.tx = nullptr;
+        return NO_ENTRY;
+    }
+
+    entry.status = 0;
+    entry.deferred = false;
+
+    // пропущен nonce отправителя: ждём недостающую транзакцию, если она не придёт - отказ при сборке блока
+    if (tx->nonce > entry.wallet_from->get_wallet_state().nonce) {
+        entry.status = TX_REJECT_INVALID_NONCE;
+        block_template_gaps[entry.wallet_from].emplace(tx->nonce, index);
+        return NO_ENTRY;
+    }
+
+    // Проверяющие выполняют транзакции блока по возрастанию nonce. Транзакция, затрагивающая кошелёк
+    // применённой транзакции с nonce не меньше своего, выполнилась бы у них раньше неё - откладываем её
+    // в следующий шаблон. Зачисления комиссий перестановочны, важны только списания с кошелька комиссий.
+    auto&& conflicts = [this, tx](meta_wallet::Wallet* wallet) {
+        auto it = block_template_nonces.find(wallet);
+        return it != block_template_nonces.end() && it->second >= tx->nonce;
+    };
+    if (conflicts(entry.wallet_from) || conflicts(entry.wallet_to)
+        || (entry.wallet_from == state_fee && !block_template_buff.empty() && block_template_max_nonce >= tx->nonce)) {
+        entry.deferred = true;
+        return NO_ENTRY;
+    }
+
+    uint64_t real_fee = block_template_fee + (tx->raw_tx.size() > 254 ? tx->raw_tx.size() - 254 : 0);
+    entry.status = entry.wallet_from->sub(entry.wallet_to, tx, real_fee);
+    if (entry.status > 0) {
+        return NO_ENTRY;
+    }
+
+    state_fee->add(real_fee);
+
+    uint64_t state = TX_STATE_ACCEPT;
+    if (!entry.wallet_from->try_apply_method(entry.wallet_to, tx)) {
+        state = TX_STATE_WRONG_DATA;
+    }
+
+    crypto::append_varint(block_template_buff, tx->raw_tx.size() + crypto::get_varint_size(state));
+    block_template_buff.insert(block_template_buff.end(), tx->raw_tx.begin(), tx->raw_tx.end());
+    crypto::append_varint(block_template_buff, state);
+
+    block_template_nonces[entry.wallet_from] = tx->nonce;
+    block_template_nonces[entry.wallet_to] = tx->nonce;
+    block_template_max_nonce = std::max(block_template_max_nonce, tx->nonce);
+
+    // следующая транзакция отправителя могла ждать эту
+    auto gaps_it = block_template_gaps.find(entry.wallet_from);
+    if (gaps_it == block_template_gaps.end()) {
+        return NO_ENTRY;
+    }
+    auto& gaps = gaps_it->second;
+    auto next = gaps.find(tx->nonce + 1);
+    if (next == gaps.end()) {
+        return NO_ENTRY;
+    }
+    uint64_t next_index = next->second;
+    gaps.erase(next);
+    if (gaps.empty()) {
+        block_template_gaps.erase(gaps_it);
+    }
+    return next_index;
+}
+
+uint64_t BlockChain::get_block_template_size()
+{
+    return block_template.size();
+}
+
+std::vector<sha256_2> BlockChain::take_released_transactions()
+{
+    std::vector<sha256_2> hashes;
+    hashes.swap(released_transactions);
+    return hashes;
+}
+
+void BlockChain::rollback_block_template()
+{
+    if (block_template_applied == 0) {
+        return;
+    }
+
+    wallet_map.get_journal().rollback_to(block_template_savepoint);
+    block_template_buff.clear();
+    block_template_applied = 0;
+    block_template_nonces.clear();
+    block_template_max_nonce = 0;
+    block_template_gaps.clear();
+}
+
+void BlockChain::clear_block_template()
+{
+    // отложенные транзакции открывают следующий шаблон
+    std::vector<TemplateEntry> deferred;
+    for (auto& entry : block_template) {
+        if (!entry.tx) {
+            continue;
+        }
+        if (entry.deferred) {
+            deferred.push_back({ entry.tx, entry.wallet_from, entry.wallet_to });
+            continue;
+        }
+        built_transactions.push_back(entry.tx->hash);
+        delete entry.tx;
+    }
+    block_template.swap(deferred);
+    block_template_buff.clear();
+    block_template_applied = 0;
+    block_template_candidates = block_template.size();
+    block_template_fee = 0;
+    block_template_nonces.clear();
+    block_template_max_nonce = 0;
+    block_template_gaps.clear();
+}
+
+}
@@ -13,8 +13,13 @@ bool BlockChain::can_apply_common_block(block::Block* block)
     if (common_block) {
         uint64_t fee = 0;
         auto state_fee = wallet_map.get_wallet(STATE_FEE_WALLET);
+        temp_touched_wallets.insert(STATE_FEE_WALLET);
 
-        for (const auto& tx : common_block->get_txs(io_context)) {
+        const auto txs = common_block->get_txs(cpu_pool);
+        std::vector<TxApply> txs_to_apply;
+        txs_to_apply.reserve(txs.size());
+
+        for (const auto& tx : txs) {
             if (tx.state == TX_STATE_FEE) {
                 fee = tx.value;
                 continue;
@@ -34,73 +39,42 @@ bool BlockChain::can_apply_common_block(block::Block* block)
                 DEBUG_COUT(addr_to);
                 continue;
             }
+            temp_touched_wallets.insert(addr_from);
+            temp_touched_wallets.insert(addr_to);
+
             if (tx.state == TX_STATE_APPROVE) {
-                wallet_from->sub(wallet_to, &tx, 0);
+                txs_to_apply.push_back({ &tx, wallet_from, wallet_to, 0, FEE_CREDIT_NONE, false, false });
                 continue;
             }
 
             if (tx.state == TX_STATE_TECH_NODE_STAT && tx.json_rpc && test_nodes.find(addr_from) != test_nodes.end()) {
-                const auto& type = tx.json_rpc->parameters["type"];
-                if (ROLES.count(type)) {
-                    const auto& mhaddr = tx.json_rpc->parameters["address"];
-                    node_statistics[type][mhaddr].count++;
-
-                    if (tx.json_rpc->parameters["success"] != "false") {
-                        uint64_t stat_value = 0;
-                        if (type == "Proxy") {
-                            try {
-                                stat_value = std::stol(tx.json_rpc->parameters["rps"]);
-                            } catch (...) {
-                                stat_value = 0;
-                            }
-                        } else {
-                            try {
-                                stat_value = std::stol(tx.json_rpc->parameters["latency"]);
-                            } catch (...) {
-                                stat_value = 1'000'000;
-                            }
-                            stat_value = stat_value < 1'000'000 ? 1'000'000 - stat_value : 0;
-                        }
-                        node_statistics[type][mhaddr].stats[test_nodes.at(addr_from)].first += 1;
-                        node_statistics[type][mhaddr].stats[test_nodes.at(addr_from)].second += stat_value;
-                    }
-                } else {
-                    auto& mhaddr = tx.json_rpc->parameters["mhaddr"];
-                    node_statistics["Proxy"][mhaddr].count++;
-
-                    if (tx.json_rpc->parameters["success"] != "false") {
-                        uint64_t rps = 0;
-                        try {
-                            rps = std::stol(tx.json_rpc->parameters["rps"]);
-                        } catch (...) {
-                            rps = 1;
-                        }
-
-                        if (rps > MINIMUM_PROXY_RPS && rps < (1000l * 1000l)) {
-                            node_statistics["Proxy"][mhaddr].stats[test_nodes.at(addr_from)].first += 1;
-                            node_statistics["Proxy"][mhaddr].stats[test_nodes.at(addr_from)].second += 1'000'000'000 / rps;
-                        }
-                    }
+                NodeStatistics::Record record;
+                if (node_statistics.decode(tx, record)) {
+                    node_statistics.add(record);
                 }
                 continue;
             }
 
-            if (wallet_from->sub(wallet_to, &tx, fee + (tx.raw_tx.size() > 255 ? tx.raw_tx.size() - 255 : 0)) > 0) {
-                DEBUG_COUT("tx hash:\t" + crypto::bin2hex(tx.hash));
-                DEBUG_COUT("addr_from:\t" + addr_from);
-                DEBUG_COUT("addr_to:\t" + addr_to);
-                return false;
-            }
+            txs_to_apply.push_back({ &tx, wallet_from, wallet_to, fee + (tx.raw_tx.size() > 255 ? tx.raw_tx.size() - 255 : 0), FEE_CREDIT_AFTER_METHOD, tx.state == TX_STATE_ACCEPT, true });
+        }
 
-            if (tx.state == TX_STATE_ACCEPT && !wallet_from->try_apply_method(wallet_to, &tx)) {
-                DEBUG_COUT("block hash:\t" + crypto::bin2hex(block->get_block_hash()));
-                DEBUG_COUT("tx hash:\t" + crypto::bin2hex(tx.hash));
-                DEBUG_COUT("addr_from:\t" + addr_from);
-                DEBUG_COUT("addr_to:\t" + addr_to);
-                return false;
+        if (!execute_txs(txs_to_apply, state_fee, true)) {
+            for (const auto& task : txs_to_apply) {
+                if (task.required && task.status > 0) {
+                    DEBUG_COUT("tx hash:\t" + crypto::bin2hex(task.tx->hash));
+                    DEBUG_COUT("addr_from:\t" + task.tx->addr_from);
+                    DEBUG_COUT("addr_to:\t" + task.tx->addr_to);
+                    break;
+                }
+                if (task.required && !task.method_ok) {
+                    DEBUG_COUT("block hash:\t" + crypto::bin2hex(block->get_block_hash()));
+                    DEBUG_COUT("tx hash:\t" + crypto::bin2hex(task.tx->hash));
+                    DEBUG_COUT("addr_from:\t" + task.tx->addr_from);
+                    DEBUG_COUT("addr_to:\t" + task.tx->addr_to);
+                    break;
+                }
             }
-
-            state_fee->add(fee + (tx.raw_tx.size() > 255 ? tx.raw_tx.size() - 255 : 0));
+            return false;
         }
     } else {
         DEBUG_COUT("block wrong type");
@@ -11,12 +11,13 @@ bool BlockChain::can_apply_forging_block(block::Block* block)
 
     if (common_block) {
         auto state_fee = wallet_map.get_wallet(STATE_FEE_WALLET);
+        temp_touched_wallets.insert(STATE_FEE_WALLET);
         uint64_t total_forging = 0;
         uint64_t timestamp = common_block->get_block_timestamp();
 
         std::set<std::string> forging_nodes_add_trust;
 
-        for (const auto& tx : common_block->get_txs(io_context)) {
+        for (const auto& tx : common_block->get_txs(cpu_pool)) {
             const std::string& addr_to = tx.addr_to;
             auto wallet_to = wallet_map.get_wallet(addr_to);
 
@@ -24,6 +25,7 @@ bool BlockChain::can_apply_forging_block(block::Block* block)
                 DEBUG_COUT("invalid wallet:\t" + addr_to);
                 continue;
             }
+            temp_touched_wallets.insert(addr_to);
 
             switch (tx.state) {
             case 0: {
@@ -44,10 +46,7 @@ bool BlockChain::can_apply_forging_block(block::Block* block)
             } break;
             case TX_STATE_FORGING_FOUNDER: {
                 wallet_to->add(tx.value);
-                auto* f_wallet = dynamic_cast<meta_wallet::CommonWallet*>(wallet_to);
-                if (f_wallet) {
-                    f_wallet->set_founder_limit();
-                }
+                wallet_to->set_founder_limit();
             } break;
             default:
                 DEBUG_COUT("wrong tx state\t" + std::to_string(tx.state));
@@ -76,14 +75,9 @@ bool BlockChain::can_apply_forging_block(block::Block* block)
             }
         }
 
-        for (auto& wallet_pair : wallet_map) {
-            auto* wallet = dynamic_cast<meta_wallet::CommonWallet*>(wallet_pair.second);
-            if (!wallet) {
-                DEBUG_COUT("invalid wallet type");
-                DEBUG_COUT(wallet_pair.first);
-                continue;
-            }
-
+        // суточный проход затрагивает только кошельки с дополнениями, состоянием или доверием
+        for (auto index : wallet_map.get_active_wallets()) {
+            auto&& [addr, wallet] = wallet_map.at(index);
             uint64_t w_state = wallet->get_state();
 
             bool doing_forging = false;
@@ -94,7 +88,7 @@ bool BlockChain::can_apply_forging_block(block::Block* block)
             }
 
             if (doing_forging) {
-                if (forging_nodes_add_trust.find(wallet_pair.first) != forging_nodes_add_trust.end()) {
+                if (forging_nodes_add_trust.find(addr) != forging_nodes_add_trust.end()) {
                     wallet->add_trust();
                 } else {
                     wallet->sub_trust();
@@ -102,19 +96,18 @@ bool BlockChain::can_apply_forging_block(block::Block* block)
             }
         }
 
-        for (auto& wallet_pair : wallet_map) {
-            auto* wallet = dynamic_cast<meta_wallet::CommonWallet*>(wallet_pair.second);
-            if (!wallet) {
-                DEBUG_COUT("invalid wallet type");
-                DEBUG_COUT(wallet_pair.first);
-                continue;
-            }
+        // проход меняет доверие, делегирование и флаги активных кошельков, у основателей ещё и лимит -
+        // все они обновляются в дереве и снимке состояния
+        for (auto index : wallet_map.get_active_wallets()) {
+            auto&& [addr, wallet] = wallet_map.at(index);
             wallet->apply_delegates();
+            temp_touched_wallets.insert(addr);
         }
 
         {
-            auto* father_of_wallets = dynamic_cast<meta_wallet::CommonWallet*>(wallet_map.get_wallet(MASTER_WALLET_COIN_FORGING));
-            auto* lookup_addreses = new std::deque<std::pair<std::string, uint64_t>>(father_of_wallets->get_delegated_from_list());
+            auto* father_of_wallets = wallet_map.get_wallet(MASTER_WALLET_COIN_FORGING);
+            auto delegated_from = father_of_wallets->get_delegated_from_list();
+            auto* lookup_addreses = new std::deque<std::pair<std::string, uint64_t>>(delegated_from.begin(), delegated_from.end());
 
             while (true) {
                 std::deque<std::pair<std::string, uint64_t>>* lookup_addreses_prev = wallet_request_addreses.load();
@@ -144,12 +137,12 @@ bool BlockChain::can_apply_forging_block(block::Block* block)
                 }
             };
 
-            auto* father_of_nodes = dynamic_cast<meta_wallet::CommonWallet*>(wallet_map.get_wallet(MASTER_WALLET_NODE_FORGING));
+            auto* father_of_nodes = wallet_map.get_wallet(MASTER_WALLET_NODE_FORGING);
             std::set<std::string> nodes;
             for (auto& delegate_pair : father_of_nodes->get_delegated_from_list()) {
-                auto* wallet = dynamic_cast<meta_wallet::CommonWallet*>(wallet_map.get_wallet(delegate_pair.first));
+                auto* wallet = wallet_map.get_wallet(delegate_pair.first);
                 if (!wallet) {
-                    DEBUG_COUT("invalid wallet type");
+                    DEBUG_COUT("invalid wallet");
                     DEBUG_COUT(delegate_pair.first);
                     continue;
                 }
@@ -159,17 +152,11 @@ bool BlockChain::can_apply_forging_block(block::Block* block)
                 wallet->set_state(w_state);
                 nodes.insert(delegate_pair.first);
             }
-            for (auto& wallet_pair : wallet_map) {
-                auto* wallet = dynamic_cast<meta_wallet::CommonWallet*>(wallet_pair.second);
-                if (!wallet) {
-                    DEBUG_COUT("invalid wallet type");
-                    DEBUG_COUT(wallet_pair.first);
-                    continue;
-                }
-
+            for (auto index : wallet_map.get_active_wallets()) {
+                auto&& [addr, wallet] = wallet_map.at(index);
                 uint64_t w_state = wallet->get_state();
                 if (w_state & NODE_STATE_FLAG_PRETEND_COMMON) {
-                    if (nodes.find(wallet_pair.first) == nodes.end()) {
+                    if (nodes.find(addr) == nodes.end()) {
                         w_state &= ~NODE_STATE_FLAG_PRETEND_COMMON;
                     }
                 }
@@ -179,7 +166,7 @@ bool BlockChain::can_apply_forging_block(block::Block* block)
 
                     uint64_t seed_sum = 0;
                     for (auto& delegate_pair : wallet->get_delegated_from_list()) {
-                        if (delegate_pair.first == wallet_pair.first) {
+                        if (delegate_pair.first == addr) {
                             seed_sum += delegate_pair.second;
                         }
                     }
@@ -8,88 +8,103 @@ namespace metahash::meta_chain {
 bool BlockChain::can_apply_state_block(block::Block* block, bool check)
 {
     wallet_map.get_wallet(ZERO_WALLET)->initialize(0, 0, "");
+    temp_touched_wallets.insert(ZERO_WALLET);
 
     auto common_block = dynamic_cast<block::CommonBlock*>(block);
 
     if (common_block) {
 
         if (check) {
-            if (common_block->get_block_timestamp() >= 1572120000) {
-                for (const auto& tx : common_block->get_txs(io_context)) {
-                    const std::string& addr = tx.addr_to;
-                    auto wallet_to = wallet_map.get_wallet(addr);
+            const bool check_data = common_block->get_block_timestamp() >= 1572120000;
+            const auto txs = common_block->get_txs(cpu_pool);
 
-                    if (!wallet_to) {
-                        DEBUG_COUT("invalid wallet:\t" + addr);
-                        continue;
-                    }
+            auto&& compare = [check_data](const transaction::TX& tx, meta_wallet::Wallet* wallet_to) {
+                uint64_t nonce = 0;
+                uint64_t value;
+                std::string data;
 
-                    if (auto* common_wallet = dynamic_cast<meta_wallet::CommonWallet*>(wallet_to)) {
-                        uint64_t nonce = 0;
-                        uint64_t value;
-                        std::string data;
+                std::tie(value, nonce, data) = wallet_to->serialize();
 
-                        std::tie(value, nonce, data) = common_wallet->serialize();
+                if (tx.nonce != nonce) {
+                    DEBUG_COUT("nonce not equal in state block");
+                    DEBUG_COUT(tx.addr_to);
 
-                        if (tx.nonce != nonce) {
-                            DEBUG_COUT("nonce not equal in state block");
-                            DEBUG_COUT(addr);
+                    return false;
+                }
 
-                            return false;
-                        }
+                if (tx.value != value) {
+                    DEBUG_COUT("balance not equal in state block");
+                    DEBUG_COUT(tx.addr_to);
+                    DEBUG_COUT(tx.value);
+                    DEBUG_COUT(value);
 
-                        if (tx.value != value) {
-                            DEBUG_COUT("balance not equal in state block");
-                            DEBUG_COUT(addr);
-                            DEBUG_COUT(tx.value);
-                            DEBUG_COUT(value);
+                    return false;
+                }
 
-                            return false;
-                        }
+                if (check_data && tx.data != data) {
+                    DEBUG_COUT("data not equal in state block");
+                    DEBUG_COUT(tx.addr_to);
+                    DEBUG_COUT(tx.data);
+                    DEBUG_COUT(data);
+                }
 
-                        if (tx.data != data) {
-                            DEBUG_COUT("data not equal in state block");
-                            DEBUG_COUT(addr);
-                            DEBUG_COUT(tx.data);
-                            DEBUG_COUT(data);
-                        }
+                return true;
+            };
+
+            // существующие кошельки сверяются параллельно; отсутствующие get_wallet создаёт,
+            // поэтому они проверяются потом по порядку и только до первого расхождения
+            const uint64_t chunk_count = get_chunk_count(txs.size(), PARALLEL_STATE_CHUNK_MIN);
+            const uint64_t chunk_size = (txs.size() + chunk_count - 1) / chunk_count;
+
+            std::atomic<uint64_t> first_mismatch = txs.size();
+            std::vector<std::vector<uint64_t>> chunk_missing(chunk_count);
+
+            run_chunks(chunk_count, [&](uint64_t chunk) {
+                for (uint64_t i = chunk * chunk_size; i < txs.size() && i < (chunk + 1) * chunk_size; i++) {
+                    if (i > first_mismatch.load(std::memory_order_relaxed)) {
+                        break;
                     }
-                }
-            } else {
-                for (const auto& tx : common_block->get_txs(io_context)) {
-                    const std::string& addr_to = tx.addr_to;
-                    auto wallet_to = wallet_map.get_wallet(addr_to);
 
+                    auto* wallet_to = wallet_map.find_wallet(txs[i].addr_to);
                     if (!wallet_to) {
-                        DEBUG_COUT("invalid wallet:\t" + addr_to);
+                        chunk_missing[chunk].push_back(i);
                         continue;
                     }
 
-                    uint64_t nonce = 0;
-                    uint64_t value;
-                    std::string data;
+                    if (!compare(txs[i], wallet_to)) {
+                        uint64_t prev = first_mismatch.load();
+                        while (i < prev && !first_mismatch.compare_exchange_weak(prev, i)) {
+                        }
+                        break;
+                    }
+                }
+            });
 
-                    std::tie(value, nonce, data) = wallet_to->serialize();
+            for (const auto& missing : chunk_missing) {
+                for (uint64_t i : missing) {
+                    if (i > first_mismatch) {
+                        break;
+                    }
 
-                    if (tx.nonce != nonce) {
-                        DEBUG_COUT("nonce not equal in state block");
-                        DEBUG_COUT(addr_to);
+                    const auto& tx = txs[i];
+                    auto wallet_to = wallet_map.get_wallet(tx.addr_to);
 
-                        return false;
+                    if (!wallet_to) {
+                        DEBUG_COUT("invalid wallet:\t" + tx.addr_to);
+                        continue;
                     }
 
-                    if (tx.value != value) {
-                        DEBUG_COUT("balance not equal in state block");
-                        DEBUG_COUT(addr_to);
-                        DEBUG_COUT(tx.value);
-                        DEBUG_COUT(value);
-
+                    if (!compare(tx, wallet_to)) {
                         return false;
                     }
                 }
             }
+
+            if (first_mismatch < txs.size()) {
+                return false;
+            }
         } else {
-            for (const auto& tx : common_block->get_txs(io_context)) {
+            for (const auto& tx : common_block->get_txs(cpu_pool)) {
                 const std::string& addr_to = tx.addr_to;
                 auto wallet_to = wallet_map.get_wallet(addr_to);
 
@@ -98,16 +113,13 @@ bool BlockChain::can_apply_state_block(block::Block* block, bool check)
                     continue;
                 }
 
-                if (auto common_wallet = dynamic_cast<meta_wallet::CommonWallet*>(wallet_to)) {
-                    common_wallet->initialize(tx.value, tx.nonce, std::string(tx.data));
-                } else {
-                    DEBUG_COUT("unknown wallet type wrong type");
-                }
+                wallet_to->initialize(tx.value, tx.nonce, std::string(tx.data));
             }
 
             {
-                auto* father_of_wallets = dynamic_cast<meta_wallet::CommonWallet*>(wallet_map.get_wallet(MASTER_WALLET_COIN_FORGING));
-                auto* lookup_addreses = new std::deque<std::pair<std::string, uint64_t>>(father_of_wallets->get_delegated_from_list());
+                auto* father_of_wallets = wallet_map.get_wallet(MASTER_WALLET_COIN_FORGING);
+                auto delegated_from = father_of_wallets->get_delegated_from_list();
+                auto* lookup_addreses = new std::deque<std::pair<std::string, uint64_t>>(delegated_from.begin(), delegated_from.end());
 
                 DEBUG_COUT("lookup_addreses.size() = \t" + std::to_string(lookup_addreses->size()));
 
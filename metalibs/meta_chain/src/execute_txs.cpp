@@ -0,0 +1,124 @@
+#include <meta_chain.h>
+
+#include <meta_constants.hpp>
+#include <meta_log.hpp>
+
+#include <numeric>
+
+namespace metahash::meta_chain {
+
+bool BlockChain::execute_txs(std::vector<TxApply>& txs, meta_wallet::Wallet* fee_wallet, bool stop_on_error)
+{
+    // Комиссии копятся в задачах и зачисляются на fee_wallet после отрезка, поэтому fee_wallet не ключ конфликта
+    // для каждой транзакции с комиссией. Транзакция, списывающая с fee_wallet, должна видеть все комиссии до себя
+    // и начинает новый отрезок; свою комиссию она зачисляет сразу, fee_wallet и так её ключ.
+    // Мастер-кошельки форжинга сюда не входят: делегирование на них дописывает в упорядоченный delegated_from,
+    // порядок которого влияет на награды, так что их транзакции остаются обычными ключами конфликта.
+    auto&& apply_tx = [fee_wallet](TxApply& task) {
+        auto&& credit_fee = [&task, fee_wallet] {
+            if (task.wallet_from == fee_wallet) {
+                fee_wallet->add(task.real_fee);
+            } else {
+                task.credited = task.real_fee;
+            }
+        };
+
+        task.status = task.wallet_from->sub(task.wallet_to, task.tx, task.real_fee);
+        if (task.status > 0) {
+            return;
+        }
+
+        if (task.fee_credit == FEE_CREDIT_BEFORE_METHOD) {
+            credit_fee();
+        }
+        if (task.apply_method) {
+            task.method_ok = task.wallet_from->try_apply_method(task.wallet_to, task.tx);
+        }
+        if (task.fee_credit == FEE_CREDIT_AFTER_METHOD && task.method_ok) {
+            credit_fee();
+        }
+    };
+
+    auto& journal = wallet_map.get_journal();
+
+    for (uint64_t segment_begin = 0, segment_end = 0; segment_begin < txs.size(); segment_begin = segment_end) {
+        segment_end = segment_begin + 1;
+        while (segment_end < txs.size() && txs[segment_end].wallet_from != fee_wallet) {
+            segment_end++;
+        }
+        const uint64_t segment_size = segment_end - segment_begin;
+
+        std::vector<std::vector<uint64_t>> batches;
+        if (segment_size < parallel_tx_batch_min) {
+            batches.emplace_back(segment_size);
+            std::iota(batches.back().begin(), batches.back().end(), segment_begin);
+        } else {
+            std::unordered_map<meta_wallet::Wallet*, uint64_t> wallet_batch;
+            wallet_batch.reserve(segment_size * 2);
+            for (uint64_t i = segment_begin; i < segment_end; i++) {
+                auto& task = txs[i];
+
+                uint64_t batch = 0;
+                for (auto* key : { task.wallet_from, task.wallet_to }) {
+                    auto it = wallet_batch.find(key);
+                    if (it != wallet_batch.end() && it->second + 1 > batch) {
+                        batch = it->second + 1;
+                    }
+                }
+                wallet_batch[task.wallet_from] = batch;
+                wallet_batch[task.wallet_to] = batch;
+
+                if (batches.size() <= batch) {
+                    batches.resize(batch + 1);
+                }
+                batches[batch].push_back(i);
+            }
+        }
+
+        for (auto& batch : batches) {
+            if (batch.size() < parallel_tx_batch_min) {
+                for (auto i : batch) {
+                    apply_tx(txs[i]);
+                }
+            } else {
+                // пакеты выполняются в пуле, вызывающий поток берёт свой отрезок наравне с потоками пула
+                uint64_t chunk_count = get_chunk_count(batch.size(), PARALLEL_TX_CHUNK_MIN);
+                uint64_t chunk_size = (batch.size() + chunk_count - 1) / chunk_count;
+                std::vector<meta_wallet::WalletJournal::Segment> segments(chunk_count);
+
+                run_chunks(chunk_count, [&](uint64_t chunk) {
+                    meta_wallet::WalletJournal::redirect(&segments[chunk]);
+                    for (uint64_t i = chunk * chunk_size; i < batch.size() && i < (chunk + 1) * chunk_size; i++) {
+                        apply_tx(txs[batch[i]]);
+                    }
+                    meta_wallet::WalletJournal::redirect(nullptr);
+                });
+
+                for (auto& segment : segments) {
+                    journal.merge(segment);
+                }
+            }
+
+            if (stop_on_error) {
+                for (auto i : batch) {
+                    auto& task = txs[i];
+                    if (task.required && (task.status > 0 || !task.method_ok)) {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        uint64_t fee_sum = 0;
+        for (uint64_t i = segment_begin; i < segment_end; i++) {
+            fee_sum += txs[i].credited;
+        }
+        if (fee_sum) {
+            fee_wallet->add(fee_sum);
+        }
+    }
+
+    return true;
+}
+
+}
@@ -26,9 +26,15 @@ bool BlockChain::apply_block(block::Block* block)
 
                 DEBUG_COUT(buffer);
             }
-            fill_node_state();
+            node_roles_snapshot.publish(node_roles);
+            DEBUG_COUT("state_root\t" + crypto::bin2hex(state_tree.get_root()));
         }
 
+        StateRoot state_root;
+        state_root.block_hash = prev_hash;
+        state_root.root = state_tree.get_root();
+        state_root_snapshot.publish(state_root);
+
         return true;
     }
 
@@ -57,18 +63,24 @@ std::atomic<std::deque<std::pair<std::string, uint64_t>>*>& BlockChain::get_wall
     return wallet_request_addreses;
 }
 
-std::set<std::string> BlockChain::check_addr(const std::string& addr)
+uint64_t BlockChain::check_addr(const std::string& addr)
 {
-    if (node_state.find(addr) == node_state.end()) {
-        return std::set<std::string>();
-    } else {
-        return node_state[addr];
+    auto roles = node_roles_snapshot.read();
+    auto it = roles->find(addr);
+    if (it == roles->end()) {
+        return 0;
     }
+    return it->second;
+}
+
+pool::RcuSnapshot<BlockChain::NodeRoles>::Reader BlockChain::get_node_state()
+{
+    return node_roles_snapshot.read();
 }
 
-const std::unordered_map<std::string, std::set<std::string>, crypto::Hasher>& BlockChain::get_node_state()
+pool::RcuSnapshot<StateRoot>::Reader BlockChain::get_last_state_root()
 {
-    return node_state;
+    return state_root_snapshot.read();
 }
 
 }
\ No newline at end of file
@@ -43,7 +43,9 @@ std::vector<char> BlockChain::make_forging_tx(const std::string& address, uint64
 block::Block* BlockChain::make_forging_block(uint64_t timestamp)
 {
     uint64_t block_type = BLOCK_TYPE_FORGING;
-    std::vector<char> txs_buff;
+    block::BlockBuilder builder(block_type, timestamp, prev_hash);
+
+    rollback_block_template();
 
     auto state_fee = wallet_map.get_wallet(STATE_FEE_WALLET);
     const uint64_t pool = (FORGING_POOL(timestamp) + state_fee->get_value());
@@ -51,27 +53,24 @@ block::Block* BlockChain::make_forging_block(uint64_t timestamp)
     {
         auto&& [type_geo_node_delegates, delegates] = make_forging_block_get_node_stats();        
 
-        make_forging_block_node_reward(pool, type_geo_node_delegates, txs_buff);
-        make_forging_block_coin_reward(pool, delegates, txs_buff);
+        make_forging_block_node_reward(pool, type_geo_node_delegates, builder);
+        make_forging_block_coin_reward(pool, delegates, builder);
     }
 
     {
         auto&& [active_forging, pasive_forging] = make_forging_block_get_wallet_stats();
 
-        make_forging_block_wallet_reward(pool, pasive_forging, txs_buff);
-        make_forging_block_random_reward(pool, active_forging, txs_buff);
+        make_forging_block_wallet_reward(pool, pasive_forging, builder);
+        make_forging_block_random_reward(pool, active_forging, builder);
     }
 
     {
         auto&& state_tx = make_forging_tx(TEAM_WALLET, FORGING_TEAM_REWARD, {}, TX_STATE_FORGING_TEAM);
 
-        crypto::append_varint(txs_buff, state_tx.size());
-        txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+        builder.add_tx(state_tx);
     }
 
-    txs_buff.push_back(0);
-
-    return make_block(block_type, timestamp, prev_hash, txs_buff);
+    return builder.make();
 }
 
 }
\ No newline at end of file
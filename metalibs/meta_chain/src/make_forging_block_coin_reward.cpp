@@ -5,7 +5,7 @@
 
 namespace metahash::meta_chain {
 
-void BlockChain::make_forging_block_coin_reward(const uint64_t pool, std::map<std::string, uint64_t>& delegates, std::vector<char>& txs_buff)
+void BlockChain::make_forging_block_coin_reward(const uint64_t pool, std::map<std::string, uint64_t>& delegates, block::BlockBuilder& builder)
 {
     uint64_t forging_coin_units = 0;
     for (auto& delegate_pair : delegates) {
@@ -29,8 +29,7 @@ void BlockChain::make_forging_block_coin_reward(const uint64_t pool, std::map<st
             auto&& state_tx = make_forging_tx(coin_addres, forging_coin, {}, TX_STATE_FORGING_C);
 
             if (!state_tx.empty()) {
-                crypto::append_varint(txs_buff, state_tx.size());
-                txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+                builder.add_tx(state_tx);
             }
         }
     }
@@ -12,31 +12,35 @@ std::pair<std::map<std::string, std::map<std::string, std::map<std::string, uint
     std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>>> type_geo_node_delegates;
 
     std::set<std::string> revard_nodes;
+    const auto& geos = node_statistics.get_geos();
     //TODO Add Cores
-    for (auto&& [type, nodes] : node_statistics) {
-        if (ROLES.find(type) == ROLES.end()) {
-            DEBUG_COUT("Unknown role:\t" + type);
-            continue;
-        }
-        for (auto&& [addr, node_stat] : nodes) {
-            auto* wallet = dynamic_cast<meta_wallet::CommonWallet*>(wallet_map.get_wallet(addr));
+    for (auto&& [type, role] : node_statistics.get_active_roles()) {
+        const auto state_mask = NODE_STATE_FLAG_FORGING.at(type);
+        const auto hard_cap = NODE_HARD_CAP.at(type);
+
+        for (const auto& node_stat : node_statistics.get_nodes(role)) {
+            const auto& addr = node_stat.address;
+            auto* wallet = wallet_map.find_wallet(addr);
             if (wallet) {
                 const auto w_state = wallet->get_state();
-                const auto state_mask = NODE_STATE_FLAG_FORGING.at(type);
 
                 if ((w_state & state_mask) == state_mask) {
                     std::string geo;
                     uint64_t success_size = 0;
                     uint64_t average = 0;
 
-                    for (auto&& [geo_name, geo_stat] : node_stat.stats) {
+                    for (uint64_t geo_index = 0; geo_index < geos.size(); geo_index++) {
+                        const auto& [tests, sum] = node_stat.geo_stats[geo_index];
+                        if (!tests) {
+                            continue;
+                        }
 
-                        success_size += geo_stat.second;
-                        uint64_t geo_average = geo_stat.second / geo_stat.first;
+                        success_size += sum;
+                        uint64_t geo_average = sum / tests;
 
                         if (geo_average > average) {
                             average = geo_average;
-                            geo = geo_name;
+                            geo = geos[geo_index];
                         }
                     }
 
@@ -46,8 +50,8 @@ std::pair<std::map<std::string, std::map<std::string, std::map<std::string, uint
                         for (auto&& [d_addr, d_value] : wallet->get_delegated_from_list()) {
 
                             uint64_t node_wallet_delegate;
-                            if (node_total_delegate + d_value > NODE_HARD_CAP.at(type)) {
-                                node_wallet_delegate = NODE_HARD_CAP.at(type) - node_total_delegate;
+                            if (node_total_delegate + d_value > hard_cap) {
+                                node_wallet_delegate = hard_cap - node_total_delegate;
                             } else {
                                 node_wallet_delegate = d_value;
                             }
@@ -55,15 +59,15 @@ std::pair<std::map<std::string, std::map<std::string, std::map<std::string, uint
                             delegates[d_addr] += node_wallet_delegate;
 
                             node_total_delegate += node_wallet_delegate;
-                            if (node_total_delegate >= NODE_HARD_CAP.at(type)) {
+                            if (node_total_delegate >= hard_cap) {
                                 break;
                             }
                         }
 
-                        if (node_total_delegate <= NODE_HARD_CAP.at(type)) {
+                        if (node_total_delegate <= hard_cap) {
                             type_geo_node_delegates[type][geo][addr] = node_total_delegate;
                         } else {
-                            type_geo_node_delegates[type][geo][addr] = NODE_HARD_CAP.at(type);
+                            type_geo_node_delegates[type][geo][addr] = hard_cap;
                         }
 
                     } else {
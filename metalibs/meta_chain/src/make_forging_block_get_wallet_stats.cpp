@@ -5,7 +5,7 @@
 
 namespace metahash::meta_chain {
 
-std::pair<std::deque<std::string>, std::map<std::string, uint64_t>> BlockChain::make_forging_block_get_wallet_stats()
+std::pair<BlockChain::ForgingTickets, std::map<std::string, uint64_t>> BlockChain::make_forging_block_get_wallet_stats()
 {
     std::map<std::string, std::pair<uint, uint>>* address_statistics;
     while (true) {
@@ -16,7 +16,7 @@ std::pair<std::deque<std::string>, std::map<std::string, uint64_t>> BlockChain::
         }
     }
 
-    std::deque<std::string> active_forging;
+    ForgingTickets active_forging;
     std::map<std::string, uint64_t> pasive_forging;
 
     if (address_statistics) {
@@ -27,9 +27,8 @@ std::pair<std::deque<std::string>, std::map<std::string, uint64_t>> BlockChain::
             if (addr_stat.second.second) {
                 pasive_forging[addr_stat.first] += 1;
 
-                for (uint i = 0; i < addr_stat.second.second; i++) {
-                    active_forging.push_back(addr_stat.first);
-                }
+                active_forging.addresses.push_back(addr_stat.first);
+                active_forging.counts.push_back(addr_stat.second.second);
             }
         }
     } else {
@@ -5,7 +5,7 @@
 
 namespace metahash::meta_chain {
 
-void BlockChain::make_forging_block_node_reward(const uint64_t pool, std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>>>& type_geo_node_delegates, std::vector<char>& txs_buff)
+void BlockChain::make_forging_block_node_reward(const uint64_t pool, std::map<std::string, std::map<std::string, std::map<std::string, uint64_t>>>& type_geo_node_delegates, block::BlockBuilder& builder)
 {
     if (!type_geo_node_delegates.empty()) {
         std::set<std::string> reward_nodes;
@@ -127,8 +127,7 @@ void BlockChain::make_forging_block_node_reward(const uint64_t pool, std::map<st
                     auto&& state_tx = make_forging_tx(node_name, forging_node_reward + forging_node_reward_geo, {}, TX_STATE_FORGING_N);
 
                     if (!state_tx.empty()) {
-                        crypto::append_varint(txs_buff, state_tx.size());
-                        txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+                        builder.add_tx(state_tx);
                     }
                 }
             }
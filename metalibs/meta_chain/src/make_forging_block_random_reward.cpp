@@ -7,29 +7,46 @@
 
 namespace metahash::meta_chain {
 
-void BlockChain::make_forging_block_random_reward(const uint64_t pool, std::deque<std::string>& active_forging, std::vector<char>& txs_buff)
+void BlockChain::make_forging_block_random_reward(const uint64_t pool, ForgingTickets& active_forging, block::BlockBuilder& builder)
 {
-    if (!active_forging.empty()) {
+    uint64_t ticket_count = 0;
+    for (auto count : active_forging.counts) {
+        ticket_count += count;
+    }
+
+    if (ticket_count) {
+        // билет - индекс кошелька; std::shuffle переставляет их так же, как раньше строки адресов
+        std::vector<uint32_t> tickets;
+        tickets.reserve(ticket_count);
+        for (uint32_t wallet = 0; wallet < active_forging.counts.size(); wallet++) {
+            tickets.insert(tickets.end(), active_forging.counts[wallet], wallet);
+        }
+
         {
             DEBUG_COUT("state_hash_xx64\t" + std::to_string(state_hash_xx64));
             std::mt19937_64 r;
             r.seed(state_hash_xx64);
-            std::shuffle(active_forging.begin(), active_forging.end(), r);
+            std::shuffle(tickets.begin(), tickets.end(), r);
         }
 
-        for (uint i = 0; i < 1000; i++) {
-            if (active_forging.size() > i) {
-                auto addr = active_forging[i];
-                for (auto addr_it = active_forging.begin() + i + 1; addr_it != active_forging.end();) {
-                    if (*addr_it == addr) {
-                        addr_it = active_forging.erase(addr_it);
-                    } else {
-                        addr_it++;
-                    }
-                }
+        // победители - первые 1000 различных кошельков в перемешанном порядке
+        std::vector<uint8_t> seen(active_forging.counts.size(), false);
+        std::vector<const std::string*> winners;
+        uint64_t winner_tickets = 0;
+        for (auto wallet : tickets) {
+            if (winners.size() >= 1000) {
+                break;
+            }
+            if (!seen[wallet]) {
+                seen[wallet] = true;
+                winners.push_back(&active_forging.addresses[wallet]);
+                winner_tickets += active_forging.counts[wallet];
             }
         }
 
+        // размер списка после удаления повторов победителей
+        const uint64_t forging_size = ticket_count - winner_tickets + winners.size();
+
         const uint64_t forging_count_total = (pool * 10) / 100;
 
         const uint64_t FORGING_RANDOM_REWARD_1 = forging_count_total * 4 / 10;
@@ -42,74 +59,67 @@ void BlockChain::make_forging_block_random_reward(const uint64_t pool, std::dequ
         const uint64_t FORGING_RANDOM_REWARD_101_1000 = forging_count_total * 2 / 10000;
 
         uint64_t reward_bank = 0;
-        if (active_forging.size() < 1000) {
-            if (active_forging.size() >= 100) {
-                reward_bank += FORGING_RANDOM_REWARD_101_1000 * (1000 - active_forging.size());
+        if (forging_size < 1000) {
+            if (forging_size >= 100) {
+                reward_bank += FORGING_RANDOM_REWARD_101_1000 * (1000 - forging_size);
             } else {
                 reward_bank += FORGING_RANDOM_REWARD_101_1000 * (1000 - 100);
-                if (active_forging.size() >= 6) {
-                    reward_bank += FORGING_RANDOM_REWARD_6_100 * (100 - active_forging.size());
+                if (forging_size >= 6) {
+                    reward_bank += FORGING_RANDOM_REWARD_6_100 * (100 - forging_size);
                 } else {
                     reward_bank += FORGING_RANDOM_REWARD_6_100 * (100 - 6);
 
-                    if (active_forging.size() < 5) {
+                    if (forging_size < 5) {
                         reward_bank += FORGING_RANDOM_REWARD_5;
                     }
-                    if (active_forging.size() < 4) {
+                    if (forging_size < 4) {
                         reward_bank += FORGING_RANDOM_REWARD_4;
                     }
-                    if (active_forging.size() < 3) {
+                    if (forging_size < 3) {
                         reward_bank += FORGING_RANDOM_REWARD_3;
                     }
-                    if (active_forging.size() < 2) {
+                    if (forging_size < 2) {
                         reward_bank += FORGING_RANDOM_REWARD_2;
                     }
                 }
             }
         }
 
-        uint64_t reward_bank_per_one = reward_bank / active_forging.size();
-        for (uint i = 0; i < 1 && i < active_forging.size(); i++) {
-            auto&& state_tx = make_forging_tx(active_forging[i], FORGING_RANDOM_REWARD_1 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
+        uint64_t reward_bank_per_one = reward_bank / forging_size;
+        for (uint i = 0; i < 1 && i < winners.size(); i++) {
+            auto&& state_tx = make_forging_tx(*winners[i], FORGING_RANDOM_REWARD_1 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
 
-            crypto::append_varint(txs_buff, state_tx.size());
-            txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+            builder.add_tx(state_tx);
         }
-        for (uint i = 1; i < 2 && i < active_forging.size(); i++) {
-            auto&& state_tx = make_forging_tx(active_forging[i], FORGING_RANDOM_REWARD_2 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
+        for (uint i = 1; i < 2 && i < winners.size(); i++) {
+            auto&& state_tx = make_forging_tx(*winners[i], FORGING_RANDOM_REWARD_2 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
 
-            crypto::append_varint(txs_buff, state_tx.size());
-            txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+            builder.add_tx(state_tx);
         }
-        for (uint i = 2; i < 3 && i < active_forging.size(); i++) {
-            auto&& state_tx = make_forging_tx(active_forging[i], FORGING_RANDOM_REWARD_3 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
+        for (uint i = 2; i < 3 && i < winners.size(); i++) {
+            auto&& state_tx = make_forging_tx(*winners[i], FORGING_RANDOM_REWARD_3 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
 
-            crypto::append_varint(txs_buff, state_tx.size());
-            txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+            builder.add_tx(state_tx);
         }
-        for (uint i = 3; i < 4 && i < active_forging.size(); i++) {
-            auto&& state_tx = make_forging_tx(active_forging[i], FORGING_RANDOM_REWARD_4 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
+        for (uint i = 3; i < 4 && i < winners.size(); i++) {
+            auto&& state_tx = make_forging_tx(*winners[i], FORGING_RANDOM_REWARD_4 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
 
-            crypto::append_varint(txs_buff, state_tx.size());
-            txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+            builder.add_tx(state_tx);
         }
-        for (uint i = 4; i < 5 && i < active_forging.size(); i++) {
-            auto&& state_tx = make_forging_tx(active_forging[i], FORGING_RANDOM_REWARD_5 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
+        for (uint i = 4; i < 5 && i < winners.size(); i++) {
+            auto&& state_tx = make_forging_tx(*winners[i], FORGING_RANDOM_REWARD_5 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
 
-            crypto::append_varint(txs_buff, state_tx.size());
-            txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+            builder.add_tx(state_tx);
         }
-        for (uint i = 5; i < 100 && i < active_forging.size(); i++) {
-            auto&& state_tx = make_forging_tx(active_forging[i], FORGING_RANDOM_REWARD_6_100 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
+        for (uint i = 5; i < 100 && i < winners.size(); i++) {
+            auto&& state_tx = make_forging_tx(*winners[i], FORGING_RANDOM_REWARD_6_100 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
 
-            crypto::append_varint(txs_buff, state_tx.size());
-            txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+            builder.add_tx(state_tx);
         }
-        for (uint i = 100; i < 1000 && i < active_forging.size(); i++) {
-            auto&& state_tx = make_forging_tx(active_forging[i], FORGING_RANDOM_REWARD_101_1000 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
+        for (uint i = 100; i < 1000 && i < winners.size(); i++) {
+            auto&& state_tx = make_forging_tx(*winners[i], FORGING_RANDOM_REWARD_101_1000 + reward_bank_per_one, {}, TX_STATE_FORGING_R);
 
-            crypto::append_varint(txs_buff, state_tx.size());
-            txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+            builder.add_tx(state_tx);
         }
     }
 }
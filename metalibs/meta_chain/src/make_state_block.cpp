@@ -7,50 +7,90 @@ namespace metahash::meta_chain {
 block::Block* BlockChain::make_state_block(uint64_t timestamp)
 {
     const uint64_t block_type = BLOCK_TYPE_STATE;
-    std::vector<char> txs_buff;
     static const std::vector<unsigned char> zero_bin_addres(25, 0x00);
 
-    for (auto& wallet_pair : wallet_map) {
+    rollback_block_template();
 
-        if (!wallet_pair.second) {
-            DEBUG_COUT("invalid wallet:\t" + wallet_pair.first);
-            continue;
-        }
+    // каждый поток собирает свой диапазон кошельков, буферы склеиваются по порядку
+    const uint64_t wallet_count = wallet_map.size();
+    const uint64_t chunk_count = get_chunk_count(wallet_count, PARALLEL_STATE_CHUNK_MIN);
+    const uint64_t chunk_size = (wallet_count + chunk_count - 1) / chunk_count;
+
+    block::BlockBuilder builder(block_type, timestamp, prev_hash);
+    const bool merkle_root = builder.has_merkle_root();
+
+    std::vector<std::vector<char>> chunk_buffs(chunk_count);
+    std::vector<std::vector<sha256_2>> chunk_hashes(chunk_count);
+    std::vector<meta_wallet::WalletJournal::Segment> segments(chunk_count);
+
+    run_chunks(chunk_count, [&](uint64_t chunk) {
+        meta_wallet::WalletJournal::redirect(&segments[chunk]);
 
+        auto& txs_buff = chunk_buffs[chunk];
         std::vector<char> state_tx;
-        auto bin_addres = crypto::hex2bin(wallet_pair.first);
+        for (uint64_t i = chunk * chunk_size; i < wallet_count && i < (chunk + 1) * chunk_size; i++) {
+            auto&& [addr, wallet] = wallet_map.at(i);
+            auto bin_addres = crypto::hex2bin(addr);
 
-        if (bin_addres.size() != 25) {
-            continue;
-        }
+            if (bin_addres.size() != 25) {
+                continue;
+            }
 
-        if (bin_addres == zero_bin_addres) {
-            wallet_pair.second->initialize(0, 0, "");
-        }
+            if (bin_addres == zero_bin_addres) {
+                wallet->initialize(0, 0, "");
+            }
 
-        auto&& [value, nonce, json] = wallet_pair.second->serialize();
+            auto&& [value, nonce, json] = wallet->serialize();
 
-        state_tx.insert(state_tx.end(), bin_addres.begin(), bin_addres.end());
+            state_tx.clear();
+            state_tx.insert(state_tx.end(), bin_addres.begin(), bin_addres.end());
 
-        crypto::append_varint(state_tx, value);
-        crypto::append_varint(state_tx, 0);
-        crypto::append_varint(state_tx, nonce);
+            crypto::append_varint(state_tx, value);
+            crypto::append_varint(state_tx, 0);
+            crypto::append_varint(state_tx, nonce);
 
-        crypto::append_varint(state_tx, json.size());
-        state_tx.insert(state_tx.end(), json.begin(), json.end());
+            crypto::append_varint(state_tx, json.size());
+            state_tx.insert(state_tx.end(), json.begin(), json.end());
 
-        crypto::append_varint(state_tx, 0);
-        crypto::append_varint(state_tx, 0);
+            crypto::append_varint(state_tx, 0);
+            crypto::append_varint(state_tx, 0);
 
-        crypto::append_varint(state_tx, TX_STATE_STATE);
+            crypto::append_varint(state_tx, TX_STATE_STATE);
+
+            crypto::append_varint(txs_buff, state_tx.size());
+            txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+        }
 
-        crypto::append_varint(txs_buff, state_tx.size());
-        txs_buff.insert(txs_buff.end(), state_tx.begin(), state_tx.end());
+        if (merkle_root) {
+            std::vector<std::string_view> state_txs;
+            crypto::ByteReader reader(std::string_view(txs_buff.data(), txs_buff.size()));
+            std::string_view tx;
+            while (reader.remaining() && reader.read_frame(tx)) {
+                state_txs.push_back(tx);
+            }
+            crypto::get_sha256_batch(state_txs, chunk_hashes[chunk]);
+        }
+
+        meta_wallet::WalletJournal::redirect(nullptr);
+    });
+
+    auto& journal = wallet_map.get_journal();
+    for (auto& segment : segments) {
+        journal.merge(segment);
     }
 
-    txs_buff.push_back(0);
+    uint64_t txs_size = 0;
+    for (const auto& chunk_buff : chunk_buffs) {
+        txs_size += chunk_buff.size();
+    }
 
-    return make_block(block_type, timestamp, prev_hash, txs_buff);
+    // листья дерева посчитаны в потоках, поэтому добавляются готовыми
+    builder.reserve(txs_size);
+    for (uint64_t chunk = 0; chunk < chunk_count; chunk++) {
+        builder.add_txs(chunk_buffs[chunk], chunk_hashes[chunk]);
+    }
+
+    return builder.make();
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,151 @@
+#include <meta_chain.h>
+
+#include <meta_constants.hpp>
+#include <meta_log.hpp>
+
+#include <cctype>
+#include <charconv>
+
+namespace metahash::meta_chain {
+
+namespace {
+
+    const std::string& get_parameter(const std::map<std::string, std::string>& parameters, const std::string& name)
+    {
+        static const std::string empty;
+        auto it = parameters.find(name);
+        return it != parameters.end() ? it->second : empty;
+    }
+
+    // разбор как у std::stol: пробелы в начале, знак, цифры до первого постороннего символа
+    bool parse_long(const std::string& str, int64_t& value)
+    {
+        const char* begin = str.data();
+        const char* end = str.data() + str.size();
+        while (begin != end && std::isspace(static_cast<unsigned char>(*begin))) {
+            begin++;
+        }
+        if (begin != end && *begin == '+') {
+            begin++;
+            if (begin != end && *begin == '-') {
+                return false;
+            }
+        }
+        auto [ptr, ec] = std::from_chars(begin, end, value);
+        return ec == std::errc();
+    }
+
+}
+
+NodeStatistics::NodeStatistics(const std::map<std::string, std::string>& test_nodes)
+    : role_names(ROLES.begin(), ROLES.end())
+    , node_index(ROLES.size())
+    , nodes(ROLES.size())
+{
+    std::set<std::string> geos;
+    for (auto&& [addr, geo] : test_nodes) {
+        geos.insert(geo);
+    }
+    geo_names.assign(geos.begin(), geos.end());
+
+    for (auto&& [addr, geo] : test_nodes) {
+        test_node_geo[addr] = std::lower_bound(geo_names.begin(), geo_names.end(), geo) - geo_names.begin();
+    }
+}
+
+bool NodeStatistics::decode(const transaction::TX& tx, Record& record) const
+{
+    auto geo_it = test_node_geo.find(tx.addr_from);
+    if (geo_it == test_node_geo.end() || !tx.json_rpc) {
+        return false;
+    }
+    record.geo = geo_it->second;
+
+    const auto& parameters = tx.json_rpc->parameters;
+    const auto& type = get_parameter(parameters, "type");
+    record.success = get_parameter(parameters, "success") != "false";
+
+    auto role_it = std::lower_bound(role_names.begin(), role_names.end(), type);
+    if (role_it != role_names.end() && *role_it == type) {
+        record.role = role_it - role_names.begin();
+        record.address = get_parameter(parameters, "address");
+
+        int64_t stat_value = 0;
+        if (type == META_ROLE_PROXY) {
+            if (!parse_long(get_parameter(parameters, "rps"), stat_value)) {
+                stat_value = 0;
+            }
+            record.value = stat_value;
+        } else {
+            if (!parse_long(get_parameter(parameters, "latency"), stat_value)) {
+                stat_value = 1'000'000;
+            }
+            record.value = uint64_t(stat_value) < 1'000'000 ? 1'000'000 - uint64_t(stat_value) : 0;
+        }
+    } else {
+        // старый формат: статистика прокси без поля type
+        record.role = std::lower_bound(role_names.begin(), role_names.end(), META_ROLE_PROXY) - role_names.begin();
+        record.address = get_parameter(parameters, "mhaddr");
+
+        int64_t rps = 0;
+        if (!parse_long(get_parameter(parameters, "rps"), rps)) {
+            rps = 1;
+        }
+        if (uint64_t(rps) > MINIMUM_PROXY_RPS && uint64_t(rps) < (1000l * 1000l)) {
+            record.value = 1'000'000'000 / uint64_t(rps);
+        } else {
+            record.success = false;
+        }
+    }
+
+    return true;
+}
+
+void NodeStatistics::add(const Record& record)
+{
+    auto& role_nodes = nodes[record.role];
+    if (role_nodes.empty()) {
+        active_roles.emplace(role_names[record.role], record.role);
+    }
+    auto [it, inserted] = node_index[record.role].emplace(record.address, role_nodes.size());
+    if (inserted) {
+        auto& node = role_nodes.emplace_back();
+        node.address = record.address;
+        node.geo_stats.resize(geo_names.size());
+    }
+
+    auto& node = role_nodes[it->second];
+    node.count++;
+    if (record.success) {
+        node.geo_stats[record.geo].first += 1;
+        node.geo_stats[record.geo].second += record.value;
+    }
+}
+
+void NodeStatistics::clear()
+{
+    for (auto& index : node_index) {
+        index.clear();
+    }
+    for (auto& role_nodes : nodes) {
+        role_nodes.clear();
+    }
+    active_roles.clear();
+}
+
+const std::unordered_map<std::string, uint64_t, crypto::Hasher>& NodeStatistics::get_active_roles() const
+{
+    return active_roles;
+}
+
+const std::vector<std::string>& NodeStatistics::get_geos() const
+{
+    return geo_names;
+}
+
+const std::vector<NodeStatistics::Node>& NodeStatistics::get_nodes(uint64_t role) const
+{
+    return nodes[role];
+}
+
+}
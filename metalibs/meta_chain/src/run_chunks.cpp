@@ -0,0 +1,24 @@
+#include <meta_chain.h>
+
+namespace metahash::meta_chain {
+
+uint64_t BlockChain::get_chunk_count(uint64_t item_count, uint64_t chunk_min)
+{
+    // run_chunks отдаёт в пул все порции, кроме первой, её выполняет вызывающий поток
+    const uint64_t thread_count = cpu_pool.get_thread_count() + 1;
+    return std::max<uint64_t>(std::min(thread_count, item_count / chunk_min), 1);
+}
+
+void BlockChain::run_chunks(uint64_t chunk_count, std::function<void(uint64_t)> work)
+{
+    pool::TaskGroup group(cpu_pool);
+    for (uint64_t chunk = 1; chunk < chunk_count; chunk++) {
+        group.run([&work, chunk] {
+            work(chunk);
+        });
+    }
+    work(0);
+    group.wait();
+}
+
+}
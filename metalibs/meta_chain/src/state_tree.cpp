@@ -0,0 +1,281 @@
+#include <meta_chain.h>
+
+#include <meta_constants.hpp>
+#include <meta_log.hpp>
+
+#include <algorithm>
+
+namespace metahash::meta_chain {
+
+namespace {
+
+    sha256_2 get_node_hash(const sha256_2& left, const sha256_2& right)
+    {
+        std::array<unsigned char, 64> buff;
+        std::copy(left.begin(), left.end(), buff.begin());
+        std::copy(right.begin(), right.end(), buff.begin() + 32);
+        return crypto::get_sha256(buff);
+    }
+
+    sha256_2 get_bucket_hash(const std::vector<sha256_2>& hashes)
+    {
+        static const sha256_2 zero_hash = { { 0 } };
+        if (hashes.empty()) {
+            return zero_hash;
+        }
+
+        std::vector<unsigned char> buff;
+        buff.reserve(hashes.size() * 32);
+        for (const auto& hash : hashes) {
+            buff.insert(buff.end(), hash.begin(), hash.end());
+        }
+        return crypto::get_sha256(buff);
+    }
+
+    bool address_less(const StateTree::Leaf& leaf, const std::string& addr)
+    {
+        return *leaf.address < addr;
+    }
+
+}
+
+StateTree::StateTree()
+    : buckets(STATE_TREE_BUCKETS)
+    , nodes(2 * STATE_TREE_BUCKETS)
+    , dirty(STATE_TREE_BUCKETS, false)
+{
+    for (uint64_t i = 0; i < STATE_TREE_BUCKETS; i++) {
+        mark_dirty(i);
+    }
+    commit();
+}
+
+uint64_t StateTree::get_bucket(const std::vector<unsigned char>& bin_addr)
+{
+    // первый байт - номер сети, дальше равномерно распределённый хеш ключа
+    return ((uint64_t(bin_addr[1]) << 8) | bin_addr[2]) % STATE_TREE_BUCKETS;
+}
+
+sha256_2 StateTree::get_leaf_hash(const std::vector<unsigned char>& bin_addr, uint64_t value, uint64_t nonce, const std::string& data)
+{
+    std::vector<unsigned char> buff;
+    buff.reserve(bin_addr.size() + 30 + data.size());
+    buff.insert(buff.end(), bin_addr.begin(), bin_addr.end());
+    crypto::append_varint(buff, value);
+    crypto::append_varint(buff, nonce);
+    crypto::append_varint(buff, data.size());
+    buff.insert(buff.end(), data.begin(), data.end());
+    return crypto::get_sha256(buff);
+}
+
+bool StateTree::make_leaf(const std::string& addr, meta_wallet::Wallet* wallet, Leaf& leaf)
+{
+    auto bin_addr = crypto::hex2bin(addr);
+    if (bin_addr.size() != 25) {
+        return false;
+    }
+
+    auto&& [value, nonce, data] = wallet->serialize();
+    if (value == 0 && nonce == 1 && data.empty()) {
+        return false;
+    }
+
+    leaf.address = &addr;
+    leaf.bucket = get_bucket(bin_addr);
+    leaf.hash = get_leaf_hash(bin_addr, value, nonce, data);
+    return true;
+}
+
+bool StateTree::verify(const sha256_2& root, const StateProof& proof)
+{
+    auto bin_addr = crypto::hex2bin(proof.address);
+    if (bin_addr.size() != 25) {
+        return false;
+    }
+
+    auto leaf_hash = get_leaf_hash(bin_addr, proof.value, proof.nonce, proof.data);
+    if (std::find(proof.bucket.begin(), proof.bucket.end(), leaf_hash) == proof.bucket.end()) {
+        return false;
+    }
+
+    uint64_t index = STATE_TREE_BUCKETS + get_bucket(bin_addr);
+    auto hash = get_bucket_hash(proof.bucket);
+    for (const auto& sibling : proof.path) {
+        hash = (index & 1) ? get_node_hash(sibling, hash) : get_node_hash(hash, sibling);
+        index >>= 1;
+    }
+
+    return index == 1 && hash == root;
+}
+
+void StateTree::mark_dirty(uint64_t bucket)
+{
+    if (!dirty[bucket]) {
+        dirty[bucket] = true;
+        dirty_buckets.push_back(bucket);
+    }
+}
+
+void StateTree::update(const std::string& addr, meta_wallet::Wallet* wallet)
+{
+    auto bin_addr = crypto::hex2bin(addr);
+    if (bin_addr.size() != 25) {
+        return;
+    }
+
+    uint64_t bucket_index = get_bucket(bin_addr);
+    auto& bucket = buckets[bucket_index];
+    auto it = std::lower_bound(bucket.begin(), bucket.end(), addr, address_less);
+    bool found = it != bucket.end() && *it->address == addr;
+
+    Leaf leaf;
+    if (make_leaf(addr, wallet, leaf)) {
+        if (found) {
+            it->hash = leaf.hash;
+        } else {
+            bucket.insert(it, leaf);
+        }
+    } else if (found) {
+        bucket.erase(it);
+    } else {
+        return;
+    }
+
+    mark_dirty(bucket_index);
+}
+
+void StateTree::rebuild(std::vector<Leaf>& leaves)
+{
+    for (auto& bucket : buckets) {
+        bucket.clear();
+    }
+    for (const auto& leaf : leaves) {
+        buckets[leaf.bucket].push_back(leaf);
+    }
+    for (uint64_t i = 0; i < STATE_TREE_BUCKETS; i++) {
+        std::sort(buckets[i].begin(), buckets[i].end(), [](const Leaf& lh, const Leaf& rh) {
+            return *lh.address < *rh.address;
+        });
+        mark_dirty(i);
+    }
+}
+
+void StateTree::commit()
+{
+    std::vector<uint64_t> level;
+    level.reserve(dirty_buckets.size());
+
+    std::vector<sha256_2> hashes;
+    for (auto bucket : dirty_buckets) {
+        hashes.clear();
+        for (const auto& leaf : buckets[bucket]) {
+            hashes.push_back(leaf.hash);
+        }
+        nodes[STATE_TREE_BUCKETS + bucket] = get_bucket_hash(hashes);
+        dirty[bucket] = false;
+        level.push_back((STATE_TREE_BUCKETS + bucket) >> 1);
+    }
+    dirty_buckets.clear();
+
+    while (!level.empty()) {
+        std::sort(level.begin(), level.end());
+        level.erase(std::unique(level.begin(), level.end()), level.end());
+        for (auto& index : level) {
+            nodes[index] = get_node_hash(nodes[2 * index], nodes[2 * index + 1]);
+            index >>= 1;
+        }
+        if (level.front() == 0) {
+            break;
+        }
+    }
+}
+
+const sha256_2& StateTree::get_root() const
+{
+    return nodes[1];
+}
+
+bool StateTree::get_proof(const std::string& addr, meta_wallet::Wallet* wallet, StateProof& proof) const
+{
+    auto bin_addr = crypto::hex2bin(addr);
+    if (bin_addr.size() != 25) {
+        return false;
+    }
+
+    uint64_t bucket_index = get_bucket(bin_addr);
+    const auto& bucket = buckets[bucket_index];
+    auto it = std::lower_bound(bucket.begin(), bucket.end(), addr, address_less);
+    if (it == bucket.end() || *it->address != addr) {
+        return false;
+    }
+
+    std::tie(proof.value, proof.nonce, proof.data) = wallet->serialize();
+    proof.address = addr;
+
+    proof.bucket.clear();
+    for (const auto& leaf : bucket) {
+        proof.bucket.push_back(leaf.hash);
+    }
+
+    proof.path.clear();
+    for (uint64_t index = STATE_TREE_BUCKETS + bucket_index; index > 1; index >>= 1) {
+        proof.path.push_back(nodes[index ^ 1]);
+    }
+
+    return true;
+}
+
+void BlockChain::update_state_tree(bool full)
+{
+    // вызывается после apply_changes: шаблон блока уже откачен, в wallet_map только применённое состояние
+    const uint64_t wallet_count = wallet_map.size();
+    if (full || temp_touched_wallets.size() > wallet_count / STATE_TREE_REBUILD_DIVISOR) {
+        const uint64_t chunk_count = get_chunk_count(wallet_count, PARALLEL_STATE_CHUNK_MIN);
+        const uint64_t chunk_size = (wallet_count + chunk_count - 1) / chunk_count;
+
+        std::vector<std::vector<StateTree::Leaf>> chunk_leaves(chunk_count);
+        run_chunks(chunk_count, [&](uint64_t chunk) {
+            StateTree::Leaf leaf;
+            for (uint64_t i = chunk * chunk_size; i < wallet_count && i < (chunk + 1) * chunk_size; i++) {
+                auto&& [addr, wallet] = wallet_map.at(i);
+                if (StateTree::make_leaf(addr, wallet, leaf)) {
+                    chunk_leaves[chunk].push_back(leaf);
+                }
+            }
+        });
+
+        std::vector<StateTree::Leaf> leaves;
+        for (auto& chunk : chunk_leaves) {
+            leaves.insert(leaves.end(), chunk.begin(), chunk.end());
+        }
+        state_tree.rebuild(leaves);
+    } else {
+        for (const auto& addr : temp_touched_wallets) {
+            if (auto* wallet = wallet_map.find_wallet(addr)) {
+                state_tree.update(wallet->get_address(), wallet);
+            }
+        }
+    }
+    state_tree.commit();
+}
+
+bool BlockChain::get_state_proof(const std::string& addr, StateProof& proof)
+{
+    auto* wallet = wallet_map.find_wallet(addr);
+    if (!wallet) {
+        return false;
+    }
+
+    // дерево построено по применённому состоянию, а значение берётся из кошелька. Если кошелёк уже изменён
+    // шаблоном, доказательство не сходится с корнем: шаблон откатывается, следующее обновление применит его заново
+    if (state_tree.get_proof(wallet->get_address(), wallet, proof) && StateTree::verify(state_tree.get_root(), proof)) {
+        return true;
+    }
+    if (block_template_applied == 0) {
+        return false;
+    }
+    rollback_block_template();
+    return state_tree.get_proof(wallet->get_address(), wallet, proof);
+}
+
+}
@@ -9,6 +9,10 @@ bool BlockChain::try_apply_block(block::Block* block, bool apply)
     static const sha256_2 zero_hash = { { 0 } };
     bool check_state = true;
 
+    // блок проверяется на состоянии без шаблона. Свой блок приходит при пустом шаблоне: контроллер
+    // не собирает шаблон, пока созданный блок не применён. После чужого блока шаблон применяется заново.
+    rollback_block_template();
+
     if (clear && (block->get_block_type() == BLOCK_TYPE_STATE || block->get_prev_hash() == zero_hash)) {
         check_state = false;
     } else if (block->get_prev_hash() != prev_hash) {
@@ -37,15 +41,23 @@ bool BlockChain::try_apply_block(block::Block* block, bool apply)
 
     if (status && apply) {
         wallet_map.apply_changes();
+        update_node_roles();
+        update_state_tree(!check_state);
+        update_wallet_snapshot(!check_state);
 
         applied_transactions.insert(temp_apply_tx.begin(), temp_apply_tx.end());
         temp_apply_tx.clear();
 
+        // собранный блок либо применён, либо проиграл - его транзакции больше не держим
+        released_transactions.insert(released_transactions.end(), built_transactions.begin(), built_transactions.end());
+        built_transactions.clear();
+
         return true;
     }
 
     wallet_map.clear_changes();
     temp_apply_tx.clear();
+    temp_touched_wallets.clear();
     return status;
 }
 
@@ -0,0 +1,114 @@
+#include <meta_chain.h>
+
+#include <meta_constants.hpp>
+#include <meta_log.hpp>
+
+#include <mutex>
+
+namespace metahash::meta_chain {
+
+WalletSnapshot::Shard& WalletSnapshot::get_shard(const std::string& addr)
+{
+    static const crypto::Hasher hasher;
+    return shards[hasher(addr) % SHARD_COUNT];
+}
+
+bool WalletSnapshot::is_ready()
+{
+    return ready.load();
+}
+
+bool WalletSnapshot::get(const std::string& addr, meta_wallet::WalletState& state)
+{
+    auto& shard = get_shard(addr);
+    std::shared_lock lock(shard.lock);
+    auto it = shard.wallets.find(addr);
+    if (it == shard.wallets.end()) {
+        return false;
+    }
+    state = it->second;
+    return true;
+}
+
+void WalletSnapshot::set(const std::string& addr, const meta_wallet::WalletState& state)
+{
+    auto& shard = get_shard(addr);
+    std::unique_lock lock(shard.lock);
+    shard.wallets[addr] = state;
+}
+
+void WalletSnapshot::clear()
+{
+    ready = false;
+    for (auto& shard : shards) {
+        std::unique_lock lock(shard.lock);
+        shard.wallets.clear();
+    }
+}
+
+void WalletSnapshot::set_ready()
+{
+    ready = true;
+}
+
+void BlockChain::update_wallet_snapshot(bool full)
+{
+    // вызывается после apply_changes: шаблон блока уже откачен, в wallet_map только применённое состояние
+    if (full) {
+        wallet_snapshot.clear();
+        for (auto&& [addr, wallet] : wallet_map) {
+            wallet_snapshot.set(addr, wallet->get_wallet_state());
+        }
+        wallet_snapshot.set_ready();
+    } else {
+        for (const auto& addr : temp_touched_wallets) {
+            if (auto* wallet = wallet_map.find_wallet(addr)) {
+                wallet_snapshot.set(addr, wallet->get_wallet_state());
+            }
+        }
+    }
+    temp_touched_wallets.clear();
+}
+
+uint64_t BlockChain::check_admission(const transaction::TX* tx)
+{
+    if (tx->addr_from == ZERO_WALLET) {
+        return TX_REJECT_ZERO;
+    }
+    if (tx->json_rpc && test_nodes.find(tx->addr_from) != test_nodes.end()) {
+        return 0;
+    }
+
+    if (!wallet_snapshot.is_ready()) {
+        return 0;
+    }
+
+    // кошелька ещё нет в цепочке: нулевой баланс, первый nonce
+    meta_wallet::WalletState state;
+    wallet_snapshot.get(tx->addr_from, state);
+
+    uint64_t min_fee = tx->raw_tx.size() > 254 ? tx->raw_tx.size() - 254 : 0;
+    uint64_t total_sub = 0;
+
+    // порядок проверок и коды как в Wallet::sub
+    if (__builtin_add_overflow(tx->value, min_fee, &total_sub) || state.available < total_sub) {
+        return TX_REJECT_INSUFFICIENT_FUNDS_EXT;
+    }
+    if (state.founder && state.limit_left < total_sub) {
+        return TX_REJECT_FOUNDER_LIMIT;
+    }
+    if (tx->fee < min_fee) {
+        return TX_REJECT_INSUFFICIENT_FEE;
+    }
+    if (state.balance < total_sub) {
+        return TX_REJECT_INSUFFICIENT_FUNDS;
+    }
+    // nonce уже использован - чаще всего это повтор применённой транзакции, в отказы её не пишем
+    if (tx->nonce < state.nonce) {
+        return TX_ADMISSION_DROP;
+    }
+
+    return 0;
+}
+
+}
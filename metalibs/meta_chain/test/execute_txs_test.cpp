@@ -0,0 +1,405 @@
+#include <meta_chain.h>
+#include <meta_constants.hpp>
+#include <meta_test.hpp>
+
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+#include <openssl/x509.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+
+using namespace metahash;
+using test::check;
+
+namespace {
+
+// столько отправителей, чтобы пакеты без общих кошельков были длиннее PARALLEL_TX_BATCH_MIN
+const uint64_t SENDER_COUNT = 192;
+const uint64_t TXS_PER_SENDER = 4;
+const uint64_t POOL_THREADS = 4;
+const uint64_t ROUND_COUNT = 3;
+const uint64_t TEMPLATE_PARTS = 3;
+
+const uint64_t INITIAL_BALANCE = 10000 MHC;
+const uint64_t TX_FEE = 1000;
+const uint64_t GENESIS_TIMESTAMP = 1700000000;
+
+struct Account {
+    std::unique_ptr<crypto::Signer> signer;
+    std::vector<unsigned char> bin_address;
+    uint64_t nonce = 1;
+    int64_t delegated_to = -1;
+};
+
+// у части отправителей денег мало или нет совсем
+uint64_t initial_balance(uint64_t account)
+{
+    return account % 16 == 0 ? 0 : account % 16 == 1 ? 10 : INITIAL_BALANCE;
+}
+
+std::vector<char> make_private_key()
+{
+    EVP_PKEY_CTX* param_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    EVP_PKEY* params = nullptr;
+    EVP_PKEY_paramgen_init(param_ctx);
+    EVP_PKEY_CTX_set_ec_paramgen_curve_nid(param_ctx, NID_secp256k1);
+    EVP_PKEY_paramgen(param_ctx, &params);
+
+    EVP_PKEY_CTX* key_ctx = EVP_PKEY_CTX_new(params, nullptr);
+    EVP_PKEY* pkey = nullptr;
+    EVP_PKEY_keygen_init(key_ctx);
+    EVP_PKEY_keygen(key_ctx, &pkey);
+
+    unsigned char* der = nullptr;
+    int der_size = i2d_PrivateKey(pkey, &der);
+    std::vector<char> private_key(reinterpret_cast<char*>(der), reinterpret_cast<char*>(der) + der_size);
+
+    OPENSSL_free(der);
+    EVP_PKEY_free(pkey);
+    EVP_PKEY_CTX_free(key_ctx);
+    EVP_PKEY_free(params);
+    EVP_PKEY_CTX_free(param_ctx);
+    return private_key;
+}
+
+std::vector<char> make_state_tx(const std::vector<unsigned char>& bin_address, uint64_t value)
+{
+    std::vector<char> tx(bin_address.begin(), bin_address.end());
+    crypto::append_varint(tx, value);
+    crypto::append_varint(tx, 0);
+    crypto::append_varint(tx, 1);
+    crypto::append_varint(tx, 0);
+    crypto::append_varint(tx, 0);
+    crypto::append_varint(tx, 0);
+    crypto::append_varint(tx, TX_STATE_STATE);
+    return tx;
+}
+
+std::vector<char> make_raw_tx(Account& from, const std::vector<unsigned char>& bin_to, uint64_t value, uint64_t nonce, const std::string& data)
+{
+    std::vector<char> raw(bin_to.begin(), bin_to.end());
+    crypto::append_varint(raw, value);
+    crypto::append_varint(raw, TX_FEE);
+    crypto::append_varint(raw, nonce);
+    crypto::append_varint(raw, data.size());
+    raw.insert(raw.end(), data.begin(), data.end());
+
+    auto sign = from.signer->sign(raw);
+    auto& pub_key = from.signer->get_pub_key();
+    crypto::append_varint(raw, sign.size());
+    raw.insert(raw.end(), sign.begin(), sign.end());
+    crypto::append_varint(raw, pub_key.size());
+    raw.insert(raw.end(), pub_key.begin(), pub_key.end());
+    return raw;
+}
+
+std::string delegate_data(const std::string& method, uint64_t value)
+{
+    return "{\"method\":\"" + method + "\",\"params\":{\"value\":\"" + std::to_string(value) + "\"}}";
+}
+
+// переводы новым и существующим кошелькам, неверные nonce, нехватка средств, делегирование;
+// во втором раунде часть транзакций идёт прямо на STATE_FEE_WALLET
+std::vector<std::vector<char>> make_round_txs(std::vector<Account>& accounts, uint64_t round, std::mt19937_64& rng)
+{
+    static const auto fee_wallet = crypto::hex2bin(STATE_FEE_WALLET);
+
+    std::vector<std::vector<char>> txs;
+    for (uint64_t k = 0; k < TXS_PER_SENDER; k++) {
+        for (uint64_t s = 0; s < accounts.size(); s++) {
+            auto& from = accounts[s];
+            uint64_t nonce = from.nonce++;
+            uint64_t value = rng() % (INITIAL_BALANCE / 64);
+            std::vector<unsigned char> bin_to(25);
+            std::string data;
+
+            uint64_t kind = rng() % 100;
+            if (kind < 4) {
+                nonce += 3;
+                from.nonce--;
+            } else if (kind < 8) {
+                nonce = 0;
+                from.nonce--;
+            } else if (kind < 12) {
+                value = INITIAL_BALANCE * 2;
+            }
+
+            // get_txs упорядочивает транзакции с одинаковым nonce не так, как шаблон, поэтому
+            // кошельки без денег не получают переводов и их транзакции отвергаются при любом порядке
+            uint64_t to = rng() % accounts.size();
+            while (initial_balance(to) != INITIAL_BALANCE) {
+                to = (to + 1) % accounts.size();
+            }
+            uint64_t target = rng() % 100;
+            if (round == 0 && target < 10 && from.delegated_to < 0 && to != s) {
+                bool valid = rng() % 3;
+                data = delegate_data("delegate", valid ? 600 MHC : 10 MHC);
+                bin_to = accounts[to].bin_address;
+                value = 0;
+                if (valid) {
+                    from.delegated_to = to;
+                }
+            } else if (round == 1 && target < 10) {
+                bin_to = fee_wallet;
+            } else if (round == 2 && target < 10 && from.delegated_to >= 0) {
+                data = delegate_data("undelegate", 0);
+                bin_to = accounts[from.delegated_to].bin_address;
+                value = 0;
+                from.delegated_to = -1;
+            } else if (target < 40) {
+                bin_to = accounts[to].bin_address;
+            } else {
+                for (uint64_t i = 1; i < bin_to.size(); i++) {
+                    bin_to[i] = rng();
+                }
+            }
+            if (data.empty()) {
+                // транзакции длиннее 255 байт платят комиссию за размер
+                data.assign(rng() % 96, 'x');
+            }
+
+            txs.push_back(make_raw_tx(from, bin_to, value, nonce, data));
+        }
+    }
+    return txs;
+}
+
+// кадры транзакций блока в порядке записи: get_txs сортирует их по nonce
+std::vector<transaction::TX> block_frames(const std::vector<char>& data)
+{
+    std::vector<std::string_view> frames;
+    crypto::ByteReader reader(std::string_view(data.data(), data.size()), 80);
+    reader.read_frames(frames);
+
+    std::vector<transaction::TX> txs(frames.size());
+    for (uint64_t i = 0; i < frames.size(); i++) {
+        txs[i].parse(frames[i], false);
+    }
+    return txs;
+}
+
+// тот же набор транзакций блока с заменой состояния в позиции index
+block::Block* rebuild_block(const std::vector<transaction::TX>& txs, uint64_t timestamp, const sha256_2& prev_hash, uint64_t index, uint64_t state)
+{
+    block::BlockBuilder builder(BLOCK_TYPE_COMMON, timestamp, prev_hash);
+    for (uint64_t i = 0; i < txs.size(); i++) {
+        std::vector<char> raw(txs[i].raw_tx.begin(), txs[i].raw_tx.begin() + txs[i].tx_size);
+        builder.add_tx(raw, i == index ? state : txs[i].state);
+    }
+    return builder.make();
+}
+
+std::vector<char> state_of(meta_chain::BlockChain& chain, uint64_t timestamp)
+{
+    auto* block = chain.make_state_block(timestamp);
+    auto data = block->get_data();
+    delete block;
+    return data;
+}
+
+// получатель тратит перевод, пришедший раньше, но с большим nonce: проверяющие выполнили бы трату первой,
+// поэтому шаблон откладывает её в следующий блок
+void check_template_order()
+{
+    std::vector<Account> accounts(3);
+    for (auto& account : accounts) {
+        account.signer = std::make_unique<crypto::Signer>(make_private_key());
+        account.bin_address = crypto::hex2bin(account.signer->get_mh_addr());
+    }
+    auto& rich = accounts[0];
+    auto& empty = accounts[1];
+    auto& target = accounts[2];
+
+    pool::CpuPool producer_pool(1);
+    pool::CpuPool verifier_pool(1);
+    meta_chain::BlockChain producer(producer_pool, UINT64_MAX);
+    meta_chain::BlockChain verifier(verifier_pool);
+
+    sha256_2 prev_hash = { { 0 } };
+    uint64_t timestamp = GENESIS_TIMESTAMP;
+    {
+        block::BlockBuilder builder(BLOCK_TYPE_STATE, timestamp, prev_hash);
+        builder.add_tx(make_state_tx(rich.bin_address, INITIAL_BALANCE));
+        builder.add_tx(make_state_tx(target.bin_address, INITIAL_BALANCE));
+        auto* genesis = builder.make();
+        check(producer.apply_block(genesis), "producer rejected genesis of the order check");
+        check(verifier.apply_block(genesis), "verifier rejected genesis of the order check");
+        prev_hash = genesis->get_block_hash();
+        delete genesis;
+    }
+
+    std::vector<transaction::TX*> txs;
+    auto&& add_tx = [&txs](Account& from, Account& to, uint64_t value) {
+        auto raw = make_raw_tx(from, to.bin_address, value, from.nonce++, "");
+        auto* tx = new transaction::TX;
+        check(tx->parse(std::string_view(raw.data(), raw.size())), "order check tx does not parse");
+        txs.push_back(tx);
+    };
+    for (uint64_t i = 0; i < 3; i++) {
+        add_tx(rich, target, 1 MHC);
+    }
+    add_tx(rich, empty, 10 MHC);
+    add_tx(empty, target, 1 MHC);
+
+    producer.add_to_block_template(txs);
+    producer.update_block_template();
+
+    // транзакция комиссии и четыре перевода, затем отложенная трата
+    const uint64_t expected_frames[] = { 5, 2 };
+    for (uint64_t i = 0; i < 2; i++) {
+        const std::string at = " in order check block " + std::to_string(i);
+        timestamp++;
+        auto* block = producer.make_common_block(timestamp);
+        check(block != nullptr, "no block" + at);
+        if (!block) {
+            return;
+        }
+        check(block_frames(block->get_data()).size() == expected_frames[i], "wrong transaction count" + at);
+        check(verifier.apply_block(block), "verifier rejected the block" + at);
+        check(producer.apply_block(block), "producer rejected its block" + at);
+        delete block;
+    }
+}
+
+}
+
+int main()
+{
+    std::mt19937_64 rng(1);
+
+    std::vector<Account> accounts(SENDER_COUNT);
+    for (auto& account : accounts) {
+        account.signer = std::make_unique<crypto::Signer>(make_private_key());
+        account.bin_address = crypto::hex2bin(account.signer->get_mh_addr());
+    }
+
+    // сборщик блока, проверка одним отрезком в вызывающем потоке и проверка пакетами в пуле
+    pool::CpuPool producer_pool(1);
+    pool::CpuPool serial_pool(1);
+    pool::CpuPool parallel_pool(POOL_THREADS);
+    meta_chain::BlockChain producer(producer_pool, UINT64_MAX);
+    meta_chain::BlockChain serial(serial_pool, UINT64_MAX);
+    meta_chain::BlockChain parallel(parallel_pool);
+
+    sha256_2 prev_hash = { { 0 } };
+    uint64_t timestamp = GENESIS_TIMESTAMP;
+
+    {
+        block::BlockBuilder builder(BLOCK_TYPE_STATE, timestamp, prev_hash);
+        for (uint64_t i = 0; i < accounts.size(); i++) {
+            builder.add_tx(make_state_tx(accounts[i].bin_address, initial_balance(i)));
+        }
+        auto* genesis = builder.make();
+        check(producer.apply_block(genesis), "producer rejected genesis");
+        check(serial.apply_block(genesis), "serial chain rejected genesis");
+        check(parallel.apply_block(genesis), "parallel chain rejected genesis");
+        prev_hash = genesis->get_block_hash();
+        delete genesis;
+    }
+
+    for (uint64_t round = 0; round < ROUND_COUNT; round++) {
+        const std::string at = " in round " + std::to_string(round);
+        timestamp++;
+
+        auto raw_txs = make_round_txs(accounts, round, rng);
+        std::vector<transaction::TX*> txs;
+        for (const auto& raw : raw_txs) {
+            auto* tx = new transaction::TX;
+            check(tx->parse(std::string_view(raw.data(), raw.size())), "tx does not parse" + at);
+            txs.push_back(tx);
+        }
+        // шаблон получает транзакции вперемешку и частями: с пропусками nonce и конфликтами порядка
+        std::shuffle(txs.begin(), txs.end(), rng);
+        for (uint64_t part = 0; part < TEMPLATE_PARTS; part++) {
+            std::vector<transaction::TX*> chunk(txs.begin() + txs.size() * part / TEMPLATE_PARTS, txs.begin() + txs.size() * (part + 1) / TEMPLATE_PARTS);
+            producer.add_to_block_template(chunk);
+            producer.update_block_template();
+        }
+
+        auto* block = producer.make_common_block(timestamp);
+        auto* common = dynamic_cast<block::CommonBlock*>(block);
+        check(common != nullptr, "no common block" + at);
+        if (!common) {
+            break;
+        }
+
+        auto rejected = producer.make_rejected_tx_block(timestamp);
+        check(rejected && !rejected->empty(), "no rejected transactions" + at);
+        if (rejected) {
+            for (auto* info : *rejected) {
+                delete info;
+            }
+            delete rejected;
+        }
+
+        auto block_txs = block_frames(block->get_data());
+        uint64_t wrong_data = block_txs.size();
+        for (uint64_t i = 0; i < block_txs.size(); i++) {
+            if (block_txs[i].state == TX_STATE_WRONG_DATA) {
+                wrong_data = i;
+                break;
+            }
+        }
+
+        // пересобранный без изменений блок совпадает байт в байт
+        auto* same = rebuild_block(block_txs, timestamp, prev_hash, block_txs.size(), 0);
+        check(same->get_data() == block->get_data(), "rebuilt block differs" + at);
+        delete same;
+
+        // транзакции, которые сборщик отверг, и неверный метод с отметкой ACCEPT
+        {
+            block::BlockBuilder builder(BLOCK_TYPE_COMMON, timestamp, prev_hash);
+            for (const auto& raw : raw_txs) {
+                builder.add_tx(raw, TX_STATE_ACCEPT);
+            }
+            auto* all_txs = builder.make();
+            check(!serial.can_apply_block(all_txs), "serial chain accepted rejected transactions" + at);
+            check(!parallel.can_apply_block(all_txs), "parallel chain accepted rejected transactions" + at);
+            delete all_txs;
+        }
+        if (wrong_data < block_txs.size()) {
+            auto* forged = rebuild_block(block_txs, timestamp, prev_hash, wrong_data, TX_STATE_ACCEPT);
+            check(!serial.can_apply_block(forged), "serial chain accepted a failed method" + at);
+            check(!parallel.can_apply_block(forged), "parallel chain accepted a failed method" + at);
+            delete forged;
+        }
+
+        check(producer.apply_block(block), "producer rejected its block" + at);
+        check(serial.apply_block(block), "serial chain rejected the block" + at);
+        check(parallel.apply_block(block), "parallel chain rejected the block" + at);
+        prev_hash = block->get_block_hash();
+        delete block;
+
+        // корень публикуется после каждого блока
+        check(serial.get_last_state_root()->block_hash == prev_hash, "state root not published" + at);
+        check(serial.get_last_state_root()->root == parallel.get_last_state_root()->root, "state root differs" + at);
+
+        // состояние после блока: все кошельки с балансом, nonce и делегированием
+        timestamp++;
+        auto serial_state = state_of(serial, timestamp);
+        auto parallel_state = state_of(parallel, timestamp);
+        check(serial_state == parallel_state, "wallet state differs" + at);
+
+        auto* state_block = block::parse_block(std::string_view(serial_state.data(), serial_state.size()));
+        check(producer.apply_block(state_block), "producer state differs" + at);
+        check(serial.apply_block(state_block), "serial chain rejected its state block" + at);
+        check(parallel.apply_block(state_block), "parallel chain rejected the state block" + at);
+        prev_hash = state_block->get_block_hash();
+
+        // дерево, обновлявшееся по блокам, совпадает с собранным целиком при загрузке блока состояния
+        {
+            meta_chain::BlockChain loaded(serial_pool);
+            check(loaded.apply_block(state_block), "fresh chain rejected the state block" + at);
+            check(loaded.get_last_state_root()->root == serial.get_last_state_root()->root, "incremental state root differs from rebuild" + at);
+        }
+        delete state_block;
+    }
+
+    check_template_order();
+
+    return test::result();
+}
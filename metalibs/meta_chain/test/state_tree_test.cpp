@@ -0,0 +1,164 @@
+#include <meta_chain.h>
+#include <meta_constants.hpp>
+#include <meta_test.hpp>
+
+#include <iostream>
+#include <random>
+
+using namespace metahash;
+using test::check;
+
+namespace {
+
+// больше, чем корзин, чтобы в части корзин оказалось по нескольку листьев
+const uint64_t WALLET_COUNT = 3 * STATE_TREE_BUCKETS;
+
+std::string make_address(std::mt19937_64& rng)
+{
+    std::vector<unsigned char> bin_address(25, 0);
+    for (uint64_t i = 1; i < bin_address.size(); i++) {
+        bin_address[i] = static_cast<unsigned char>(rng());
+    }
+    return "0x" + crypto::bin2hex(bin_address);
+}
+
+sha256_2 build_root(meta_wallet::WalletMap& wallet_map)
+{
+    std::vector<meta_chain::StateTree::Leaf> leaves;
+    meta_chain::StateTree::Leaf leaf;
+    for (auto&& [addr, wallet] : wallet_map) {
+        if (meta_chain::StateTree::make_leaf(addr, wallet, leaf)) {
+            leaves.push_back(leaf);
+        }
+    }
+
+    meta_chain::StateTree tree;
+    tree.rebuild(leaves);
+    tree.commit();
+    return tree.get_root();
+}
+
+bool proves(const meta_chain::StateTree& tree, meta_wallet::Wallet* wallet)
+{
+    meta_chain::StateProof proof;
+    return tree.get_proof(wallet->get_address(), wallet, proof) && meta_chain::StateTree::verify(tree.get_root(), proof);
+}
+
+}
+
+int main()
+{
+    std::mt19937_64 rng(42);
+
+    meta_wallet::WalletMap wallet_map;
+    std::vector<meta_wallet::Wallet*> wallets;
+    for (uint64_t i = 0; i < WALLET_COUNT; i++) {
+        auto* wallet = wallet_map.get_wallet(make_address(rng));
+        // каждый восьмой кошелёк остаётся в состоянии по умолчанию и в дерево не попадает
+        if (i % 8) {
+            wallet->initialize(1 + rng() % (1000 MHC), 1 + rng() % 100, "");
+        }
+        wallets.push_back(wallet);
+    }
+    wallet_map.apply_changes();
+
+    std::vector<meta_chain::StateTree::Leaf> leaves;
+    meta_chain::StateTree::Leaf leaf;
+    for (auto* wallet : wallets) {
+        if (meta_chain::StateTree::make_leaf(wallet->get_address(), wallet, leaf)) {
+            leaves.push_back(leaf);
+        }
+    }
+
+    meta_chain::StateTree tree;
+    tree.rebuild(leaves);
+    tree.commit();
+    const sha256_2 initial_root = tree.get_root();
+
+    // дерево, собранное поштучными update, совпадает с пересобранным целиком
+    {
+        meta_chain::StateTree incremental;
+        for (auto* wallet : wallets) {
+            incremental.update(wallet->get_address(), wallet);
+        }
+        incremental.commit();
+        check(incremental.get_root() == initial_root, "incremental root differs from rebuild");
+    }
+
+    for (uint64_t i = 0; i < wallets.size(); i++) {
+        meta_chain::StateProof proof;
+        bool present = tree.get_proof(wallets[i]->get_address(), wallets[i], proof);
+        if (i % 8) {
+            check(present, "no proof for present wallet " + std::to_string(i));
+            check(meta_chain::StateTree::verify(initial_root, proof), "present wallet proof rejected " + std::to_string(i));
+        } else {
+            check(!present, "proof for default wallet " + std::to_string(i));
+        }
+    }
+
+    // подделанные доказательства
+    {
+        meta_chain::StateProof proof;
+        check(tree.get_proof(wallets[1]->get_address(), wallets[1], proof), "no proof for wallet 1");
+
+        auto forged = proof;
+        forged.value++;
+        check(!meta_chain::StateTree::verify(initial_root, forged), "forged value accepted");
+
+        forged = proof;
+        forged.nonce++;
+        check(!meta_chain::StateTree::verify(initial_root, forged), "forged nonce accepted");
+
+        forged = proof;
+        forged.path[forged.path.size() / 2][0] ^= 1;
+        check(!meta_chain::StateTree::verify(initial_root, forged), "forged path accepted");
+
+        forged = proof;
+        forged.path.pop_back();
+        check(!meta_chain::StateTree::verify(initial_root, forged), "short path accepted");
+
+        forged = proof;
+        forged.address = wallets[2]->get_address();
+        check(!meta_chain::StateTree::verify(initial_root, forged), "proof for another address accepted");
+    }
+
+    // изменения: часть кошельков обновляется, часть возвращается в состояние по умолчанию, часть появляется
+    std::vector<meta_chain::StateProof> old_proofs(wallets.size());
+    for (uint64_t i = 0; i < wallets.size(); i++) {
+        if (i % 8 == 1 || i % 8 == 2) {
+            tree.get_proof(wallets[i]->get_address(), wallets[i], old_proofs[i]);
+        }
+    }
+
+    for (uint64_t i = 0; i < wallets.size(); i++) {
+        auto* wallet = wallets[i];
+        if (i % 16 == 0) {
+            wallet->initialize(5 MHC, 1, "");
+        } else if (i % 8 == 1) {
+            wallet->add(1);
+        } else if (i % 8 == 2) {
+            wallet->initialize(0, 1, "");
+        } else {
+            continue;
+        }
+        tree.update(wallet->get_address(), wallet);
+    }
+    wallet_map.apply_changes();
+    tree.commit();
+
+    const sha256_2 updated_root = tree.get_root();
+    check(updated_root != initial_root, "root did not change");
+    check(updated_root == build_root(wallet_map), "updated root differs from rebuild");
+
+    for (uint64_t i = 0; i < wallets.size(); i++) {
+        bool expected = i % 8 == 2 ? false : i % 8 == 0 ? i % 16 == 0 : true;
+        check(proves(tree, wallets[i]) == expected, "wrong proof after update for wallet " + std::to_string(i));
+
+        if (i % 8 == 1 || i % 8 == 2) {
+            check(meta_chain::StateTree::verify(initial_root, old_proofs[i]), "old proof rejected by old root " + std::to_string(i));
+            check(!meta_chain::StateTree::verify(updated_root, old_proofs[i]), "stale proof accepted " + std::to_string(i));
+        }
+    }
+
+    return test::result();
+}
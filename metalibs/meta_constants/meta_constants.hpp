@@ -22,6 +22,12 @@ const uint64_t BLOCK_TYPE_TECH_APPROVE = 0x1100111167452301;
 const uint64_t BLOCK_TYPE_TECH_STATS = 0x2200111167452301;
 const uint64_t BLOCK_TYPE_TECH_BAD_TX = 0x3300111167452301;
 
+// с этого времени заголовок блока хранит корень дерева Меркла хешей транзакций вместо хеша буфера.
+// Это переключение в заданный день (2027-01-01 UTC): релиз с ним должен стоять на всех ядрах заранее,
+// не обновлённый узел после этой даты перестаёт принимать блоки сети. Перенос - только новым релизом до даты.
+// Сигнала в цепочке (версии блока, флага в блоке состояния) пока нет, дата объявлена в RELEASE_NOTES.md.
+const uint64_t TX_MERKLE_ROOT_TIMESTAMP = 1798761600;
+
 // SPECIAL WALLETS
 const std::string MASTER_WALLET_COIN_FORGING = "0x666174686572206f662077616c6c65747320666f7267696e67";
 const std::string MASTER_WALLET_NODE_FORGING = "0x666174686572206f662073657276657220666f7267696e6720";
@@ -46,6 +52,8 @@ const std::string TEAM_WALLET = "0x00e3aafe3399cdb92a6780cc8d2e4b38c4429ffc41c8c
 // DELEGATION LIMITS
 const uint64_t LIMIT_DELEGATE_TO = 256;
 const uint64_t LIMIT_DELEGATE_FROM = 4096;
+const uint64_t DELEGATE_LIST_COMPACT_MIN = 64; // удалённых записей до перестроения списка
+const uint64_t ACTIVE_WALLETS_PRUNE_MIN = 4096; // прирост реестра активных кошельков до его чистки
 
 const uint64_t MINIMUM_COIN_FORGING_W = 100 MHC;
 const uint64_t MINIMUM_COIN_FORGING_C = 512 MHC;
@@ -93,6 +101,38 @@ const uint64_t COMISSION_DATA_81_99 = 2000 MHC;
 
 const uint64_t MAX_TRANSACTION_COUNT = 50 * 1024;
 
+// MEMPOOL LIMITS
+const uint64_t MEMPOOL_MAX_TX_COUNT = 16 * MAX_TRANSACTION_COUNT;
+const uint64_t MEMPOOL_MAX_BYTES = 256 * 1024 * 1024;
+
+// INGEST LIMITS: байты из сети, ещё не дошедшие до mempool или списка блоков; пакет сверх лимита отбрасывается
+const uint64_t INGEST_MAX_TX_BYTES = 64 * 1024 * 1024;
+const uint64_t INGEST_MAX_BLOCK_BYTES = 128 * 1024 * 1024;
+
+// PARALLEL TX EXECUTION
+const uint64_t PARALLEL_TX_BATCH_MIN = 64;
+const uint64_t PARALLEL_TX_CHUNK_MIN = 32;
+const uint64_t PARALLEL_STATE_CHUNK_MIN = 4096; // кошельков на поток при сборке и проверке блока состояния
+const uint64_t APPROVE_VERIFY_CHUNK_MIN = 8; // подписей апрувов на поток
+const uint64_t TX_PARSE_CHUNK_MIN = 16; // транзакций блока за один захват отрезка
+const uint64_t BLOCK_PARSE_CHUNK_MIN = 4; // блоков при чтении локальной цепочки
+
+// STATE TREE
+const uint64_t STATE_TREE_BUCKETS = 4096; // степень двойки
+const uint64_t STATE_TREE_REBUILD_DIVISOR = 4; // больше 1/4 изменённых кошельков - дешевле пересобрать дерево целиком
+const uint64_t STATE_PROOF_WAIT_MS = 2000; // дольше запрос доказательства не держит поток сети
+
+// SIGN VERIFICATION
+const uint8_t SIGN_GENERATOR_WINDOW_BITS = 8;
+const uint8_t SIGN_KEY_WINDOW_BITS = 4; // 60 КБ таблицы на ключ
+const uint64_t SIGN_KEY_TABLE_MIN_USES = 16; // проверок подписи ключом до построения его таблицы
+const uint64_t SIGN_KEY_TABLE_MAX = 256;
+const uint64_t SIGN_KEY_COUNTER_LIMIT = 4096; // ключей без таблиц на шард счётчика
+
+// APPROVE TRACKER
+const uint64_t APPROVE_ARCHIVE_BLOCKS = 256; // записанных блоков, апрувы которых ещё держим в памяти
+const uint64_t BLOCKS_INDEX_INITIAL_SIZE = 1 << 16; // корзин индекса блоков, степень двойки
+
 // TX STATE
 const uint64_t TX_STATE_APPROVE = 1;
 const uint64_t TX_STATE_FEE = 2;
@@ -117,10 +157,14 @@ const uint64_t TX_REJECT_INVALID_NONCE = 0xff04;
 const uint64_t TX_REJECT_INSUFFICIENT_FUNDS_EXT = 0xff05;
 const uint64_t TX_REJECT_FOUNDER_LIMIT = 0xff06;
 const uint64_t TX_REJECT_INVALID_WALLET = 0x0404;
+// не причина отказа: транзакция отбрасывается без записи в RejectedTXBlock
+const uint64_t TX_ADMISSION_DROP = 0xffff;
 
 const uint64_t DAY_IN_SECONDS = 24 * 60 * 60;
 const uint64_t CORE_LIST_RENEW_PERIOD = 10 * 60;
 const uint64_t CORE_LIST_SILENCE_PERIOD = 30;
+const uint64_t CORE_SYNC_PERIOD = 60;
+const uint64_t CHAIN_ACTUALIZATION_PERIOD = 5;
 
 /*                          RPC METHODS                           */
 const uint64_t RPC_TX = 0x20;
@@ -130,6 +174,8 @@ const uint64_t RPC_DISAPPROVE = 0x41;
 const uint64_t RPC_GET_APPROVE = 0x42;
 const uint64_t RPC_APPROVE_LIST = 0x43;
 const uint64_t RPC_LAST_BLOCK = 0x50;
+const uint64_t RPC_GET_STATE_ROOT = 0x51;
+const uint64_t RPC_GET_STATE_PROOF = 0x52;
 const uint64_t RPC_GET_BLOCK = 0x60;
 const uint64_t RPC_GET_CHAIN = 0x61;
 const uint64_t RPC_GET_MISSING_BLOCK_LIST = 0x62;
@@ -153,6 +199,19 @@ static const std::set<std::string> ROLES {
     META_ROLE_CORE
 };
 
+const uint64_t META_ROLE_FLAG_PROXY = 0b00001;
+const uint64_t META_ROLE_FLAG_I_TORR = 0b00010;
+const uint64_t META_ROLE_FLAG_TORR = 0b00100;
+const uint64_t META_ROLE_FLAG_VERIF = 0b01000;
+const uint64_t META_ROLE_FLAG_CORE = 0b10000;
+static const std::map<std::string, uint64_t> META_ROLE_FLAG {
+    { META_ROLE_PROXY, META_ROLE_FLAG_PROXY },
+    { META_ROLE_I_TORR, META_ROLE_FLAG_I_TORR },
+    { META_ROLE_TORR, META_ROLE_FLAG_TORR },
+    { META_ROLE_VERIF, META_ROLE_FLAG_VERIF },
+    { META_ROLE_CORE, META_ROLE_FLAG_CORE }
+};
+
 const uint64_t MINIMUM_AVERAGE_PROXY_RPS = 1000;
 const uint64_t MINIMUM_PROXY_RPS = 0;
 
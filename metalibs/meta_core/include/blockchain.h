@@ -18,6 +18,7 @@ private:
 public:
     BlockChainController(
         boost::asio::io_context& io_context,
+        metahash::pool::CpuPool& cpu_pool,
         const std::string& priv_key_line,
         const std::string& path,
         const std::string& proved_hash,
@@ -3,12 +3,13 @@
 
 BlockChainController::BlockChainController(
     boost::asio::io_context& io_context,
+    metahash::pool::CpuPool& cpu_pool,
     const std::string& priv_key_line,
     const std::string& path,
     const std::string& proved_hash,
     const std::map<std::string, std::pair<std::string, int>>& core_list,
     const std::pair<std::string, int>& host_port)
-    : CI(new metahash::meta_core::ControllerImplementation(io_context, priv_key_line, path, proved_hash, core_list, host_port))
+    : CI(new metahash::meta_core::ControllerImplementation(io_context, cpu_pool, priv_key_line, path, proved_hash, core_list, host_port))
 {
 }
 
@@ -26,19 +26,17 @@ void ControllerImplementation::disapprove_block(block::Block* p_block)
 
 void ControllerImplementation::apply_approve(transaction::ApproveRecord* p_ar)
 {
-    sha256_2 block_hash;
-    std::copy(p_ar->block_hash.begin(), p_ar->block_hash.end(), block_hash.begin());
+    if (known_approves.is_finalized(p_ar->get_block_hash())) {
+        known_approves.forget({ p_ar });
+        delete p_ar;
+        return;
+    }
 
     std::string addr = "0x" + crypto::bin2hex(crypto::get_address(p_ar->pub_key));
+    known_approves.insert(p_ar);
 
-    if (p_ar->approve) {
-        if (!block_approve[block_hash].insert({ addr, p_ar }).second) {
-            delete p_ar;
-        }
-    } else {
-        if (!block_disapprove[block_hash].insert({ addr, p_ar }).second) {
-            delete p_ar;
-        }
+    if (!approves.insert(addr, p_ar)) {
+        delete p_ar;
     }
 }
 
@@ -46,14 +44,7 @@ bool ControllerImplementation::count_approve_for_block(block::Block* block)
 {
     auto block_hash = block->get_block_hash();
 
-    uint64_t approve_size = 0;
-    for (auto&& [addr, _] : block_approve[block_hash]) {
-        if (std::find(current_cores.begin(), current_cores.end(), addr) != std::end(current_cores)) {
-            approve_size++;
-        }
-    }
-
-    if (approve_size >= min_approve || approve_size == current_cores.size() || block->is_local()) {
+    if (approves.has_quorum(block_hash) || block->is_local()) {
         return try_apply_block(block);
     }
 
@@ -63,39 +54,52 @@ bool ControllerImplementation::count_approve_for_block(block::Block* block)
 
 bool ControllerImplementation::try_apply_block(block::Block* block, bool write)
 {
-    if (BC.apply_block(block)) {
-        {
-            prev_timestamp = block->get_block_timestamp();
-            last_applied_block = block->get_block_hash();
-            last_created_block = block->get_block_hash();
+    return run_on_chain([this, block] {
+        return BC.apply_block(block);
+    }, [this, block, write](bool applied) {
+        if (applied) {
+            on_block_applied(block, write);
+        }
+        return applied;
+    });
+}
+
+void ControllerImplementation::on_block_applied(block::Block* block, bool write)
+{
+    {
+        prev_timestamp = block->get_block_timestamp();
+        last_applied_block = block->get_block_hash();
+        last_created_block = block->get_block_hash();
 
-            prev_day = prev_timestamp / DAY_IN_SECONDS;
-            prev_state = block->get_block_type();
+        prev_day = prev_timestamp / DAY_IN_SECONDS;
+        prev_state = block->get_block_type();
 
-            core_last_block[signer.get_mh_addr()] = prev_timestamp;
-        }
+        core_last_block[signer.get_mh_addr()] = prev_timestamp;
+        block_applied = true;
+    }
 
-        if (write) {
-            write_block(block);
+    if (write) {
+        write_block(block);
+        approves.persist(block->get_block_hash(), known_approves);
 
-            if (block->get_block_type() == BLOCK_TYPE_STATE) {
-                std::unordered_set<std::string, crypto::Hasher> allowed_addresses;
-                for (auto&& [addr, roles] : BC.get_node_state()) {
-                    if (roles.count(META_ROLE_CORE) || roles.count(META_ROLE_VERIF)) {
+        if (block->get_block_type() == BLOCK_TYPE_STATE) {
+            std::unordered_set<std::string, crypto::Hasher> allowed_addresses;
+            {
+                const auto nodes = BC.get_node_state();
+                for (auto&& [addr, roles] : *nodes) {
+                    if (roles & (META_ROLE_FLAG_CORE | META_ROLE_FLAG_VERIF)) {
                         allowed_addresses.insert(addr);
                     }
                 }
+            }
 
-                allowed_addresses.erase(signer.get_mh_addr());
+            allowed_addresses.erase(signer.get_mh_addr());
 
-                listener.update_allowed_addreses(allowed_addresses);
-            }
+            listener.update_allowed_addreses(allowed_addresses);
         }
 
-        return true;
+        check_state_root();
     }
-
-    return false;
 }
 
 void ControllerImplementation::distribute(block::Block* block)
@@ -127,18 +131,23 @@ bool ControllerImplementation::master()
 bool ControllerImplementation::check_block_for_appliance_and_break_on_corrupt_block(block::Block*& block)
 {
     sha256_2 hash = block->get_block_hash();
-    if (!block_approve[hash].count(signer.get_mh_addr()) && !block_disapprove[hash].count(signer.get_mh_addr())) {
-        if (BC.can_apply_block(block)) {
-            approve_block(block);
+    if (!approves.contains(hash, signer.get_mh_addr())) {
+        auto* p_block = block;
+        return run_on_chain([this, p_block] {
+            return BC.can_apply_block(p_block);
+        }, [this, p_block, hash](bool valid) {
+            if (valid) {
+                approve_block(p_block);
 
-            return count_approve_for_block(block);
-        } else {
-            disapprove_block(block);
+                return count_approve_for_block(p_block);
+            } else {
+                disapprove_block(p_block);
 
-            blocks.erase(hash);
+                blocks.erase(hash);
 
-            return true;
-        }
+                return true;
+            }
+        });
     } else {
         return count_approve_for_block(block);
     }
@@ -1,35 +1,76 @@
 #ifndef CONTROLLER_HPP
 #define CONTROLLER_HPP
 
+#include <deque>
+#include <functional>
 #include <set>
 #include <shared_mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <meta_block.h>
 #include <meta_chain.h>
 #include <meta_connections.hpp>
+#include <meta_constants.hpp>
 #include <meta_crypto.h>
 #include <meta_pool.hpp>
 #include <meta_server.h>
 #include <meta_transaction.h>
 
+#include "controller_blocks.hpp"
+
 namespace metahash::meta_core {
 
 struct ControllerImplementation {
 private:
     meta_chain::BlockChain BC;
     boost::asio::io_context& io_context;
+    pool::CpuPool& cpu_pool;
+    // стадии: приём - потоки сети, проверка подписей - cpu_pool, консенсус - serial_execution,
+    // проверка, применение и сборка блоков - chain_execution, запись на диск - persist_execution.
+    // У цепочки и записи свои потоки: задания по несколько секунд не занимают потоки сети
     boost::asio::io_context::strand serial_execution;
-    boost::asio::deadline_timer main_loop_timer;
-
-    std::vector<transaction::TX*> transactions;
+    boost::asio::io_context chain_execution;
+    boost::asio::io_context persist_execution;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> chain_work;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> persist_work;
+    std::vector<std::thread> stage_threads;
+    boost::asio::deadline_timer block_timer;
+    boost::asio::deadline_timer sync_timer;
+    boost::asio::deadline_timer actualization_timer;
+    std::atomic<bool> wake_pending = false;
+    std::atomic<bool> template_pending = false;
+    std::atomic<bool> template_build = false;
+    bool pipeline_started = false;
+    bool chain_busy = false;
+    bool block_applied = false;
+
+    transaction::Mempool mempool;
 
     std::map<sha256_2, std::set<std::string>> missing_blocks;
 
-    std::unordered_map<sha256_2, std::map<std::string, transaction::ApproveRecord*>, crypto::Hasher> block_approve;
-    std::unordered_map<sha256_2, std::map<std::string, transaction::ApproveRecord*>, crypto::Hasher> block_disapprove;
+    // Байты, занятые пакетом от приёма до выхода из очереди. Один пакет пропускается всегда,
+    // иначе блок больше лимита не принять никогда
+    struct IngestBudget {
+        std::atomic<uint64_t> pending = 0;
+        std::atomic<uint64_t> dropped = 0;
+        const uint64_t limit;
+
+        explicit IngestBudget(uint64_t limit);
+
+        bool reserve(uint64_t size);
+        void add(uint64_t size);
+        void release(uint64_t size);
+    };
+
+    IngestBudget tx_ingest { INGEST_MAX_TX_BYTES };
+    IngestBudget block_ingest { INGEST_MAX_BLOCK_BYTES };
+
+    // ответы ядер с другим корнем после того же блока
+    std::atomic<uint64_t> state_root_mismatches = 0;
 
     moodycamel::ConcurrentQueue<transaction::TX*> tx_queue;
+    moodycamel::ConcurrentQueue<transaction::RejectedTXInfo*> rejected_tx_queue;
     moodycamel::ConcurrentQueue<transaction::ApproveRecord*> approve_queue;
     moodycamel::ConcurrentQueue<block::Block*> block_queue;
     moodycamel::ConcurrentQueue<std::pair<std::string, sha256_2>> approve_request_queue;
@@ -53,9 +94,6 @@ private:
     crypto::Signer signer;
 
     connection::MetaConnection cores;
-    uint64_t last_sync_timestamp = 0;
-
-    uint64_t last_actualization_timestamp = 0;
     uint64_t last_actualization_check_timestamp = 0;
     uint64_t actualization_iteration = 0;
     int not_actualized[2];
@@ -80,6 +118,8 @@ private:
         std::atomic<uint64_t> dbg_RPC_GET_APPROVE = 0;
         std::atomic<uint64_t> dbg_RPC_APPROVE_LIST = 0;
         std::atomic<uint64_t> dbg_RPC_LAST_BLOCK = 0;
+        std::atomic<uint64_t> dbg_RPC_GET_STATE_ROOT = 0;
+        std::atomic<uint64_t> dbg_RPC_GET_STATE_PROOF = 0;
         std::atomic<uint64_t> dbg_RPC_GET_BLOCK = 0;
         std::atomic<uint64_t> dbg_RPC_GET_CHAIN = 0;
         std::atomic<uint64_t> dbg_RPC_GET_MISSING_BLOCK_LIST = 0;
@@ -96,35 +136,87 @@ private:
     std::unordered_map<std::string, Statistics, crypto::Hasher> income_nodes_stat;
     uint64_t dbg_timestamp = 0;
 
-    struct Blocks {
-        std::shared_mutex blocks_lock;
-        std::unordered_map<sha256_2, block::Block*, crypto::Hasher> blocks;
-        std::unordered_map<sha256_2, block::Block*, crypto::Hasher> previous;
+    Blocks blocks;
+
+    struct KnownApproves {
+        std::shared_mutex known_lock;
+        std::unordered_set<std::string, crypto::Hasher> known;
+
+        std::unordered_set<sha256_2, crypto::Hasher> finalized;
+        std::deque<std::pair<uint64_t, sha256_2>> finalized_order;
+
+        static std::string get_key(const transaction::ApproveRecord*);
+        bool contains(const std::string&);
+        bool is_finalized(const sha256_2&);
+        void insert(const transaction::ApproveRecord*);
+        void forget(const std::vector<transaction::ApproveRecord*>&);
+        void finalize(const sha256_2&, uint64_t height, const std::vector<transaction::ApproveRecord*>&);
+
+    } known_approves;
+
+    struct ApproveTracker {
+        using ApproveList = std::map<std::string, transaction::ApproveRecord*>;
+
+        struct Entry {
+            ApproveList approve;
+            ApproveList disapprove;
+            std::vector<uint64_t> core_bits;
+            uint64_t core_approves = 0;
+            uint64_t generation = 0;
+            uint64_t height = 0;
+            bool quorum = false;
+            bool persisted = false;
+        };
+
+        std::unordered_map<sha256_2, Entry, crypto::Hasher> entries;
+        std::deque<sha256_2> archive;
+        std::deque<std::pair<uint64_t, sha256_2>> unpersisted;
+        uint64_t height = 0;
+
+        std::unordered_map<std::string, uint64_t, crypto::Hasher> core_index;
+        uint64_t generation = 0;
+        uint64_t min_approve = 0;
+        std::function<void(const sha256_2&)> on_quorum;
+
+        ~ApproveTracker();
+
+        void set_cores(const std::vector<std::string>&);
+        bool insert(const std::string& addr, transaction::ApproveRecord*);
+        bool contains(const sha256_2&, const std::string& addr);
+        bool has_quorum(const sha256_2&);
+        const ApproveList& get_approves(const sha256_2&);
+        void persist(const sha256_2&, KnownApproves&);
 
-        bool contains(const sha256_2&);
-        bool contains_next(const sha256_2&);
-        void insert(block::Block*);
-        block::Block* operator[](const sha256_2&);
-        block::Block* get_next(const sha256_2&);
-        void erase(const sha256_2&);
+    private:
+        void refresh(const sha256_2&, Entry&);
+        std::vector<transaction::ApproveRecord*> take_records(const sha256_2&);
 
-    } blocks;
+    } approves;
 
 public:
     ControllerImplementation(
         boost::asio::io_context& io_context,
+        pool::CpuPool& cpu_pool,
         const std::string& priv_key_line,
         const std::string& _path,
         const std::string& proved_hash,
         const std::map<std::string, std::pair<std::string, int>>& core_list,
         const std::pair<std::string, int>& host_port);
+    ~ControllerImplementation();
 
     std::atomic<std::map<std::string, std::pair<uint, uint>>*>& get_wallet_statistics();
     std::atomic<std::deque<std::pair<std::string, uint64_t>>*>& get_wallet_request_addresses();
 
 private:
+    void wake();
     void main_loop();
+    void block_loop();
+    void sync_loop();
+    void actualization_loop();
     void process_queues();
+    bool run_on_chain(std::function<bool()> work, std::function<bool(bool)> done);
+    void request_template_update(bool build);
+    void update_block_template();
     bool check_if_can_make_block(const uint64_t& timestamp);
     bool check_awaited_blocks();
 
@@ -137,7 +229,11 @@ private:
     void parse_RPC_DISAPPROVE(std::string_view);
     void parse_RPC_APPROVE_LIST(std::string_view);
     void parse_RPC_GET_APPROVE(const std::string& core, std::string_view);
+    void ingest_txs(std::string_view);
+    void ingest_approves(std::vector<transaction::ApproveRecord*>& records);
     std::vector<char> parse_RPC_LAST_BLOCK(std::string_view);
+    std::vector<char> parse_RPC_GET_STATE_ROOT(std::string_view);
+    std::vector<char> parse_RPC_GET_STATE_PROOF(std::string_view);
     std::vector<char> parse_RPC_GET_BLOCK(std::string_view);
     std::vector<char> parse_RPC_GET_MISSING_BLOCK_LIST(std::string_view);
     std::vector<char> parse_RPC_GET_CORE_LIST(std::string_view);
@@ -149,6 +245,7 @@ private:
     void apply_approve(transaction::ApproveRecord*);
     bool count_approve_for_block(block::Block*);
     bool try_apply_block(block::Block*, bool write = true);
+    void on_block_applied(block::Block*, bool write);
     void distribute(block::Block*);
     void distribute(transaction::ApproveRecord*);
     bool master();
@@ -157,11 +254,13 @@ private:
     void write_block(block::Block*);
 
     bool try_make_block(uint64_t timestamp);
+    void make_rejected_tx_block(uint64_t timestamp, std::vector<transaction::RejectedTXInfo*>* tx_list);
 
     void read_and_apply_local_chain();
     void check_blocks();
 
     void check_if_chain_actual();
+    void check_state_root();
     void actualize_chain();
 
     void get_approve_for_block(sha256_2& block_hash);
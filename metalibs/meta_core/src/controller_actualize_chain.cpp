@@ -64,6 +64,30 @@ void ControllerImplementation::check_if_chain_actual()
     });
 }
 
+void ControllerImplementation::check_state_root()
+{
+    // ядра, ещё не применившие этот блок или ушедшие дальше, отвечают корнем другого блока - их пропускаем
+    meta_chain::StateRoot own;
+    {
+        auto reader = BC.get_last_state_root();
+        own = *reader;
+    }
+
+    cores.send_with_callback(RPC_GET_STATE_ROOT, std::vector<char>(), [this, own](const std::string& mh_addr, const std::vector<char>& resp) {
+        if (resp.size() >= 64) {
+            sha256_2 block_hash;
+            sha256_2 root;
+            std::copy_n(resp.begin(), 32, block_hash.begin());
+            std::copy_n(resp.begin() + 32, 32, root.begin());
+
+            if (block_hash == own.block_hash && root != own.root) {
+                state_root_mismatches++;
+                DEBUG_COUT("state root mismatch\t" + mh_addr + "\t" + crypto::bin2hex(root) + "\t" + crypto::bin2hex(own.root));
+            }
+        }
+    });
+}
+
 void ControllerImplementation::actualize_chain()
 {
     std::random_device rd;
@@ -53,21 +53,21 @@ std::vector<char> ControllerImplementation::add_pack_to_queue(network::Request&
 
     switch (url) {
     case RPC_TX:
-        if (roles.count(META_ROLE_VERIF)) {
+        if (roles & META_ROLE_FLAG_VERIF) {
             stat.dbg_RPC_TX++;
             parse_RPC_TX(pack);
             return empty_resp;
         }
         break;
     case RPC_APPROVE:
-        if (roles.count(META_ROLE_CORE)) {
+        if (roles & META_ROLE_FLAG_CORE) {
             stat.dbg_RPC_APPROVE++;
             parse_RPC_APPROVE(pack);
             return empty_resp;
         }
         break;
     case RPC_DISAPPROVE:
-        if (roles.count(META_ROLE_CORE)) {
+        if (roles & META_ROLE_FLAG_CORE) {
             stat.dbg_RPC_DISAPPROVE++;
             parse_RPC_DISAPPROVE(pack);
             return empty_resp;
@@ -87,6 +87,14 @@ std::vector<char> ControllerImplementation::add_pack_to_queue(network::Request&
         stat.dbg_RPC_LAST_BLOCK++;
         return parse_RPC_LAST_BLOCK(pack);
         break;
+    case RPC_GET_STATE_ROOT:
+        stat.dbg_RPC_GET_STATE_ROOT++;
+        return parse_RPC_GET_STATE_ROOT(pack);
+        break;
+    case RPC_GET_STATE_PROOF:
+        stat.dbg_RPC_GET_STATE_PROOF++;
+        return parse_RPC_GET_STATE_PROOF(pack);
+        break;
     case RPC_GET_BLOCK:
         stat.dbg_RPC_GET_BLOCK++;
         return parse_RPC_GET_BLOCK(pack);
@@ -99,21 +107,21 @@ std::vector<char> ControllerImplementation::add_pack_to_queue(network::Request&
         stat.dbg_RPC_GET_CORE_LIST++;
         return parse_RPC_GET_CORE_LIST(pack);
     case RPC_CORE_LIST_APPROVE:
-        if (roles.count(META_ROLE_CORE)) {
+        if (roles & META_ROLE_FLAG_CORE) {
             stat.dbg_RPC_CORE_LIST_APPROVE++;
             parse_RPC_CORE_LIST_APPROVE(request.sender_mh_addr, pack);
             return empty_resp;
         }
         break;
     case RPC_CORE_LIST_ONLINE:
-        if (roles.count(META_ROLE_CORE)) {
+        if (roles & META_ROLE_FLAG_CORE) {
             stat.dbg_RPC_CORE_LIST_ONLINE++;
             parse_RPC_CORE_LIST_ONLINE(request.sender_mh_addr, pack);
             return empty_resp;
         }
         break;
     case RPC_PRETEND_BLOCK:
-        if (roles.count(META_ROLE_CORE)) {
+        if (roles & META_ROLE_FLAG_CORE) {
             stat.dbg_RPC_PRETEND_BLOCK++;
             parse_RPC_PRETEND_BLOCK(pack);
             return empty_resp;
@@ -132,7 +140,7 @@ void ControllerImplementation::log_network_statistics(uint64_t timestamp)
     /// DEBUG INFO BEGIN
     if (timestamp > dbg_timestamp + 60) {
         std::string log_msg = "\n";
-        log_msg += "0x00112233445566778899aabbccddeeffgghhffjjiikkllmmnn\tTX\tGetCL\tApprove\tDisAprv\tGetAprv\tAprvLst\tLastBlo\tGetBlok\tGetChai\tGetBLst\tCoreLst\tOnline\tPretend\tNone\tRoles\tIP";
+        log_msg += "0x00112233445566778899aabbccddeeffgghhffjjiikkllmmnn\tTX\tGetCL\tApprove\tDisAprv\tGetAprv\tAprvLst\tLastBlo\tStRoot\tStProof\tGetBlok\tGetChai\tGetBLst\tCoreLst\tOnline\tPretend\tNone\tRoles\tIP";
         log_msg += "\n";
 
         {
@@ -144,8 +152,10 @@ void ControllerImplementation::log_network_statistics(uint64_t timestamp)
                 std::string role_list;
                 {
                     auto roles = BC.check_addr(addr);
-                    for (const auto& role : roles) {
-                        role_list += role + "\t";
+                    for (auto&& [role, flag] : META_ROLE_FLAG) {
+                        if (roles & flag) {
+                            role_list += role + "\t";
+                        }
                     }
                 }
 
@@ -164,6 +174,8 @@ void ControllerImplementation::log_network_statistics(uint64_t timestamp)
                     + stat.dbg_RPC_GET_APPROVE
                     + stat.dbg_RPC_APPROVE_LIST
                     + stat.dbg_RPC_LAST_BLOCK
+                    + stat.dbg_RPC_GET_STATE_ROOT
+                    + stat.dbg_RPC_GET_STATE_PROOF
                     + stat.dbg_RPC_GET_BLOCK
                     + stat.dbg_RPC_GET_CHAIN
                     + stat.dbg_RPC_GET_MISSING_BLOCK_LIST
@@ -184,6 +196,8 @@ void ControllerImplementation::log_network_statistics(uint64_t timestamp)
                     + std::to_string(stat.dbg_RPC_GET_APPROVE) + "\t"
                     + std::to_string(stat.dbg_RPC_APPROVE_LIST) + "\t"
                     + std::to_string(stat.dbg_RPC_LAST_BLOCK) + "\t"
+                    + std::to_string(stat.dbg_RPC_GET_STATE_ROOT) + "\t"
+                    + std::to_string(stat.dbg_RPC_GET_STATE_PROOF) + "\t"
                     + std::to_string(stat.dbg_RPC_GET_BLOCK) + "\t"
                     + std::to_string(stat.dbg_RPC_GET_CHAIN) + "\t"
                     + std::to_string(stat.dbg_RPC_GET_MISSING_BLOCK_LIST) + "\t"
@@ -202,6 +216,8 @@ void ControllerImplementation::log_network_statistics(uint64_t timestamp)
                 stat.dbg_RPC_GET_APPROVE = 0;
                 stat.dbg_RPC_APPROVE_LIST = 0;
                 stat.dbg_RPC_LAST_BLOCK = 0;
+                stat.dbg_RPC_GET_STATE_ROOT = 0;
+                stat.dbg_RPC_GET_STATE_PROOF = 0;
                 stat.dbg_RPC_GET_BLOCK = 0;
                 stat.dbg_RPC_GET_CHAIN = 0;
                 stat.dbg_RPC_GET_MISSING_BLOCK_LIST = 0;
@@ -217,6 +233,10 @@ void ControllerImplementation::log_network_statistics(uint64_t timestamp)
             }
         }
 
+        log_msg += "ingest dropped\tTX\t" + std::to_string(tx_ingest.dropped.exchange(0))
+            + "\tBlocks\t" + std::to_string(block_ingest.dropped.exchange(0)) + "\n";
+        log_msg += "state root mismatches\t" + std::to_string(state_root_mismatches.exchange(0)) + "\n";
+
         dbg_timestamp = timestamp;
 
         DEBUG_COUT(log_msg);
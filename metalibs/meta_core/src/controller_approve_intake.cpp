@@ -0,0 +1,120 @@
+#include "controller.hpp"
+#include <meta_constants.hpp>
+#include <meta_log.hpp>
+
+namespace metahash::meta_core {
+
+std::string ControllerImplementation::KnownApproves::get_key(const transaction::ApproveRecord* p_ar)
+{
+    std::string key;
+    key.reserve(1 + p_ar->block_hash.size() + p_ar->pub_key.size());
+    key.push_back(p_ar->approve ? 1 : 0);
+    key.append(p_ar->block_hash);
+    key.append(p_ar->pub_key);
+    return key;
+}
+
+bool ControllerImplementation::KnownApproves::contains(const std::string& key)
+{
+    sha256_2 block_hash;
+    std::copy_n(key.begin() + 1, block_hash.size(), block_hash.begin());
+
+    std::shared_lock lock(known_lock);
+    return known.count(key) || finalized.count(block_hash);
+}
+
+bool ControllerImplementation::KnownApproves::is_finalized(const sha256_2& block_hash)
+{
+    std::shared_lock lock(known_lock);
+    return finalized.count(block_hash);
+}
+
+void ControllerImplementation::KnownApproves::insert(const transaction::ApproveRecord* p_ar)
+{
+    auto key = get_key(p_ar);
+
+    std::unique_lock lock(known_lock);
+    known.insert(std::move(key));
+}
+
+void ControllerImplementation::KnownApproves::forget(const std::vector<transaction::ApproveRecord*>& records)
+{
+    std::vector<std::string> keys;
+    for (auto* p_ar : records) {
+        keys.push_back(get_key(p_ar));
+    }
+
+    std::unique_lock lock(known_lock);
+    for (const auto& key : keys) {
+        known.erase(key);
+    }
+}
+
+void ControllerImplementation::KnownApproves::finalize(const sha256_2& block_hash, uint64_t height, const std::vector<transaction::ApproveRecord*>& records)
+{
+    std::vector<std::string> keys;
+    for (auto* p_ar : records) {
+        keys.push_back(get_key(p_ar));
+    }
+
+    // от блока остаётся только хеш, записи апрувов по нему больше не нужны
+    std::unique_lock lock(known_lock);
+    for (const auto& key : keys) {
+        known.erase(key);
+    }
+    finalized.insert(block_hash);
+    finalized_order.push_back({ height, block_hash });
+
+    // хеши держим ещё APPROVE_ARCHIVE_BLOCKS записанных блоков, более поздние апрувы уйдут в очистку незаписанных
+    while (finalized_order.front().first + APPROVE_ARCHIVE_BLOCKS < height) {
+        finalized.erase(finalized_order.front().second);
+        finalized_order.pop_front();
+    }
+}
+
+void ControllerImplementation::ingest_approves(std::vector<transaction::ApproveRecord*>& records)
+{
+    // повторы отсекаются до проверки подписи
+    std::vector<transaction::ApproveRecord*> pending;
+    {
+        std::unordered_set<std::string, crypto::Hasher> batch_keys;
+        for (auto* p_ar : records) {
+            auto key = KnownApproves::get_key(p_ar);
+            if (known_approves.contains(key) || !batch_keys.insert(std::move(key)).second) {
+                delete p_ar;
+            } else {
+                pending.push_back(p_ar);
+            }
+        }
+        records.clear();
+    }
+
+    if (pending.empty()) {
+        return;
+    }
+
+    // подписи проверяются в cpu_pool, поток сети не ждёт
+    cpu_pool.post([this, pending] {
+        std::vector<char> valid(pending.size(), false);
+        pool::parallel_for(cpu_pool, pending.size(), APPROVE_VERIFY_CHUNK_MIN, [&pending, &valid](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++) {
+                auto* p_ar = pending[i];
+                valid[i] = crypto::check_sign(p_ar->block_hash, p_ar->sign, p_ar->pub_key);
+            }
+        });
+
+        for (uint64_t i = 0; i < pending.size(); i++) {
+            if (valid[i]) {
+                known_approves.insert(pending[i]);
+                approve_queue.enqueue(pending[i]);
+            } else {
+                DEBUG_COUT("invalid sign");
+                delete pending[i];
+            }
+        }
+
+        wake();
+    });
+}
+
+}
@@ -0,0 +1,175 @@
+#include "controller.hpp"
+#include <meta_constants.hpp>
+
+namespace metahash::meta_core {
+
+ControllerImplementation::ApproveTracker::~ApproveTracker()
+{
+    for (auto&& [_, entry] : entries) {
+        for (auto&& [_, p_ar] : entry.approve) {
+            delete p_ar;
+        }
+        for (auto&& [_, p_ar] : entry.disapprove) {
+            delete p_ar;
+        }
+    }
+}
+
+void ControllerImplementation::ApproveTracker::set_cores(const std::vector<std::string>& cores)
+{
+    core_index.clear();
+    for (const auto& addr : cores) {
+        core_index.insert({ addr, core_index.size() });
+    }
+
+    // битовые маски блоков пересчитываются при следующем обращении
+    generation++;
+}
+
+void ControllerImplementation::ApproveTracker::refresh(const sha256_2& block_hash, Entry& entry)
+{
+    if (entry.generation != generation) {
+        entry.core_bits.assign((core_index.size() + 63) / 64, 0);
+        entry.core_approves = 0;
+        for (auto&& [addr, _] : entry.approve) {
+            auto index_it = core_index.find(addr);
+            if (index_it != core_index.end()) {
+                entry.core_bits[index_it->second / 64] |= uint64_t(1) << (index_it->second % 64);
+                entry.core_approves++;
+            }
+        }
+        entry.generation = generation;
+        // при новом составе ядер кворум набирается заново
+        entry.quorum = false;
+    }
+
+    if (!entry.quorum && (entry.core_approves >= min_approve || entry.core_approves == core_index.size())) {
+        entry.quorum = true;
+        if (on_quorum) {
+            on_quorum(block_hash);
+        }
+    }
+}
+
+bool ControllerImplementation::ApproveTracker::insert(const std::string& addr, transaction::ApproveRecord* p_ar)
+{
+    auto block_hash = p_ar->get_block_hash();
+    auto [entry_it, created] = entries.try_emplace(block_hash);
+    auto& entry = entry_it->second;
+    if (created) {
+        entry.height = height;
+        unpersisted.push_back({ height, block_hash });
+    }
+
+    if (!p_ar->approve) {
+        return entry.disapprove.insert({ addr, p_ar }).second;
+    }
+
+    if (!entry.approve.insert({ addr, p_ar }).second) {
+        return false;
+    }
+
+    if (entry.generation == generation) {
+        auto index_it = core_index.find(addr);
+        if (index_it != core_index.end()) {
+            entry.core_bits[index_it->second / 64] |= uint64_t(1) << (index_it->second % 64);
+            entry.core_approves++;
+        }
+    }
+    refresh(block_hash, entry);
+
+    return true;
+}
+
+bool ControllerImplementation::ApproveTracker::contains(const sha256_2& block_hash, const std::string& addr)
+{
+    auto entry_it = entries.find(block_hash);
+    if (entry_it == entries.end()) {
+        return false;
+    }
+
+    return entry_it->second.approve.count(addr) || entry_it->second.disapprove.count(addr);
+}
+
+bool ControllerImplementation::ApproveTracker::has_quorum(const sha256_2& block_hash)
+{
+    auto entry_it = entries.find(block_hash);
+    if (entry_it == entries.end()) {
+        return min_approve == 0 || core_index.empty();
+    }
+
+    refresh(block_hash, entry_it->second);
+    return entry_it->second.quorum;
+}
+
+const ControllerImplementation::ApproveTracker::ApproveList& ControllerImplementation::ApproveTracker::get_approves(const sha256_2& block_hash)
+{
+    static const ApproveList empty_list;
+
+    auto entry_it = entries.find(block_hash);
+    if (entry_it == entries.end()) {
+        return empty_list;
+    }
+
+    return entry_it->second.approve;
+}
+
+std::vector<transaction::ApproveRecord*> ControllerImplementation::ApproveTracker::take_records(const sha256_2& block_hash)
+{
+    std::vector<transaction::ApproveRecord*> records;
+    auto entry_it = entries.find(block_hash);
+    if (entry_it != entries.end()) {
+        for (auto&& [_, p_ar] : entry_it->second.approve) {
+            records.push_back(p_ar);
+        }
+        for (auto&& [_, p_ar] : entry_it->second.disapprove) {
+            records.push_back(p_ar);
+        }
+        entries.erase(entry_it);
+    }
+    return records;
+}
+
+void ControllerImplementation::ApproveTracker::persist(const sha256_2& block_hash, KnownApproves& known)
+{
+    height++;
+    archive.push_back(block_hash);
+
+    auto entry_it = entries.find(block_hash);
+    if (entry_it != entries.end()) {
+        entry_it->second.persisted = true;
+    }
+
+    // апрувы последних записанных блоков держим для ответов на RPC_GET_APPROVE
+    while (archive.size() > APPROVE_ARCHIVE_BLOCKS) {
+        auto dropped_hash = archive.front();
+        archive.pop_front();
+
+        auto records = take_records(dropped_hash);
+        known.finalize(dropped_hash, height, records);
+
+        for (auto* p_ar : records) {
+            delete p_ar;
+        }
+    }
+
+    // блоки, которые так и не записались за APPROVE_ARCHIVE_BLOCKS записанных, остались в другой ветке
+    while (!unpersisted.empty() && unpersisted.front().first + APPROVE_ARCHIVE_BLOCKS < height) {
+        auto [created_height, dropped_hash] = unpersisted.front();
+        unpersisted.pop_front();
+
+        entry_it = entries.find(dropped_hash);
+        if (entry_it == entries.end() || entry_it->second.persisted || entry_it->second.height != created_height) {
+            continue;
+        }
+
+        auto records = take_records(dropped_hash);
+        known.forget(records);
+
+        for (auto* p_ar : records) {
+            delete p_ar;
+        }
+    }
+}
+
+}
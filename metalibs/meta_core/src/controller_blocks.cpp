@@ -1,81 +1,191 @@
-#include "controller.hpp"
+#include "controller_blocks.hpp"
+#include <meta_constants.hpp>
 
 namespace metahash::meta_core {
 
-bool ControllerImplementation::Blocks::contains(const sha256_2& hash)
+Blocks::Table::Table(uint64_t size)
+    : mask(size - 1)
+    , buckets(new std::atomic<const Link*>[size])
+{
+    for (uint64_t i = 0; i < size; i++) {
+        buckets[i].store(nullptr);
+    }
+}
+
+Blocks::Table::~Table()
+{
+    for (uint64_t i = 0; i <= mask; i++) {
+        const Link* link = buckets[i].load();
+        while (link) {
+            const Link* next = link->next;
+            delete link;
+            link = next;
+        }
+    }
+}
+
+std::atomic<const Blocks::Link*>& Blocks::Table::bucket(const sha256_2& key) const
+{
+    return buckets[crypto::Hasher()(key) & mask];
+}
+
+block::Block* Blocks::Table::find(const sha256_2& key) const
+{
+    for (const Link* link = bucket(key).load(std::memory_order_acquire); link; link = link->next) {
+        if (link->key == key) {
+            return link->block;
+        }
+    }
+
+    return nullptr;
+}
+
+void Blocks::Table::insert(const sha256_2& key, block::Block* block)
+{
+    auto& head = bucket(key);
+    head.store(new Link { key, block, head.load() }, std::memory_order_release);
+}
+
+Blocks::Reader::Reader(Blocks& blocks)
+    : guard(blocks.epoch)
+    , by_hash(blocks.by_hash.load())
+    , by_prev(blocks.by_prev.load())
+{
+}
+
+block::Block* Blocks::Reader::get(const sha256_2& hash) const
+{
+    return by_hash->find(hash);
+}
+
+block::Block* Blocks::Reader::get_next(const sha256_2& hash) const
+{
+    return by_prev->find(hash);
+}
+
+Blocks::Blocks()
+    : by_hash(new Table(BLOCKS_INDEX_INITIAL_SIZE))
+    , by_prev(new Table(BLOCKS_INDEX_INITIAL_SIZE))
 {
-    std::shared_lock lock(blocks_lock);
-    return blocks.count(hash);
 }
 
-bool ControllerImplementation::Blocks::contains_next(const sha256_2& hash)
+Blocks::~Blocks()
 {
-    std::shared_lock lock(blocks_lock);
-    return previous.count(hash);
+    delete by_hash.load();
+    delete by_prev.load();
 }
 
-void ControllerImplementation::Blocks::insert(block::Block* block)
+Blocks::Reader Blocks::read()
+{
+    return Reader(*this);
+}
+
+bool Blocks::contains(const sha256_2& hash)
+{
+    return read().get(hash) != nullptr;
+}
+
+bool Blocks::contains_next(const sha256_2& hash)
+{
+    return read().get_next(hash) != nullptr;
+}
+
+void Blocks::insert(block::Block* block)
 {
     sha256_2 hash = block->get_block_hash();
     sha256_2 prev = block->get_prev_hash();
 
-    std::unique_lock lock(blocks_lock);
-    if (blocks.count(hash) || previous.count(prev)) {
+    std::lock_guard lock(write_lock);
+    if (by_hash.load()->find(hash) || by_prev.load()->find(prev)) {
+        // блок не публиковался, читателей у него нет
         delete block;
         return;
     }
 
-    blocks.insert({ hash, block });
-    previous.insert({ prev, block });
+    if (count > by_hash.load()->mask) {
+        grow();
+    }
+
+    by_hash.load()->insert(hash, block);
+    by_prev.load()->insert(prev, block);
+    count++;
+
+    epoch.reclaim();
 }
 
-block::Block* ControllerImplementation::Blocks::operator[](const sha256_2& hash)
+block::Block* Blocks::operator[](const sha256_2& hash)
 {
-    std::shared_lock lock(blocks_lock);
-    auto block_it = blocks.find(hash);
+    return read().get(hash);
+}
+
+block::Block* Blocks::get_next(const sha256_2& hash)
+{
+    return read().get_next(hash);
+}
 
-    if (block_it != blocks.end()) {
-        return block_it->second;
+void Blocks::erase(const sha256_2& hash)
+{
+    std::lock_guard lock(write_lock);
+
+    auto* block = by_hash.load()->find(hash);
+
+    if (!block) {
+        return;
     }
 
-    return nullptr;
+    unlink(by_prev.load(), block->get_prev_hash(), block);
+    unlink(by_hash.load(), hash, block);
+    count--;
+
+    epoch.retire([block] { delete block; });
 }
 
-block::Block* ControllerImplementation::Blocks::get_next(const sha256_2& hash)
+void Blocks::grow()
 {
-    std::shared_lock lock(blocks_lock);
-    auto prev_it = previous.find(hash);
+    // новая таблица собирается из копий звеньев, старую дочитывают те, кто уже начал
+    for (auto* table : { &by_hash, &by_prev }) {
+        auto* old_table = table->load();
+        auto* new_table = new Table((old_table->mask + 1) * 2);
+
+        for (uint64_t i = 0; i <= old_table->mask; i++) {
+            for (const Link* link = old_table->buckets[i].load(); link; link = link->next) {
+                new_table->insert(link->key, link->block);
+            }
+        }
 
-    if (prev_it != previous.end()) {
-        return prev_it->second;
+        table->store(new_table);
+        epoch.retire([old_table] { delete old_table; });
     }
-
-    return nullptr;
 }
 
-void ControllerImplementation::Blocks::erase(const sha256_2& hash)
+void Blocks::unlink(Table* table, const sha256_2& key, const block::Block* block)
 {
-    std::unique_lock lock(blocks_lock);
+    auto& head = table->bucket(key);
 
-    auto block_it = blocks.find(hash);
+    std::vector<const Link*> removed;
+    const Link* link = head.load();
+    while (link && !(link->key == key && link->block == block)) {
+        removed.push_back(link);
+        link = link->next;
+    }
 
-    if (block_it == blocks.end()) {
+    if (!link) {
         return;
     }
 
-    auto* block = block_it->second;
-
-    auto range = previous.equal_range(block_it->second->get_prev_hash());
-
-    for (auto prev_it = range.first; prev_it != range.second; ++prev_it) {
-        if (prev_it->second == block) {
-            previous.erase(prev_it);
-            break;
-        }
+    // звенья неизменяемы: начало цепочки до удаляемого звена копируется заново
+    const Link* rest = link->next;
+    for (auto it = removed.rbegin(); it != removed.rend(); ++it) {
+        rest = new Link { (*it)->key, (*it)->block, rest };
     }
+    head.store(rest, std::memory_order_release);
 
-    blocks.erase(block_it);
-    delete block;
+    removed.push_back(link);
+    epoch.retire([removed] {
+        for (const Link* link : removed) {
+            delete link;
+        }
+    });
 }
 
-}
\ No newline at end of file
+}
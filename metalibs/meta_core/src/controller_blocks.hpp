@@ -0,0 +1,75 @@
+#ifndef CONTROLLER_BLOCKS_HPP
+#define CONTROLLER_BLOCKS_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include <meta_block.h>
+#include <meta_crypto.h>
+#include <meta_pool.hpp>
+
+namespace metahash::meta_core {
+
+// Индекс блоков по хешу и по хешу предыдущего блока.
+// Читатели (в том числе сетевые потоки) не берут блокировок: цепочки корзин неизменяемы,
+// писатель публикует новые звенья атомарно, а снятые звенья, таблицы и блоки
+// удаляет через EpochDomain, когда их уже никто не читает.
+struct Blocks {
+    struct Link {
+        sha256_2 key;
+        block::Block* block;
+        const Link* next;
+    };
+
+    struct Table {
+        const uint64_t mask;
+        std::unique_ptr<std::atomic<const Link*>[]> buckets;
+
+        explicit Table(uint64_t size);
+        ~Table();
+
+        std::atomic<const Link*>& bucket(const sha256_2&) const;
+        block::Block* find(const sha256_2&) const;
+        void insert(const sha256_2&, block::Block*);
+    };
+
+    // держит эпоху: полученные через него блоки не будут удалены, пока он жив
+    class Reader {
+    private:
+        pool::EpochDomain::Guard guard;
+        const Table* by_hash;
+        const Table* by_prev;
+
+    public:
+        explicit Reader(Blocks&);
+
+        block::Block* get(const sha256_2&) const;
+        block::Block* get_next(const sha256_2&) const;
+    };
+
+    pool::EpochDomain epoch;
+    std::mutex write_lock;
+    std::atomic<Table*> by_hash;
+    std::atomic<Table*> by_prev;
+    uint64_t count = 0;
+
+    Blocks();
+    ~Blocks();
+
+    Reader read();
+    bool contains(const sha256_2&);
+    bool contains_next(const sha256_2&);
+    void insert(block::Block*);
+    // указатели без Reader безопасны только в потоке контроллера, который один вызывает erase
+    block::Block* operator[](const sha256_2&);
+    block::Block* get_next(const sha256_2&);
+    void erase(const sha256_2&);
+
+    void grow();
+    void unlink(Table*, const sha256_2&, const block::Block*);
+};
+
+}
+
+#endif // CONTROLLER_BLOCKS_HPP
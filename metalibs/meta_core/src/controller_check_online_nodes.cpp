@@ -23,8 +23,8 @@ bool ControllerImplementation::check_online_nodes(uint64_t timestamp)
         {
             const auto nodes = BC.get_node_state();
             uint64_t registered_core_nodes_count = 0;
-            for (auto&& [addr, roles] : nodes) {
-                if (roles.count(META_ROLE_CORE)) {
+            for (auto&& [addr, roles] : *nodes) {
+                if (roles & META_ROLE_FLAG_CORE) {
                     registered_core_nodes_count++;
                 }
             }
@@ -58,6 +58,7 @@ bool ControllerImplementation::check_online_nodes(uint64_t timestamp)
 
                 current_cores = primary_cores;
                 core_list_generation = current_generation;
+                approves.set_cores(current_cores);
 
                 for (const auto& addr : current_cores) {
                     DEBUG_COUT(addr);
@@ -104,9 +105,9 @@ void ControllerImplementation::make_online_core_list(uint64_t current_generation
     std::vector<char> core_list;
     std::string core_list_msg;
     bool first = true;
-    for (auto&& [addr, roles] : nodes) {
+    for (auto&& [addr, roles] : *nodes) {
         if (online_cores.count(addr)
-            && roles.count(META_ROLE_CORE)
+            && (roles & META_ROLE_FLAG_CORE)
             && abs(long(prev_timestamp) - long(core_last_block[addr])) < 3600) {
 
             if (first) {
@@ -4,44 +4,111 @@
 
 namespace metahash::meta_core {
 
-void ControllerImplementation::main_loop()
+namespace {
+
+    uint64_t get_timestamp()
+    {
+        return static_cast<uint64_t>(std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now()).time_since_epoch().count());
+    }
+
+    boost::posix_time::milliseconds get_time_to_next_second()
+    {
+        auto ms = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now()).time_since_epoch().count();
+        return boost::posix_time::milliseconds(1000 - ms % 1000);
+    }
+
+}
+
+void ControllerImplementation::wake()
 {
-    uint64_t timestamp = static_cast<uint64_t>(std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now()).time_since_epoch().count());
-    bool no_sleep = false;
+    if (!wake_pending.exchange(true)) {
+        serial_execution.post(std::bind(&ControllerImplementation::main_loop, this));
+    }
+}
 
-    log_network_statistics(timestamp);
+void ControllerImplementation::main_loop()
+{
+    wake_pending = false;
 
     process_queues();
 
-    if (timestamp - last_sync_timestamp > 60) {
-        io_context.post(std::bind(&connection::MetaConnection::sync_core_lists, &cores));
-        last_sync_timestamp = timestamp;
+    bool no_sleep = check_awaited_blocks();
+    if (no_sleep || block_applied) {
+        block_applied = false;
+
+        // следующий блок собираем сразу после применения предыдущего, не дожидаясь таймера
+        uint64_t timestamp = get_timestamp();
+        if (check_if_can_make_block(timestamp)) {
+            try_make_block(timestamp);
+        }
     }
 
-    if (timestamp > last_actualization_check_timestamp || prev_timestamp > last_actualization_check_timestamp) {
-        last_actualization_check_timestamp = timestamp;
+    no_sleep |= rejected_tx_queue.size_approx() || block_queue.size_approx() || approve_queue.size_approx() || approve_request_queue.size_approx();
+    if (no_sleep) {
+        wake();
+    }
+
+    if (prev_timestamp > last_actualization_check_timestamp) {
+        last_actualization_check_timestamp = prev_timestamp;
         check_if_chain_actual();
     }
+}
 
-    if (timestamp - last_actualization_timestamp > 5) {
-        last_actualization_timestamp = timestamp;
-        serial_execution.post(std::bind(&ControllerImplementation::actualize_chain, this));
+void ControllerImplementation::block_loop()
+{
+    uint64_t timestamp = get_timestamp();
+
+    log_network_statistics(timestamp);
+
+    // шаблон блока обновляется в process_queues
+    process_queues();
+
+    if (timestamp > last_actualization_check_timestamp) {
+        last_actualization_check_timestamp = timestamp;
+        check_if_chain_actual();
     }
 
-    no_sleep = check_awaited_blocks();
+    // повторная проверка ожидающего блока раз в секунду заодно перезапрашивает апрувы
+    bool no_sleep = check_awaited_blocks();
 
     if (check_if_can_make_block(timestamp)) {
         no_sleep = try_make_block(timestamp);
     }
 
     if (no_sleep) {
-        serial_execution.post(std::bind(&ControllerImplementation::main_loop, this));
-    } else {
-        main_loop_timer = boost::asio::deadline_timer(serial_execution, boost::posix_time::milliseconds(10));
-        main_loop_timer.async_wait([this](const boost::system::error_code&) {
-            main_loop();
-        });
+        wake();
     }
+
+    block_timer.expires_from_now(get_time_to_next_second());
+    block_timer.async_wait([this](const boost::system::error_code& ec) {
+        if (!ec) {
+            block_loop();
+        }
+    });
+}
+
+void ControllerImplementation::sync_loop()
+{
+    io_context.post(std::bind(&connection::MetaConnection::sync_core_lists, &cores));
+
+    sync_timer.expires_from_now(boost::posix_time::seconds(CORE_SYNC_PERIOD));
+    sync_timer.async_wait([this](const boost::system::error_code& ec) {
+        if (!ec) {
+            sync_loop();
+        }
+    });
+}
+
+void ControllerImplementation::actualization_loop()
+{
+    actualize_chain();
+
+    actualization_timer.expires_from_now(boost::posix_time::seconds(CHAIN_ACTUALIZATION_PERIOD));
+    actualization_timer.async_wait([this](const boost::system::error_code& ec) {
+        if (!ec) {
+            actualization_loop();
+        }
+    });
 }
 
 void ControllerImplementation::process_queues()
@@ -49,21 +116,25 @@ void ControllerImplementation::process_queues()
     {
         const uint64_t LIST_SIZE = 8000;
         {
-            static std::vector<transaction::TX*> tx_list(LIST_SIZE, nullptr);
-            if (auto size = tx_queue.try_dequeue_bulk(tx_list.begin(), LIST_SIZE)) {
-                for (uint i = 0; i < size; i++) {
-                    if (tx_list[i]) {
-                        transactions.push_back(tx_list[i]);
+            static std::vector<transaction::RejectedTXInfo*> rejected_list(LIST_SIZE, nullptr);
+            if (auto size = rejected_tx_queue.try_dequeue_bulk(rejected_list.begin(), LIST_SIZE)) {
+                if (master()) {
+                    rejected_tx_list.insert(rejected_tx_list.end(), rejected_list.begin(), rejected_list.begin() + size);
+                } else {
+                    for (uint i = 0; i < size; i++) {
+                        delete rejected_list[i];
                     }
                 }
-                //transactions.insert(transactions.end(), tx_list.begin(), tx_list.begin() + size);
             }
+
+            request_template_update(!not_actualized[0] && !not_actualized[1] && master() && last_applied_block == last_created_block);
         }
         {
             static std::vector<block::Block*> block_list(LIST_SIZE, nullptr);
             if (auto size = block_queue.try_dequeue_bulk(block_list.begin(), LIST_SIZE)) {
                 for (uint i = 0; i < size; i++) {
                     auto block = block_list[i];
+                    block_ingest.release(block->get_data().size());
 
                     if (dynamic_cast<block::CommonBlock*>(block)) {
                         missing_blocks.erase(block->get_block_hash());
@@ -90,29 +161,37 @@ void ControllerImplementation::process_queues()
                 for (uint i = 0; i < size; i++) {
                     auto&& [core_name, block_hash] = approve_request_list[i];
 
-                    auto approve_list_it = block_approve.find(block_hash);
-                    if (approve_list_it == block_approve.end()) {
+                    std::vector<const transaction::ApproveRecord*> approve_list;
+                    transaction::ApproveRecord own_approve;
+                    for (auto&& [core_addr, record] : approves.get_approves(block_hash)) {
+                        approve_list.push_back(record);
+                    }
+                    if (approve_list.empty()) {
                         sha256_2 got_block = last_applied_block;
                         while (got_block != block_hash && blocks.contains(got_block)) {
                             got_block = blocks[got_block]->get_prev_hash();
                         }
-                        if (got_block == block_hash) {
+                        if (got_block != block_hash) {
+                            continue;
+                        }
+
+                        // для давно записанного блока подписываем апрув заново, не сохраняя его
+                        if (known_approves.is_finalized(got_block)) {
+                            own_approve.make(got_block, signer);
+                            approve_list.push_back(&own_approve);
+                        } else {
                             auto* p_ar = new transaction::ApproveRecord;
                             p_ar->make(got_block, signer);
                             p_ar->approve = true;
-                            if (!block_approve[got_block].insert({ signer.get_mh_addr(), p_ar }).second) {
-                                delete p_ar;
+                            apply_approve(p_ar);
+                            for (auto&& [core_addr, record] : approves.get_approves(block_hash)) {
+                                approve_list.push_back(record);
                             }
-                            approve_list_it = block_approve.find(block_hash);
-                            if (approve_list_it == block_approve.end()) {
-                                continue;
-                            }
-                        } else {
-                            continue;
                         }
                     }
+
                     std::vector<char> approve_data_list;
-                    for (auto&& [core_addr, record] : approve_list_it->second) {
+                    for (auto* record : approve_list) {
                         uint64_t record_size = record->data.size();
                         approve_data_list.insert(approve_data_list.end(), reinterpret_cast<char*>(&record_size), reinterpret_cast<char*>(&record_size) + sizeof(uint64_t));
                         approve_data_list.insert(approve_data_list.end(), record->data.begin(), record->data.end());
@@ -145,6 +224,10 @@ bool ControllerImplementation::check_awaited_blocks()
 {
     static const sha256_2 zero_block = { { 0 } };
 
+    if (chain_busy) {
+        return false;
+    }
+
     if (last_applied_block != zero_block) {
         if (blocks.contains_next(last_applied_block)) {
             auto* block = blocks.get_next(last_applied_block);
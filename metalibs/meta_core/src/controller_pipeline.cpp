@@ -0,0 +1,63 @@
+#include "controller.hpp"
+#include <meta_constants.hpp>
+#include <meta_log.hpp>
+
+namespace metahash::meta_core {
+
+bool ControllerImplementation::run_on_chain(std::function<bool()> work, std::function<bool(bool)> done)
+{
+    // при чтении локальной цепочки стадии ещё не запущены, всё выполняется на месте
+    if (!pipeline_started) {
+        return done(work());
+    }
+
+    // у цепочки одно задание в работе, следующий блок проверяется только после применения предыдущего
+    chain_busy = true;
+    chain_execution.post([this, work, done] {
+        bool result = work();
+        serial_execution.post([this, result, done] {
+            chain_busy = false;
+            if (done(result)) {
+                wake();
+            }
+        });
+    });
+
+    return false;
+}
+
+void ControllerImplementation::request_template_update(bool build)
+{
+    template_build = build;
+    if (!template_pending.exchange(true)) {
+        chain_execution.post(std::bind(&ControllerImplementation::update_block_template, this));
+    }
+}
+
+void ControllerImplementation::update_block_template()
+{
+    template_pending = false;
+
+    const uint64_t LIST_SIZE = 8000;
+    static std::vector<transaction::TX*> tx_list(LIST_SIZE, nullptr);
+    while (auto size = tx_queue.try_dequeue_bulk(tx_list.begin(), LIST_SIZE)) {
+        for (uint i = 0; i < size; i++) {
+            if (tx_list[i]) {
+                tx_ingest.release(tx_list[i]->raw_tx.size());
+                mempool.insert(tx_list[i]);
+            }
+        }
+    }
+
+    if (template_build) {
+        uint64_t template_size = BC.get_block_template_size();
+        if (!mempool.empty() && template_size < MAX_TRANSACTION_COUNT) {
+            auto transactions = mempool.pull(MAX_TRANSACTION_COUNT - template_size);
+            BC.add_to_block_template(transactions);
+        }
+        BC.update_block_template();
+    }
+    mempool.release(BC.take_released_transactions());
+}
+
+}
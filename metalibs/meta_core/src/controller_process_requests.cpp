@@ -3,13 +3,55 @@
 #include <meta_constants.hpp>
 #include <meta_log.hpp>
 
+#include <future>
 #include <list>
 
 namespace metahash::meta_core {
 
+ControllerImplementation::IngestBudget::IngestBudget(uint64_t limit)
+    : limit(limit)
+{
+}
+
+bool ControllerImplementation::IngestBudget::reserve(uint64_t size)
+{
+    uint64_t current = pending;
+    do {
+        if (current && current + size > limit) {
+            dropped++;
+            return false;
+        }
+    } while (!pending.compare_exchange_weak(current, current + size));
+    return true;
+}
+
+void ControllerImplementation::IngestBudget::add(uint64_t size)
+{
+    pending += size;
+}
+
+void ControllerImplementation::IngestBudget::release(uint64_t size)
+{
+    pending -= size;
+}
+
 void ControllerImplementation::parse_RPC_TX(std::string_view pack)
 {
-    std::vector<transaction::TX*> tx_list(pack.size()/128);
+    if (!tx_ingest.reserve(pack.size())) {
+        return;
+    }
+
+    // разбор с проверкой подписей идёт в cpu_pool, поток сети только копирует пакет;
+    // принятые транзакции держат свои байты, пока update_block_template не заберёт их из tx_queue
+    cpu_pool.post([this, data = std::string(pack)] {
+        ingest_txs(data);
+        tx_ingest.release(data.size());
+    });
+}
+
+void ControllerImplementation::ingest_txs(std::string_view pack)
+{
+    std::vector<std::string_view> tx_buffs;
 
     uint64_t index = 0;
     uint64_t tx_size;
@@ -26,17 +68,9 @@ void ControllerImplementation::parse_RPC_TX(std::string_view pack)
             DEBUG_COUT("corrupt tx size");
             return;
         }
-        std::string_view tx_sw(&pack[index], tx_size);
+        tx_buffs.emplace_back(&pack[index], tx_size);
         index += tx_size;
 
-        auto p_tx = new transaction::TX;
-        if (p_tx->parse(tx_sw)) {
-            tx_list.push_back(p_tx);
-        } else {
-            delete p_tx;
-            DEBUG_COUT("corrupt tx");
-        }
-
         tx_size_arr = std::string_view(&pack[index], pack.size() - index);
         varint_size = crypto::read_varint(tx_size, tx_size_arr);
         if (varint_size < 1) {
@@ -46,33 +80,77 @@ void ControllerImplementation::parse_RPC_TX(std::string_view pack)
         index += varint_size;
     }
 
+    std::vector<transaction::TX*> parsed(tx_buffs.size(), nullptr);
+    std::vector<transaction::RejectedTXInfo*> rejected(tx_buffs.size(), nullptr);
+    pool::parallel_for(cpu_pool, tx_buffs.size(), TX_PARSE_CHUNK_MIN, [this, &tx_buffs, &parsed, &rejected](uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; i++) {
+            auto p_tx = new transaction::TX;
+            if (!p_tx->parse(tx_buffs[i])) {
+                delete p_tx;
+                DEBUG_COUT("corrupt tx");
+            } else if (uint64_t reason = BC.check_admission(p_tx)) {
+                if (reason != TX_ADMISSION_DROP) {
+                    rejected[i] = new transaction::RejectedTXInfo();
+                    rejected[i]->make(p_tx->hash, reason);
+                }
+                delete p_tx;
+            } else {
+                parsed[i] = p_tx;
+            }
+        }
+    });
+
+    std::vector<transaction::TX*> tx_list;
+    uint64_t queued_bytes = 0;
+    for (uint64_t i = 0; i < tx_buffs.size(); i++) {
+        if (parsed[i]) {
+            tx_list.push_back(parsed[i]);
+            queued_bytes += parsed[i]->raw_tx.size();
+        } else if (rejected[i]) {
+            rejected_tx_queue.enqueue(rejected[i]);
+        }
+    }
+
     if (tx_list.size()) {
+        // до постановки в очередь, иначе update_block_template может вычесть байты раньше
+        tx_ingest.add(queued_bytes);
         tx_queue.enqueue_bulk(tx_list.begin(), tx_list.size());
+        wake();
     }
 }
 
 void ControllerImplementation::parse_RPC_PRETEND_BLOCK(std::string_view pack)
 {
-    std::string_view block_sw(pack);
-    auto* block = block::parse_block(block_sw);
+    if (!block_ingest.reserve(pack.size())) {
+        return;
+    }
 
-    if (block) {
-        if (dynamic_cast<block::CommonBlock*>(block) || dynamic_cast<block::RejectedTXBlock*>(block)) {
-            block_queue.enqueue(block);
-        } else {
-            delete block;
+    // подписи блока проверяются при разборе, поэтому он идёт в cpu_pool
+    cpu_pool.post([this, data = std::string(pack)] {
+        auto* block = block::parse_block(data);
+
+        if (block) {
+            if (dynamic_cast<block::CommonBlock*>(block) || dynamic_cast<block::RejectedTXBlock*>(block)) {
+                block_ingest.add(block->get_data().size());
+                block_queue.enqueue(block);
+                wake();
+            } else {
+                delete block;
+            }
         }
-    }
+        block_ingest.release(data.size());
+    });
 }
 
 void ControllerImplementation::parse_RPC_APPROVE(std::string_view pack)
 {
     std::string_view approve_sw(pack);
     auto* p_ar = new transaction::ApproveRecord;
-    if (p_ar->parse(approve_sw)) {
+    if (p_ar->parse(approve_sw, false)) {
         p_ar->approve = true;
 
-        approve_queue.enqueue(p_ar);
+        std::vector<transaction::ApproveRecord*> records { p_ar };
+        ingest_approves(records);
     } else {
         delete p_ar;
     }
@@ -82,10 +160,11 @@ void ControllerImplementation::parse_RPC_DISAPPROVE(std::string_view pack)
 {
     std::string_view approve_sw(pack);
     auto* p_ar = new transaction::ApproveRecord;
-    if (p_ar->parse(approve_sw)) {
+    if (p_ar->parse(approve_sw, false)) {
         p_ar->approve = false;
 
-        approve_queue.enqueue(p_ar);
+        std::vector<transaction::ApproveRecord*> records { p_ar };
+        ingest_approves(records);
     } else {
         delete p_ar;
     }
@@ -93,6 +172,7 @@ void ControllerImplementation::parse_RPC_DISAPPROVE(std::string_view pack)
 
 void ControllerImplementation::parse_RPC_APPROVE_LIST(std::string_view pack)
 {
+    std::vector<transaction::ApproveRecord*> records;
     uint index = 0;
     while (index + 8 <= pack.size()) {
         uint64_t approve_size = *(reinterpret_cast<const uint64_t*>(&pack[index]));
@@ -102,9 +182,17 @@ void ControllerImplementation::parse_RPC_APPROVE_LIST(std::string_view pack)
             break;
         }
         std::string_view approve_sw(&pack[index], approve_size);
-        parse_RPC_APPROVE(approve_sw);
+        auto* p_ar = new transaction::ApproveRecord;
+        if (p_ar->parse(approve_sw, false)) {
+            p_ar->approve = true;
+            records.push_back(p_ar);
+        } else {
+            delete p_ar;
+        }
         index += approve_size;
     }
+
+    ingest_approves(records);
 }
 
 void ControllerImplementation::parse_RPC_GET_APPROVE(const std::string& core, std::string_view pack)
@@ -118,6 +206,7 @@ void ControllerImplementation::parse_RPC_GET_APPROVE(const std::string& core, st
     std::copy_n(pack.begin(), 32, approve_wanted_block.begin());
 
     approve_request_queue.enqueue({core, approve_wanted_block});
+    wake();
 }
 
 std::vector<char> ControllerImplementation::parse_RPC_LAST_BLOCK(std::string_view)
@@ -126,10 +215,11 @@ std::vector<char> ControllerImplementation::parse_RPC_LAST_BLOCK(std::string_vie
     sha256_2 got_block;
     uint64_t got_timestamp;
 
+    auto reader = blocks.read();
     if (master()) {
-        if (blocks.contains(last_created_block)) {
+        if (auto* block = reader.get(last_created_block)) {
             got_block = last_created_block;
-            got_timestamp = blocks[last_created_block]->get_block_timestamp();
+            got_timestamp = block->get_block_timestamp();
         } else {
             got_block = last_applied_block;
             got_timestamp = prev_timestamp;
@@ -146,6 +236,56 @@ std::vector<char> ControllerImplementation::parse_RPC_LAST_BLOCK(std::string_vie
     return last_block;
 }
 
+std::vector<char> ControllerImplementation::parse_RPC_GET_STATE_ROOT(std::string_view)
+{
+    std::vector<char> state_root;
+
+    auto reader = BC.get_last_state_root();
+    state_root.insert(state_root.end(), reader->block_hash.begin(), reader->block_hash.end());
+    state_root.insert(state_root.end(), reader->root.begin(), reader->root.end());
+
+    return state_root;
+}
+
+std::vector<char> ControllerImplementation::parse_RPC_GET_STATE_PROOF(std::string_view pack)
+{
+    if (pack.size() < 25) {
+        return std::vector<char>();
+    }
+    const std::string addr = "0x" + crypto::bin2hex(pack.substr(0, 25));
+
+    // дерево и кошельки меняются только в потоке цепочки, запрос встаёт в его очередь
+    auto promise = std::make_shared<std::promise<std::vector<char>>>();
+    auto result = promise->get_future();
+    chain_execution.post([this, addr, promise] {
+        std::vector<char> proof_pack;
+        meta_chain::StateProof proof;
+        if (BC.get_state_proof(addr, proof)) {
+            auto reader = BC.get_last_state_root();
+            crypto::ByteWriter writer(proof_pack);
+            writer.write(reader->block_hash);
+            writer.write(reader->root);
+            writer.write_varint(proof.value);
+            writer.write_varint(proof.nonce);
+            writer.write_frame(proof.data);
+            writer.write_varint(proof.bucket.size());
+            for (const auto& hash : proof.bucket) {
+                writer.write(hash);
+            }
+            writer.write_varint(proof.path.size());
+            for (const auto& hash : proof.path) {
+                writer.write(hash);
+            }
+        }
+        promise->set_value(std::move(proof_pack));
+    });
+
+    if (result.wait_for(std::chrono::milliseconds(STATE_PROOF_WAIT_MS)) != std::future_status::ready) {
+        return std::vector<char>();
+    }
+    return result.get();
+}
+
 std::vector<char> ControllerImplementation::parse_RPC_GET_BLOCK(std::string_view pack)
 {
     if (pack.size() < 32) {
@@ -155,8 +295,9 @@ std::vector<char> ControllerImplementation::parse_RPC_GET_BLOCK(std::string_view
     sha256_2 block_hash;
     std::copy_n(pack.begin(), 32, block_hash.begin());
 
-    if (blocks.contains(block_hash)) {
-        return blocks[block_hash]->get_data();
+    auto reader = blocks.read();
+    if (auto* block = reader.get(block_hash)) {
+        return block->get_data();
     }
 
     return std::vector<char>();
@@ -175,13 +316,19 @@ std::vector<char> ControllerImplementation::parse_RPC_GET_MISSING_BLOCK_LIST(std
 
     sha256_2 got_block = last_applied_block;
 
-    while (got_block != prev_block && blocks.contains(got_block)) {
+    auto reader = blocks.read();
+    while (got_block != prev_block) {
+        auto* block = reader.get(got_block);
+        if (!block) {
+            break;
+        }
+
         chain.insert(chain.end(), got_block.begin(), got_block.end());
 
-        got_block = blocks[got_block]->get_prev_hash();
+        got_block = block->get_prev_hash();
     }
 
-    if (blocks.contains(prev_block)) {
+    if (reader.get(prev_block)) {
         chain.insert(chain.end(), prev_block.begin(), prev_block.end());
     }
 
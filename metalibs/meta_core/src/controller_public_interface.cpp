@@ -6,15 +6,22 @@ namespace metahash::meta_core {
 
 ControllerImplementation::ControllerImplementation(
     boost::asio::io_context& io_context,
+    pool::CpuPool& cpu_pool,
     const std::string& priv_key_line,
     const std::string& path,
     const std::string& proved_hash,
     const std::map<std::string, std::pair<std::string, int>>& core_list,
     const std::pair<std::string, int>& host_port)
-    : BC(io_context)
+    : BC(cpu_pool)
     , io_context(io_context)
+    , cpu_pool(cpu_pool)
     , serial_execution(io_context)
-    , main_loop_timer(serial_execution, boost::posix_time::milliseconds(10))
+    , chain_work(chain_execution.get_executor())
+    , persist_work(persist_execution.get_executor())
+    , block_timer(serial_execution)
+    , sync_timer(serial_execution)
+    , actualization_timer(serial_execution)
+    , mempool(MEMPOOL_MAX_TX_COUNT, MEMPOOL_MAX_BYTES)
     , min_approve(std::ceil(METAHASH_PRIMARY_CORES_COUNT * 51.0 / 100.0))
     , path(path)
     , signer(crypto::hex2bin(priv_key_line))
@@ -23,12 +30,29 @@ ControllerImplementation::ControllerImplementation(
 {
     DEBUG_COUT("min_approve\t" + std::to_string(min_approve));
 
+    for (auto* stage : { &chain_execution, &persist_execution }) {
+        stage_threads.emplace_back([stage] {
+            stage->run();
+        });
+    }
+
     {
         for (auto&& [addr, _] : core_list) {
             current_cores.push_back(addr);
         }
     }
 
+    {
+        approves.min_approve = min_approve;
+        approves.set_cores(current_cores);
+        approves.on_quorum = [this](const sha256_2& block_hash) {
+            // кворум по блоку, которого у нас нет, - повод запросить его у ядер
+            if (!blocks.contains(block_hash)) {
+                missing_blocks[block_hash];
+            }
+        };
+    }
+
     {
         std::vector<unsigned char> bin_proved_hash = crypto::hex2bin(proved_hash);
         std::copy_n(bin_proved_hash.begin(), 32, proved_block.begin());
@@ -36,13 +60,27 @@ ControllerImplementation::ControllerImplementation(
 
     read_and_apply_local_chain();
 
+    pipeline_started = true;
     serial_execution.post(std::bind(&ControllerImplementation::main_loop, this));
+    serial_execution.post(std::bind(&ControllerImplementation::block_loop, this));
+    serial_execution.post(std::bind(&ControllerImplementation::sync_loop, this));
+    serial_execution.post(std::bind(&ControllerImplementation::actualization_loop, this));
 
     listener.start();
 
     cores.init(core_list);
 }
 
+ControllerImplementation::~ControllerImplementation()
+{
+    // стадии дорабатывают поставленное, в том числе запись блоков на диск
+    chain_work.reset();
+    persist_work.reset();
+    for (auto& thread : stage_threads) {
+        thread.join();
+    }
+}
+
 std::atomic<std::map<std::string, std::pair<uint, uint>>*>& ControllerImplementation::get_wallet_statistics()
 {
     return BC.get_wallet_statistics();
@@ -7,7 +7,7 @@
 
 #include <experimental/filesystem>
 #include <fstream>
-#include <list>
+#include <future>
 
 namespace metahash::meta_core {
 
@@ -38,36 +38,31 @@ std::set<std::string> get_files_in_dir(const std::string& path)
     return files;
 }
 
-void parse_block_async(
-    boost::asio::io_context& io_context,
-    std::list<std::future<block::Block*>>& futures,
-    char* block_buff,
-    int64_t block_size,
-    bool delete_buff)
+void parse_blocks(
+    pool::CpuPool& cpu_pool,
+    const std::vector<std::string_view>& block_buffs,
+    std::vector<block::Block*>& parsed)
 {
-    auto promise = std::make_shared<std::promise<block::Block*>>();
-    futures.emplace_back(promise->get_future());
+    const uint64_t offset = parsed.size();
+    parsed.resize(offset + block_buffs.size(), nullptr);
 
-    boost::asio::post(io_context, [block_buff, block_size, delete_buff, promise]() {
-        std::string_view block_as_string(block_buff, block_size);
-        auto* block = block::parse_block(block_as_string);
+    pool::parallel_for(cpu_pool, block_buffs.size(), BLOCK_PARSE_CHUNK_MIN, [&block_buffs, &parsed, offset](uint64_t begin, uint64_t end) {
+        for (uint64_t i = begin; i < end; i++) {
+            auto* block = block::parse_block(block_buffs[i]);
 
-        if (block) {
-            if (!dynamic_cast<block::CommonBlock*>(block) && !dynamic_cast<block::ApproveBlock*>(block)) {
-                delete block;
-                block = nullptr;
+            if (block) {
+                if (!dynamic_cast<block::CommonBlock*>(block) && !dynamic_cast<block::ApproveBlock*>(block)) {
+                    delete block;
+                    block = nullptr;
+                } else {
+                    block->set_local();
+                }
             } else {
-                block->set_local();
+                DEBUG_COUT("Block parse error");
             }
-        } else {
-            DEBUG_COUT("Block parse error");
-        }
 
-        if (delete_buff) {
-            delete[] block_buff;
+            parsed[offset + i] = block;
         }
-
-        promise->set_value(block);
     });
 }
 
@@ -100,56 +95,86 @@ std::string read_last_known_state(sha256_2& proved_block)
     return last_file;
 }
 
+std::vector<char> read_block_file(const std::string& file)
+{
+    std::ifstream ifile(file.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+
+    if (!ifile.is_open()) {
+        std::string msg = "!file.is_open()\t" + file;
+        DEBUG_COUT(msg);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        exit(1);
+    }
+
+    std::vector<char> file_data(static_cast<uint64_t>(ifile.tellg()));
+    ifile.seekg(0);
+    if (!ifile.read(file_data.data(), static_cast<int64_t>(file_data.size()))) {
+        DEBUG_COUT("read file error\t" + file);
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        exit(1);
+    }
+
+    return file_data;
+}
+
 void read_stored_blocks(
-    boost::asio::io_context& io_context,
+    pool::CpuPool& cpu_pool,
     const std::string& path,
     const std::string& last_file,
-    std::list<std::future<metahash::block::Block*>>& pending_data)
+    std::vector<block::Block*>& parsed)
 {
     uint files_read = 0;
     uint blocks_read = 0;
 
-    char uint64_buff[8];
-    std::set<std::string> files = get_files_in_dir(path);
-
+    std::vector<std::string> files;
     bool old_files = true;
-    for (const std::string& file : files) {
+    for (const std::string& file : get_files_in_dir(path)) {
         if (file == last_file) {
             old_files = false;
         }
 
-        if (old_files) {
-            continue;
+        if (!old_files) {
+            files.push_back(file);
         }
+    }
 
-        std::ifstream ifile(file.c_str(), std::ios::in | std::ios::binary);
+    // файл читается целиком, блоки разбираются параллельно прямо из его буфера;
+    // следующий файл тем временем читается с диска
+    std::future<std::vector<char>> next_file;
+    if (!files.empty()) {
+        next_file = std::async(std::launch::async, read_block_file, files.front());
+    }
 
-        if (ifile.is_open()) {
-            files_read++;
-            while (ifile.read(uint64_buff, 8)) {
-                uint64_t block_size = *(reinterpret_cast<uint64_t*>(uint64_buff));
-                char* block_buff = new char[block_size];
+    for (uint64_t file_index = 0; file_index < files.size(); file_index++) {
+        const std::string& file = files[file_index];
+        std::vector<char> file_data = next_file.get();
+        if (file_index + 1 < files.size()) {
+            next_file = std::async(std::launch::async, read_block_file, files[file_index + 1]);
+        }
+        files_read++;
+
+        std::vector<std::string_view> block_buffs;
+        uint64_t cur_pos = 0;
+        while (cur_pos + 8 <= file_data.size()) {
+            uint64_t block_size = *(reinterpret_cast<const uint64_t*>(&file_data[cur_pos]));
+            cur_pos += 8;
+
+            if (block_size > file_data.size() - cur_pos) {
+                DEBUG_COUT("read file error\t" + file);
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                exit(1);
+            }
 
-                if (ifile.read(block_buff, static_cast<int64_t>(block_size))) {
-                    blocks_read++;
-                    parse_block_async(io_context, pending_data, block_buff, block_size, true);
-                } else {
-                    DEBUG_COUT("read file error\t" + file);
-                    std::this_thread::sleep_for(std::chrono::seconds(1));
-                    exit(1);
-                }
+            block_buffs.emplace_back(&file_data[cur_pos], block_size);
+            cur_pos += block_size;
 
-                if (blocks_read % 250000 == 0) {
-                    DEBUG_COUT("Read blocks\t" + std::to_string(blocks_read) + "\tin files\t " + std::to_string(files_read));
-                }
+            blocks_read++;
+            if (blocks_read % 250000 == 0) {
+                DEBUG_COUT("Read blocks\t" + std::to_string(blocks_read) + "\tin files\t " + std::to_string(files_read));
             }
-
-        } else {
-            std::string msg = "!file.is_open()\t" + file;
-            DEBUG_COUT(msg);
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            exit(1);
         }
+
+        parse_blocks(cpu_pool, block_buffs, parsed);
     }
 }
 
@@ -157,20 +182,21 @@ void ControllerImplementation::read_and_apply_local_chain()
 {
     auto last_file = read_last_known_state(proved_block);
 
-    std::list<std::future<block::Block*>> pending_data;
+    std::vector<block::Block*> parsed;
 
-    read_stored_blocks(io_context, path, last_file, pending_data);
+    read_stored_blocks(cpu_pool, path, last_file, parsed);
     DEBUG_COUT("READ COMPLETE");
 
     uint blocks_processed = 0;
-    for (auto&& fut : pending_data) {
-        auto block = fut.get();
+    for (auto* block : parsed) {
         if (block) {
             if (dynamic_cast<block::CommonBlock*>(block)) {
                 blocks.insert(block);
             } else if (auto* a_block = dynamic_cast<block::ApproveBlock*>(block)) {
                 for (auto& tx : a_block->get_txs()) {
-                    block_approve[tx.get_block_hash()].insert({ "0x" + crypto::bin2hex(crypto::get_address(tx.pub_key)), new transaction::ApproveRecord(std::move(tx)) });
+                    auto* p_ar = new transaction::ApproveRecord(std::move(tx));
+                    p_ar->approve = true;
+                    apply_approve(p_ar);
                 }
 
                 check_blocks();
@@ -188,32 +214,29 @@ void ControllerImplementation::read_and_apply_local_chain()
 
     DEBUG_COUT("LOCAL COMPLETE");
     {
-        std::list<std::future<transaction::ApproveRecord*>> pending_data;
+        std::vector<sha256_2> unsigned_blocks;
 
         sha256_2 got_block = last_applied_block;
-        while (blocks.contains(got_block)) {
-            auto approve_list_it = block_approve.find(got_block);
-            if (approve_list_it == block_approve.end() || !approve_list_it->second.count(signer.get_mh_addr())) {
-                auto promise = std::make_shared<std::promise<transaction::ApproveRecord*>>();
-                pending_data.emplace_back(promise->get_future());
-
-                boost::asio::post(io_context, [got_block, this, promise]() {
-                    auto* p_ar = new transaction::ApproveRecord;
-                    p_ar->make(got_block, signer);
-                    p_ar->approve = true;
-
-                    promise->set_value(p_ar);
-                });
+        while (blocks.contains(got_block) && !known_approves.is_finalized(got_block)) {
+            if (!approves.contains(got_block, signer.get_mh_addr())) {
+                unsigned_blocks.push_back(got_block);
             }
 
             got_block = blocks[got_block]->get_prev_hash();
         }
 
-        for (auto&& fut : pending_data) {
-            auto p_ar = fut.get();
-            if (!block_approve[p_ar->get_block_hash()].insert({ signer.get_mh_addr(), p_ar }).second) {
-                delete p_ar;
+        std::vector<transaction::ApproveRecord*> own_approves(unsigned_blocks.size(), nullptr);
+        pool::parallel_for(cpu_pool, unsigned_blocks.size(), APPROVE_VERIFY_CHUNK_MIN, [this, &unsigned_blocks, &own_approves](uint64_t begin, uint64_t end) {
+            for (uint64_t i = begin; i < end; i++) {
+                auto* p_ar = new transaction::ApproveRecord;
+                p_ar->make(unsigned_blocks[i], signer);
+                p_ar->approve = true;
+                own_approves[i] = p_ar;
             }
+        });
+
+        for (auto* p_ar : own_approves) {
+            apply_approve(p_ar);
         }
     }
     DEBUG_COUT("APPROVE COMPLETE");
@@ -12,6 +12,10 @@ bool ControllerImplementation::try_make_block(uint64_t timestamp)
         return false;
     }
 
+    if (chain_busy) {
+        return false;
+    }
+
     if (last_applied_block == last_created_block) {
         if (prev_timestamp >= timestamp) {
             return false;
@@ -33,17 +37,22 @@ bool ControllerImplementation::try_make_block(uint64_t timestamp)
             }
         }
 
-        {
+        bool statistics = false;
+        if (block_state == BLOCK_TYPE_COMMON && timestamp - statistics_timestamp > 600) {
+            statistics = true;
+            statistics_timestamp = timestamp;
+        }
+
+        auto made = std::make_shared<block::Block*>(nullptr);
+        auto rejected = std::make_shared<std::vector<transaction::RejectedTXInfo*>*>(nullptr);
+        return run_on_chain([this, made, rejected, block_state, statistics, timestamp] {
             block::Block* block = nullptr;
             switch (block_state) {
             case BLOCK_TYPE_COMMON:
-                if (timestamp - statistics_timestamp > 600) {
+                if (statistics) {
                     block = BC.make_statistics_block(timestamp);
-                    statistics_timestamp = timestamp;
                 } else {
-                    if (!transactions.empty()) {
-                        block = BC.make_common_block(timestamp, transactions);
-                    }
+                    block = BC.make_common_block(timestamp);
                 }
                 break;
             case BLOCK_TYPE_FORGING:
@@ -56,8 +65,16 @@ bool ControllerImplementation::try_make_block(uint64_t timestamp)
                 break;
             }
 
+            *made = block;
             if (block) {
-                if (BC.can_apply_block(block)) {
+                return BC.can_apply_block(block);
+            }
+
+            *rejected = BC.make_rejected_tx_block(timestamp);
+            return true;
+        }, [this, made, rejected, timestamp](bool valid) {
+            if (auto* block = *made) {
+                if (valid) {
                     last_created_block = block->get_block_hash();
                     blocks.insert(block);
                     distribute(block);
@@ -69,27 +86,35 @@ bool ControllerImplementation::try_make_block(uint64_t timestamp)
                 std::this_thread::sleep_for(std::chrono::seconds(3));
                 exit(1);
             }
-        }
 
-        if (auto tx_list = BC.make_rejected_tx_block(timestamp)) {
-            rejected_tx_list.insert(rejected_tx_list.end(), tx_list->begin(), tx_list->end());
-            delete tx_list;
-
-            auto reject_tx_block = new block::RejectedTXBlock;
-            if (!rejected_tx_list.empty() && prev_rejected_ts != timestamp && reject_tx_block->make(timestamp, last_applied_block, rejected_tx_list, signer)) {
-                prev_rejected_ts = timestamp;
-                distribute(reject_tx_block);
-                write_block(reject_tx_block);
-                for (auto* tx : rejected_tx_list) {
-                    delete tx;
-                }
-                rejected_tx_list.clear();
-            }
-            delete reject_tx_block;
-        }
+            make_rejected_tx_block(timestamp, *rejected);
+            return false;
+        });
     }
 
     return false;
 }
 
-}
\ No newline at end of file
+void ControllerImplementation::make_rejected_tx_block(uint64_t timestamp, std::vector<transaction::RejectedTXInfo*>* tx_list)
+{
+    if (tx_list) {
+        rejected_tx_list.insert(rejected_tx_list.end(), tx_list->begin(), tx_list->end());
+        delete tx_list;
+    }
+
+    if (!rejected_tx_list.empty()) {
+        auto reject_tx_block = new block::RejectedTXBlock;
+        if (prev_rejected_ts != timestamp && reject_tx_block->make(timestamp, last_applied_block, rejected_tx_list, signer)) {
+            prev_rejected_ts = timestamp;
+            distribute(reject_tx_block);
+            write_block(reject_tx_block);
+            for (auto* tx : rejected_tx_list) {
+                delete tx;
+            }
+            rejected_tx_list.clear();
+        }
+        delete reject_tx_block;
+    }
+}
+
+}
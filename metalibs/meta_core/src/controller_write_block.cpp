@@ -33,31 +33,36 @@ void ControllerImplementation::write_block(block::Block* block)
     if (dynamic_cast<block::CommonBlock*>(block)) {
         DEBUG_COUT("CommonBlock");
 
-        uint64_t block_size = block->get_data().size() /* + approve_buff.size()*/;
-
-        std::ofstream myfile;
-        myfile.open(file_path.c_str(), std::ios::out | std::ios::app | std::ios::binary);
-        myfile.write(reinterpret_cast<char*>(&block_size), sizeof(uint64_t));
-        myfile.write(block->get_data().data(), static_cast<int64_t>(block->get_data().size()));
-        myfile.close();
-
+        auto* approve_block = new block::ApproveBlock;
         {
-            auto approve_block = new block::ApproveBlock;
             std::vector<transaction::ApproveRecord*> approve_list;
-            for (const auto& tx_pair : block_approve[block->get_block_hash()]) {
+            for (const auto& tx_pair : approves.get_approves(block->get_block_hash())) {
                 approve_list.push_back(tx_pair.second);
             }
-            if (approve_block->make(block->get_block_timestamp(), block->get_block_hash(), approve_list)) {
-                uint64_t approve_block_size = approve_block->get_data().size() /* + approve_buff.size()*/;
-                std::ofstream out_file;
-                out_file.open(file_path.c_str(), std::ios::out | std::ios::app | std::ios::binary);
-                out_file.write(reinterpret_cast<char*>(&approve_block_size), sizeof(uint64_t));
-                out_file.write(approve_block->get_data().data(), static_cast<int64_t>(approve_block->get_data().size()));
-                out_file.close();
+            if (!approve_block->make(block->get_block_timestamp(), block->get_block_hash(), approve_list)) {
                 delete approve_block;
+                approve_block = nullptr;
             }
         }
 
+        // применённые блоки не удаляются, данные блока можно читать со стадии записи
+        persist_execution.post([block, approve_block, file_path] {
+            uint64_t block_size = block->get_data().size() /* + approve_buff.size()*/;
+
+            std::ofstream myfile;
+            myfile.open(file_path.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+            myfile.write(reinterpret_cast<char*>(&block_size), sizeof(uint64_t));
+            myfile.write(block->get_data().data(), static_cast<int64_t>(block->get_data().size()));
+
+            if (approve_block) {
+                uint64_t approve_block_size = approve_block->get_data().size() /* + approve_buff.size()*/;
+                myfile.write(reinterpret_cast<char*>(&approve_block_size), sizeof(uint64_t));
+                myfile.write(approve_block->get_data().data(), static_cast<int64_t>(approve_block->get_data().size()));
+                delete approve_block;
+            }
+            myfile.close();
+        });
+
         {
             uint64_t timestamp = static_cast<uint64_t>(std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now()).time_since_epoch().count());
             DEBUG_COUT("block size and latency\t" + std::to_string(dynamic_cast<block::CommonBlock*>(block)->get_data().size()) + "\t" + std::to_string(timestamp - prev_timestamp));
@@ -66,34 +71,41 @@ void ControllerImplementation::write_block(block::Block* block)
         {
             auto common_block = dynamic_cast<block::CommonBlock*>(block);
             if (common_block && common_block->get_block_type() == BLOCK_TYPE_STATE) {
-                std::ofstream cache_file("last_state.json");
-                if (cache_file.is_open()) {
-                    rapidjson::StringBuffer s;
-                    rapidjson::Writer<rapidjson::StringBuffer> writer(s);
-                    writer.StartObject();
-                    {
-                        writer.String("hash");
-                        writer.String(crypto::bin2hex(common_block->get_block_hash()).c_str());
-                        writer.String("file");
-                        writer.String(file_path.c_str());
+                auto block_hash = common_block->get_block_hash();
+                persist_execution.post([block_hash, file_path] {
+                    std::ofstream cache_file("last_state.json");
+                    if (cache_file.is_open()) {
+                        rapidjson::StringBuffer s;
+                        rapidjson::Writer<rapidjson::StringBuffer> writer(s);
+                        writer.StartObject();
+                        {
+                            writer.String("hash");
+                            writer.String(crypto::bin2hex(block_hash).c_str());
+                            writer.String("file");
+                            writer.String(file_path.c_str());
+                        }
+                        writer.EndObject();
+
+                        cache_file << std::string(s.GetString());
+                        cache_file.close();
                     }
-                    writer.EndObject();
-
-                    cache_file << std::string(s.GetString());
-                    cache_file.close();
-                }
+                });
             }
         }
     } else if (dynamic_cast<block::RejectedTXBlock*>(block)) {
         DEBUG_COUT("RejectedTXBlock");
 
-        uint64_t block_size = block->get_data().size() /* + approve_buff.size()*/;
-
-        std::ofstream out_file;
-        out_file.open(file_path.c_str(), std::ios::out | std::ios::app | std::ios::binary);
-        out_file.write(reinterpret_cast<char*>(&block_size), sizeof(uint64_t));
-        out_file.write(block->get_data().data(), static_cast<int64_t>(block->get_data().size()));
-        out_file.close();
+        // блок отклонённых транзакций удаляется сразу после записи, поэтому данные копируются
+        auto data = std::make_shared<std::vector<char>>(block->get_data().begin(), block->get_data().end());
+        persist_execution.post([data, file_path] {
+            uint64_t block_size = data->size() /* + approve_buff.size()*/;
+
+            std::ofstream out_file;
+            out_file.open(file_path.c_str(), std::ios::out | std::ios::app | std::ios::binary);
+            out_file.write(reinterpret_cast<char*>(&block_size), sizeof(uint64_t));
+            out_file.write(data->data(), static_cast<int64_t>(data->size()));
+            out_file.close();
+        });
     }
 }
 
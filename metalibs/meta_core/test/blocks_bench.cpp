@@ -0,0 +1,208 @@
+#include "controller_blocks.hpp"
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <shared_mutex>
+#include <unordered_map>
+
+using namespace metahash;
+
+namespace {
+
+const uint64_t HOT_BLOCK_COUNT = 200000;
+const uint64_t WRITER_WINDOW = 100;
+const uint64_t LOOKUP_BATCH = 64;
+const auto RUN_TIME = std::chrono::seconds(1);
+
+sha256_2 hash_of(uint64_t id)
+{
+    sha256_2 hash;
+    std::mt19937_64 rng(id);
+    for (auto& byte : hash) {
+        byte = rng();
+    }
+    return hash;
+}
+
+class TestBlock : public block::Block {
+private:
+    const sha256_2 hash;
+    const sha256_2 prev_hash;
+
+public:
+    explicit TestBlock(uint64_t id)
+        : hash(hash_of(id + 1))
+        , prev_hash(hash_of(id))
+    {
+    }
+
+    sha256_2 get_block_hash() const override
+    {
+        return hash;
+    }
+
+    sha256_2 get_prev_hash() const override
+    {
+        return prev_hash;
+    }
+
+    bool parse(std::string_view) override
+    {
+        return false;
+    }
+};
+
+// прежний индекс: две хеш-таблицы под shared_mutex
+struct LockedBlocks {
+    std::shared_mutex blocks_lock;
+    std::unordered_map<sha256_2, block::Block*, crypto::Hasher> blocks;
+    std::unordered_map<sha256_2, block::Block*, crypto::Hasher> previous;
+
+    ~LockedBlocks()
+    {
+        for (auto&& [_, block] : blocks) {
+            delete block;
+        }
+    }
+
+    block::Block* get(const sha256_2& hash)
+    {
+        std::shared_lock lock(blocks_lock);
+        auto it = blocks.find(hash);
+        return it == blocks.end() ? nullptr : it->second;
+    }
+
+    void insert(block::Block* block)
+    {
+        std::unique_lock lock(blocks_lock);
+        blocks.insert({ block->get_block_hash(), block });
+        previous.insert({ block->get_prev_hash(), block });
+    }
+
+    void erase(const sha256_2& hash)
+    {
+        std::unique_lock lock(blocks_lock);
+        auto it = blocks.find(hash);
+        if (it != blocks.end()) {
+            previous.erase(it->second->get_prev_hash());
+            delete it->second;
+            blocks.erase(it);
+        }
+    }
+};
+
+struct EpochBlocks {
+    meta_core::Blocks blocks;
+
+    ~EpochBlocks()
+    {
+        for (uint64_t id = 0; id < HOT_BLOCK_COUNT; id++) {
+            blocks.erase(hash_of(id + 1));
+        }
+    }
+
+    block::Block* get(const sha256_2& hash)
+    {
+        return blocks.read().get(hash);
+    }
+
+    void insert(block::Block* block)
+    {
+        blocks.insert(block);
+    }
+
+    void erase(const sha256_2& hash)
+    {
+        blocks.erase(hash);
+    }
+};
+
+template <typename Index>
+void run(const std::string& name, uint64_t reader_count, bool writer)
+{
+    Index index;
+    std::vector<sha256_2> hot_hashes;
+    for (uint64_t id = 0; id < HOT_BLOCK_COUNT; id++) {
+        auto* block = new TestBlock(id);
+        hot_hashes.push_back(block->get_block_hash());
+        index.insert(block);
+    }
+
+    std::atomic<bool> stop = false;
+    std::atomic<uint64_t> lookups = 0;
+    std::atomic<uint64_t> writes = 0;
+    std::atomic<uint64_t> worst_ns = 0;
+
+    std::vector<std::thread> threads;
+    for (uint64_t r = 0; r < reader_count; r++) {
+        threads.emplace_back([&, r] {
+            std::mt19937_64 rng(r);
+            uint64_t local_lookups = 0;
+            uint64_t local_worst = 0;
+            uint64_t found = 0;
+            while (!stop) {
+                auto start = std::chrono::steady_clock::now();
+                for (uint64_t i = 0; i < LOOKUP_BATCH; i++) {
+                    found += index.get(hot_hashes[rng() % HOT_BLOCK_COUNT]) != nullptr;
+                }
+                uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                local_worst = std::max(local_worst, elapsed);
+                local_lookups += LOOKUP_BATCH;
+            }
+            lookups += local_lookups + (found == 0);
+
+            uint64_t worst = worst_ns.load();
+            while (worst < local_worst && !worst_ns.compare_exchange_weak(worst, local_worst)) {
+            }
+        });
+    }
+
+    if (writer) {
+        // писатель добавляет блоки другой цепочки и снимает отставшие от окна
+        threads.emplace_back([&] {
+            std::deque<sha256_2> window;
+            uint64_t id = HOT_BLOCK_COUNT + 1;
+            while (!stop) {
+                auto* block = new TestBlock(id++);
+                window.push_back(block->get_block_hash());
+                index.insert(block);
+                if (window.size() > WRITER_WINDOW) {
+                    index.erase(window.front());
+                    window.pop_front();
+                }
+            }
+            for (const auto& hash : window) {
+                index.erase(hash);
+            }
+            writes += id - HOT_BLOCK_COUNT - 1;
+        });
+    }
+
+    std::this_thread::sleep_for(RUN_TIME);
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::cout << name
+              << " readers=" << reader_count
+              << " writer=" << writer
+              << " lookups_per_s=" << lookups / std::chrono::duration<double>(RUN_TIME).count()
+              << " writes=" << writes
+              << " worst_batch_us=" << worst_ns / 1000.0 << std::endl;
+}
+
+}
+
+int main()
+{
+    for (uint64_t reader_count : { 1, 3 }) {
+        for (bool writer : { false, true }) {
+            run<LockedBlocks>("shared_mutex", reader_count, writer);
+            run<EpochBlocks>("epoch", reader_count, writer);
+        }
+    }
+    return 0;
+}
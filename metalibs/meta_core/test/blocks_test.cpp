@@ -0,0 +1,156 @@
+#include "controller_blocks.hpp"
+
+#include <meta_constants.hpp>
+#include <meta_test.hpp>
+
+#include <iostream>
+#include <random>
+
+using namespace metahash;
+using test::check;
+
+namespace {
+
+// больше BLOCKS_INDEX_INITIAL_SIZE, чтобы индекс вырос под читателями
+const uint64_t BLOCK_COUNT = BLOCKS_INDEX_INITIAL_SIZE + BLOCKS_INDEX_INITIAL_SIZE / 2;
+const uint64_t WINDOW = 100;
+const uint64_t READER_COUNT = 3;
+
+std::vector<std::atomic<bool>> freed(BLOCK_COUNT + 1);
+
+sha256_2 hash_of(uint64_t id)
+{
+    sha256_2 hash;
+    std::mt19937_64 rng(id);
+    for (auto& byte : hash) {
+        byte = rng();
+    }
+    return hash;
+}
+
+// блок без данных: хеши задаются номером, удаление отмечается в freed
+class TestBlock : public block::Block {
+public:
+    const uint64_t id;
+
+    explicit TestBlock(uint64_t id)
+        : id(id)
+    {
+    }
+
+    ~TestBlock() override
+    {
+        freed[id] = true;
+    }
+
+    sha256_2 get_block_hash() const override
+    {
+        return hash_of(id + 1);
+    }
+
+    sha256_2 get_prev_hash() const override
+    {
+        return hash_of(id);
+    }
+
+    bool parse(std::string_view) override
+    {
+        return false;
+    }
+};
+
+}
+
+int main()
+{
+    meta_core::Blocks blocks;
+
+    std::atomic<uint64_t> published = 0;
+    std::atomic<bool> stop = false;
+    std::atomic<uint64_t> hits = 0;
+    std::atomic<uint64_t> wrong_block = 0;
+    std::atomic<uint64_t> use_after_free = 0;
+
+    std::vector<std::thread> readers;
+    for (uint64_t r = 0; r < READER_COUNT; r++) {
+        readers.emplace_back([&, r] {
+            std::mt19937_64 rng(r);
+            uint64_t local_hits = 0;
+            while (!stop) {
+                uint64_t count = published.load();
+                if (!count) {
+                    continue;
+                }
+                // половина запросов приходится на блоки, которые писатель как раз снимает
+                uint64_t id = count - 1 - rng() % std::min(count, WINDOW * 2);
+
+                auto reader = blocks.read();
+                auto* block = static_cast<TestBlock*>(reader.get(hash_of(id + 1)));
+                if (!block) {
+                    continue;
+                }
+                // erase снимает блок из двух таблиц по очереди, так что get_next может его уже не найти
+                auto* next = reader.get_next(hash_of(id));
+                if (block->id != id || (next && next != block)) {
+                    wrong_block++;
+                }
+                // блок мог быть снят сразу после поиска, но удалён быть не может, пока жив reader
+                for (uint64_t spin = 0; spin < 64; spin++) {
+                    if (freed[block->id]) {
+                        use_after_free++;
+                        break;
+                    }
+                }
+                local_hits++;
+            }
+            hits += local_hits;
+        });
+    }
+
+    for (uint64_t id = 0; id < BLOCK_COUNT; id++) {
+        blocks.insert(new TestBlock(id));
+        published = id + 1;
+        if (id >= WINDOW) {
+            blocks.erase(hash_of(id - WINDOW + 1));
+        }
+    }
+
+    stop = true;
+    for (auto& thread : readers) {
+        thread.join();
+    }
+
+    check(wrong_block == 0, "reader got a wrong block");
+    check(use_after_free == 0, "block freed while a reader held it");
+    check(hits > 0, "readers found no blocks");
+
+    check(blocks.count == WINDOW, "count after erase: " + std::to_string(blocks.count));
+    for (uint64_t id = 0; id < BLOCK_COUNT; id++) {
+        bool expected = id >= BLOCK_COUNT - WINDOW;
+        check(blocks.contains(hash_of(id + 1)) == expected, "block " + std::to_string(id) + " presence by hash");
+        check(blocks.contains_next(hash_of(id)) == expected, "block " + std::to_string(id) + " presence by prev");
+    }
+
+    // повтор уже известного блока удаляется сразу, индекс не меняется
+    auto* duplicate = new TestBlock(BLOCK_COUNT - 1);
+    blocks.insert(duplicate);
+    check(freed[BLOCK_COUNT - 1], "duplicate block was not deleted");
+    freed[BLOCK_COUNT - 1] = false;
+    check(blocks.count == WINDOW && blocks.contains(hash_of(BLOCK_COUNT)), "duplicate block changed the index");
+
+    // без читателей всё снятое удаляется за две смены эпохи
+    blocks.epoch.reclaim();
+    blocks.epoch.reclaim();
+    uint64_t freed_count = 0;
+    for (uint64_t id = 0; id < BLOCK_COUNT; id++) {
+        freed_count += freed[id];
+    }
+    check(freed_count == BLOCK_COUNT - WINDOW, "erased blocks were not reclaimed: " + std::to_string(freed_count));
+
+    for (uint64_t id = BLOCK_COUNT - WINDOW; id < BLOCK_COUNT; id++) {
+        blocks.erase(hash_of(id + 1));
+    }
+
+    std::cout << "hits=" << hits << std::endl;
+    return test::result();
+}
@@ -40,6 +40,61 @@ private:
 
 using sha256_2 = std::array<unsigned char, 32>;
 
+// Двойной SHA-256 по частям: данные подаются по мере записи, результат совпадает с get_sha256
+class Sha256Stream {
+private:
+    EVP_MD_CTX* md;
+
+public:
+    Sha256Stream();
+    Sha256Stream(const Sha256Stream&) = delete;
+    Sha256Stream& operator=(const Sha256Stream&) = delete;
+    ~Sha256Stream();
+
+    void update(const char* data, uint64_t size);
+    sha256_2 finish();
+};
+
+// Последовательная запись в буфер: varint и блоки данных добавляются одной вставкой
+class ByteWriter {
+private:
+    std::vector<char>& buff;
+
+public:
+    explicit ByteWriter(std::vector<char>& buff);
+
+    void reserve(uint64_t size);
+
+    void write(const void* data, uint64_t size);
+    void write_varint(uint64_t value);
+
+    template <typename Container>
+    void write(const Container& data);
+    template <typename Container>
+    void write_frame(const Container& data);
+};
+
+// Чтение с проверкой границ; при ошибке позиция не сдвигается
+class ByteReader {
+private:
+    const char* data;
+    uint64_t size;
+    uint64_t offset;
+
+public:
+    explicit ByteReader(std::string_view sw, uint64_t offset = 0);
+
+    uint64_t position() const;
+    uint64_t remaining() const;
+
+    bool read(std::string_view& sw, uint64_t sw_size);
+    bool read_varint(uint64_t& value);
+
+    // Запись с длиной в varint; пустая запись - признак конца списка
+    bool read_frame(std::string_view& frame);
+    bool read_frames(std::vector<std::string_view>& frames);
+};
+
 std::vector<std::string> split(const std::string& s, char delim);
 
 std::vector<unsigned char> hex2bin(const std::string_view src);
@@ -57,6 +112,8 @@ template <typename Message>
 uint8_t read_varint(uint64_t& varint, const Message& data);
 
 std::vector<unsigned char> int_as_varint_array(uint64_t value);
+uint64_t get_varint_size(uint64_t value);
+uint8_t encode_varint(uint64_t value, char* dest);
 
 template <typename Message>
 uint64_t append_varint(Message& data, uint64_t value);
@@ -66,6 +123,10 @@ uint64_t get_xxhash64(const Message& data);
 
 template <typename Message>
 sha256_2 get_sha256(const Message& data);
+
+// Двойной SHA-256 для набора независимых сообщений, результат совпадает с get_sha256 по каждому
+void get_sha256_batch(const std::vector<std::string_view>& messages, std::vector<sha256_2>& hashes);
+
 template <typename DataContainer>
 bool CheckBufferSignature(EVP_PKEY* publicKey, const DataContainer& data, ECDSA_SIG* signature);
 
@@ -78,6 +139,9 @@ EVP_PKEY* ReadPublicKey(const PubKContainer& binpubk);
 template <typename PrivKContainer>
 EVP_PKEY* ReadPrivateKey(const PrivKContainer& binprivk);
 
+// Ключам, которые часто подписывают, строится таблица кратных точек; остальные проверяет OpenSSL
+bool verify_sign(std::string_view data, std::string_view sign, std::string_view pubk);
+
 template <typename DataContainer, typename SignContainer, typename PubKContainer>
 bool check_sign(const DataContainer& data, const SignContainer& sign, const PubKContainer& pubk);
 
@@ -86,31 +86,25 @@ uint8_t read_varint(uint64_t& varint, const Message& data)
 template <typename Message>
 uint64_t append_varint(Message& data, uint64_t value)
 {
-    std::string_view p_int(reinterpret_cast<char*>(&value), sizeof(value));
-
-    uint64_t written = 0;
-
-    std::vector<unsigned char> ret_data;
-    if (value < 0xfa) {
-        data.insert(data.end(), p_int.begin(), p_int.begin() + 1);
-        written = 1;
-    } else if (value <= 0xffff) {
-        data.insert(data.end(), &BYTED_2, &BYTED_2 + 1);
-        data.insert(data.end(), p_int.begin(), p_int.begin() + 2);
-        written = 3;
-    } else if (value <= 0xffffffff) {
-        data.insert(data.end(), &BYTED_4, &BYTED_4 + 1);
-        data.insert(data.end(), p_int.begin(), p_int.begin() + 4);
-        written = 5;
-    } else {
-        data.insert(data.end(), &BYTED_8, &BYTED_8 + 1);
-        data.insert(data.end(), p_int.begin(), p_int.begin() + 8);
-        written = 9;
-    }
-
+    char buff[9];
+    uint8_t written = encode_varint(value, buff);
+    data.insert(data.end(), buff, buff + written);
     return written;
 }
 
+template <typename Container>
+void ByteWriter::write(const Container& data)
+{
+    write(data.data(), data.size());
+}
+
+template <typename Container>
+void ByteWriter::write_frame(const Container& data)
+{
+    write_varint(data.size());
+    write(data.data(), data.size());
+}
+
 template <typename Message>
 uint64_t get_xxhash64(const Message& data)
 {
@@ -165,28 +159,10 @@ EVP_PKEY* ReadPrivateKey(const PrivKContainer& binprivk)
 template <typename DataContainer, typename SignContainer, typename PubKContainer>
 bool check_sign(const DataContainer& data, const SignContainer& sign, const PubKContainer& pubk)
 {
-    EVP_PKEY* pubkey = ReadPublicKey(pubk);
-    if (!pubkey) {
-        return false;
-    }
-    ECDSA_SIG* signature = ReadSignature(sign);
-    if (!signature) {
-        EVP_PKEY_free(pubkey);
-        return false;
-    }
-
-    std::vector<char> data_as_vector;
-    data_as_vector.insert(data_as_vector.end(), data.begin(), data.end());
-
-    if (CheckBufferSignature(pubkey, data_as_vector, signature)) {
-        EVP_PKEY_free(pubkey);
-        ECDSA_SIG_free(signature);
-        return true;
-    }
-
-    EVP_PKEY_free(pubkey);
-    ECDSA_SIG_free(signature);
-    return false;
+    return verify_sign(
+        std::string_view(reinterpret_cast<const char*>(data.data()), data.size()),
+        std::string_view(reinterpret_cast<const char*>(sign.data()), sign.size()),
+        std::string_view(reinterpret_cast<const char*>(pubk.data()), pubk.size()));
 }
 
 std::array<char, 25> make_address(std::vector<unsigned char>& bpubk);
@@ -0,0 +1,106 @@
+#include "meta_crypto.h"
+
+#include <cstring>
+
+namespace metahash::crypto {
+
+uint8_t encode_varint(uint64_t value, char* dest)
+{
+    if (value < BYTED_2) {
+        dest[0] = static_cast<char>(value);
+        return 1;
+    } else if (value <= 0xffff) {
+        dest[0] = static_cast<char>(BYTED_2);
+        std::memcpy(dest + 1, &value, 2);
+        return 3;
+    } else if (value <= 0xffffffff) {
+        dest[0] = static_cast<char>(BYTED_4);
+        std::memcpy(dest + 1, &value, 4);
+        return 5;
+    }
+    dest[0] = static_cast<char>(BYTED_8);
+    std::memcpy(dest + 1, &value, 8);
+    return 9;
+}
+
+ByteWriter::ByteWriter(std::vector<char>& buff)
+    : buff(buff)
+{
+}
+
+void ByteWriter::reserve(uint64_t size)
+{
+    buff.reserve(buff.size() + size);
+}
+
+void ByteWriter::write(const void* data, uint64_t size)
+{
+    const auto* begin = static_cast<const char*>(data);
+    buff.insert(buff.end(), begin, begin + size);
+}
+
+void ByteWriter::write_varint(uint64_t value)
+{
+    char varint[9];
+    uint8_t written = encode_varint(value, varint);
+    buff.insert(buff.end(), varint, varint + written);
+}
+
+ByteReader::ByteReader(std::string_view sw, uint64_t offset)
+    : data(sw.data())
+    , size(sw.size())
+    , offset(offset < sw.size() ? offset : sw.size())
+{
+}
+
+uint64_t ByteReader::position() const
+{
+    return offset;
+}
+
+uint64_t ByteReader::remaining() const
+{
+    return size - offset;
+}
+
+bool ByteReader::read(std::string_view& sw, uint64_t sw_size)
+{
+    if (sw_size > size - offset) {
+        return false;
+    }
+    sw = std::string_view(data + offset, sw_size);
+    offset += sw_size;
+    return true;
+}
+
+bool ByteReader::read_varint(uint64_t& value)
+{
+    uint8_t varint_size = crypto::read_varint(value, data + offset, size - offset);
+    offset += varint_size;
+    return varint_size > 0;
+}
+
+bool ByteReader::read_frame(std::string_view& frame)
+{
+    uint64_t start = offset;
+    uint64_t frame_size = 0;
+    if (!read_varint(frame_size) || !read(frame, frame_size)) {
+        offset = start;
+        return false;
+    }
+    return true;
+}
+
+bool ByteReader::read_frames(std::vector<std::string_view>& frames)
+{
+    std::string_view frame;
+    while (read_frame(frame)) {
+        if (frame.empty()) {
+            return true;
+        }
+        frames.push_back(frame);
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,195 @@
+#include "hex_codec.hpp"
+#include "meta_crypto.h"
+
+#include <immintrin.h>
+
+namespace metahash::crypto {
+
+namespace {
+
+    const char HexDigits[] = "0123456789abcdef";
+
+    // символы вне 0-9, a-f, A-F дают ноль, как в прежней таблице
+    unsigned char hex_value(unsigned char c)
+    {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        c |= 0x20;
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        return 0;
+    }
+
+    // 128-битные циклы встраиваются и в AVX2-версии, чтобы хвост не уходил в SSE-код без VEX
+    __attribute__((target("sse4.1"), always_inline)) inline uint64_t encode_blocks_sse4(const unsigned char* src, uint64_t size, char* dest)
+    {
+        const __m128i lut = _mm_loadu_si128(reinterpret_cast<const __m128i*>(HexDigits));
+        const __m128i mask = _mm_set1_epi8(0x0f);
+
+        uint64_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+            __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(bytes, mask));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 2 * i), _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+        }
+        return i;
+    }
+
+    __attribute__((target("sse4.1"), always_inline)) inline uint64_t decode_blocks_sse4(const char* src, uint64_t size, unsigned char* dest)
+    {
+        const __m128i weights = _mm_set1_epi16(0x0110);
+
+        uint64_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+            const __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+            const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+            const __m128i alpha = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+            const __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+            const __m128i values = _mm_or_si128(_mm_and_si128(is_digit, digit), _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+
+            __m128i pairs = _mm_maddubs_epi16(values, weights);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(pairs, pairs));
+        }
+        return i;
+    }
+
+}
+
+namespace hex_kernels {
+
+    void encode_scalar(const unsigned char* src, uint64_t size, char* dest)
+    {
+        for (uint64_t i = 0; i < size; i++) {
+            dest[2 * i] = HexDigits[src[i] >> 4];
+            dest[2 * i + 1] = HexDigits[src[i] & 0x0f];
+        }
+    }
+
+    void decode_scalar(const char* src, uint64_t size, unsigned char* dest)
+    {
+        for (uint64_t i = 0; i < size; i++) {
+            dest[i] = (hex_value(src[2 * i]) << 4) | hex_value(src[2 * i + 1]);
+        }
+    }
+
+    __attribute__((target("sse4.1"))) void encode_sse4(const unsigned char* src, uint64_t size, char* dest)
+    {
+        uint64_t i = encode_blocks_sse4(src, size, dest);
+        encode_scalar(src + i, size - i, dest + 2 * i);
+    }
+
+    __attribute__((target("sse4.1"))) void decode_sse4(const char* src, uint64_t size, unsigned char* dest)
+    {
+        uint64_t i = decode_blocks_sse4(src, size, dest);
+        decode_scalar(src + 2 * i, size - i, dest + i);
+    }
+
+    __attribute__((target("avx2"))) void encode_avx2(const unsigned char* src, uint64_t size, char* dest)
+    {
+        const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(HexDigits)));
+        const __m256i mask = _mm256_set1_epi8(0x0f);
+
+        uint64_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask));
+            __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(bytes, mask));
+            __m256i first = _mm256_unpacklo_epi8(hi, lo);
+            __m256i second = _mm256_unpackhi_epi8(hi, lo);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 2 * i), _mm256_permute2x128_si256(first, second, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 2 * i + 32), _mm256_permute2x128_si256(first, second, 0x31));
+        }
+        i += encode_blocks_sse4(src + i, size - i, dest + 2 * i);
+        encode_scalar(src + i, size - i, dest + 2 * i);
+    }
+
+    __attribute__((target("avx2"))) void decode_avx2(const char* src, uint64_t size, unsigned char* dest)
+    {
+        const __m256i weights = _mm256_set1_epi16(0x0110);
+
+        uint64_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i));
+            const __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+            const __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+            const __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+            const __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+            const __m256i values = _mm256_or_si256(_mm256_and_si256(is_digit, digit), _mm256_and_si256(is_alpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+
+            __m256i pairs = _mm256_maddubs_epi16(values, weights);
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(pairs, pairs), 0x08);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm256_castsi256_si128(packed));
+        }
+        i += decode_blocks_sse4(src + 2 * i, size - i, dest + i);
+        decode_scalar(src + 2 * i, size - i, dest + i);
+    }
+
+}
+
+namespace {
+
+    using EncodeFunction = void (*)(const unsigned char*, uint64_t, char*);
+    using DecodeFunction = void (*)(const char*, uint64_t, unsigned char*);
+
+    // набор инструкций выбирается один раз по возможностям процессора
+    EncodeFunction get_encode()
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return hex_kernels::encode_avx2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return hex_kernels::encode_sse4;
+        }
+        return hex_kernels::encode_scalar;
+    }
+
+    DecodeFunction get_decode()
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return hex_kernels::decode_avx2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return hex_kernels::decode_sse4;
+        }
+        return hex_kernels::decode_scalar;
+    }
+
+}
+
+std::string bin2hex(const unsigned char* data, uint64_t size)
+{
+    static const EncodeFunction encode = get_encode();
+
+    std::string res(size * 2, '\0');
+    encode(data, size, res.data());
+    return res;
+}
+
+std::vector<unsigned char> hex2bin(const std::string_view src)
+{
+    static const DecodeFunction decode = get_decode();
+
+    uint64_t i = 0;
+    if (src.size() > 2 && src[0] == '0' && src[1] == 'x') {
+        i = 2;
+    }
+
+    uint64_t digits = src.size() - i;
+    std::vector<unsigned char> dest(digits / 2 + digits % 2);
+    decode(src.data() + i, digits / 2, dest.data());
+    if (digits % 2) {
+        // непарная последняя цифра - старший полубайт
+        dest.back() = hex_value(src.back()) << 4;
+    }
+
+    return dest;
+}
+
+}
@@ -0,0 +1,19 @@
+#ifndef HEX_CODEC_HPP
+#define HEX_CODEC_HPP
+
+#include <cstdint>
+
+namespace metahash::crypto::hex_kernels {
+
+// Реализации bin2hex и hex2bin: size - число байт, src декодера без префикса "0x".
+// SSE и AVX2 вызывать только если процессор поддерживает нужные расширения
+void encode_scalar(const unsigned char* src, uint64_t size, char* dest);
+void decode_scalar(const char* src, uint64_t size, unsigned char* dest);
+__attribute__((target("sse4.1"))) void encode_sse4(const unsigned char* src, uint64_t size, char* dest);
+__attribute__((target("sse4.1"))) void decode_sse4(const char* src, uint64_t size, unsigned char* dest);
+__attribute__((target("avx2"))) void encode_avx2(const unsigned char* src, uint64_t size, char* dest);
+__attribute__((target("avx2"))) void decode_avx2(const char* src, uint64_t size, unsigned char* dest);
+
+}
+
+#endif // HEX_CODEC_HPP
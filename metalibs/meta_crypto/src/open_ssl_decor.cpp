@@ -2,38 +2,6 @@
 
 namespace metahash::crypto {
 
-std::string bin2hex(const unsigned char* data, uint64_t size)
-{
-    static const char HexLookup[513] = {
-        "000102030405060708090a0b0c0d0e0f"
-        "101112131415161718191a1b1c1d1e1f"
-        "202122232425262728292a2b2c2d2e2f"
-        "303132333435363738393a3b3c3d3e3f"
-        "404142434445464748494a4b4c4d4e4f"
-        "505152535455565758595a5b5c5d5e5f"
-        "606162636465666768696a6b6c6d6e6f"
-        "707172737475767778797a7b7c7d7e7f"
-        "808182838485868788898a8b8c8d8e8f"
-        "909192939495969798999a9b9c9d9e9f"
-        "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
-        "b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
-        "c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
-        "d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
-        "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
-        "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff"
-    };
-
-    std::string res;
-    res.reserve(size * 2 + 1);
-
-    for (uint i = 0; i < size; i++) {
-        const char* hex = &HexLookup[2 * (static_cast<unsigned char>(data[i]))];
-        res.insert(res.end(), hex, hex + 2);
-    }
-
-    return res;
-}
-
 uint8_t read_varint(uint64_t& varint, const char* data, uint64_t size)
 {
     if (size < 1)
@@ -89,35 +57,44 @@ std::vector<unsigned char> int_as_varint_array(uint64_t value)
     return ret_data;
 }
 
-std::vector<unsigned char> hex2bin(const std::string_view src)
+uint64_t get_varint_size(uint64_t value)
 {
-    static const std::array<unsigned char, 256> DecLookup = {
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // gap before first hex digit
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-        0, 1, 2, 3, 4, 5, 6, 7, 8, 9, // 0123456789
-        0, 0, 0, 0, 0, 0, 0, // :;<=>?@ (gap)
-        10, 11, 12, 13, 14, 15, // ABCDEF
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // GHIJKLMNOPQRS (gap)
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // TUVWXYZ[/]^_` (gap)
-        10, 11, 12, 13, 14, 15, // abcdef
-        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 // fill zeroes
-    };
-
-    uint i = 0;
-    if (src.size() > 2 && src[0] == '0' && src[1] == 'x') {
-        i = 2;
+    if (value < 0xfa) {
+        return 1;
+    } else if (value <= 0xffff) {
+        return 3;
+    } else if (value <= 0xffffffff) {
+        return 5;
     }
+    return 9;
+}
 
-    std::vector<unsigned char> dest;
-    dest.reserve(src.length() / 2);
-    for (; i < src.length(); i += 2) {
-        unsigned char d = DecLookup.at((unsigned char)src[i]) << 4;
-        d |= DecLookup.at((unsigned char)src[i + 1]);
-        dest.push_back(d);
-    }
+Sha256Stream::Sha256Stream()
+    : md(EVP_MD_CTX_create())
+{
+    EVP_DigestInit_ex(md, EVP_sha256(), nullptr);
+}
+
+Sha256Stream::~Sha256Stream()
+{
+    EVP_MD_CTX_destroy(md);
+}
+
+void Sha256Stream::update(const char* data, uint64_t size)
+{
+    EVP_DigestUpdate(md, data, size);
+}
+
+sha256_2 Sha256Stream::finish()
+{
+    sha256_2 hash1;
+    sha256_2 hash2;
+
+    EVP_DigestFinal_ex(md, hash1.data(), nullptr);
+    SHA256(hash1.data(), hash1.size(), hash2.data());
 
-    return dest;
+    EVP_DigestInit_ex(md, EVP_sha256(), nullptr);
+    return hash2;
 }
 
 const std::vector<char>& Signer::get_pub_key()
@@ -0,0 +1,374 @@
+#include "meta_crypto.h"
+#include "sha256_batch.hpp"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace metahash::crypto {
+
+namespace {
+
+    const uint32_t K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    const uint32_t H0[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+    // Сообщение, разбитое на блоки по 64 байта с паддингом SHA-256
+    struct Padded {
+        const unsigned char* data;
+        uint64_t size;
+        uint64_t blocks;
+        unsigned char tail[128];
+
+        void init(std::string_view message)
+        {
+            data = reinterpret_cast<const unsigned char*>(message.data());
+            size = message.size();
+            blocks = (size + 9 + 63) / 64;
+
+            uint64_t full = size / 64;
+            uint64_t rest = size - full * 64;
+            std::memset(tail, 0, sizeof(tail));
+            std::memcpy(tail, data + full * 64, rest);
+            tail[rest] = 0x80;
+            uint64_t bits = size * 8;
+            unsigned char* len = tail + (blocks - full) * 64 - 8;
+            for (int i = 0; i < 8; i++) {
+                len[i] = static_cast<unsigned char>(bits >> (56 - 8 * i));
+            }
+        }
+
+        const unsigned char* block(uint64_t index) const
+        {
+            uint64_t full = size / 64;
+            return index < full ? data + index * 64 : tail + (index - full) * 64;
+        }
+    };
+
+    // Второй проход двойного хеша - всегда один блок из 32 байт
+    void make_second_block(const unsigned char* hash, unsigned char* block)
+    {
+        std::memcpy(block, hash, 32);
+        std::memset(block + 32, 0, 32);
+        block[32] = 0x80;
+        block[62] = 0x01;
+    }
+
+    void store_state(const uint32_t* state, unsigned char* out)
+    {
+        for (int i = 0; i < 8; i++) {
+            out[4 * i] = static_cast<unsigned char>(state[i] >> 24);
+            out[4 * i + 1] = static_cast<unsigned char>(state[i] >> 16);
+            out[4 * i + 2] = static_cast<unsigned char>(state[i] >> 8);
+            out[4 * i + 3] = static_cast<unsigned char>(state[i]);
+        }
+    }
+
+    __attribute__((target("sha,sse4.1"))) void compress_shani(uint32_t* state, const unsigned char* block)
+    {
+        const __m128i shuffle_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+        __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0]));
+        __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4]));
+        tmp = _mm_shuffle_epi32(tmp, 0xB1);
+        state1 = _mm_shuffle_epi32(state1, 0x1B);
+        __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+        state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+        const __m128i abef_save = state0;
+        const __m128i cdgh_save = state1;
+
+        __m128i msg[4];
+        for (int i = 0; i < 4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i)), shuffle_mask);
+        }
+
+        for (int i = 0; i < 16; i++) {
+            __m128i m = msg[i & 3];
+            __m128i wk = _mm_add_epi32(m, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&K[4 * i])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+            wk = _mm_shuffle_epi32(wk, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, wk);
+
+            if (i < 12) {
+                // расписание следующих четырёх слов
+                __m128i next = _mm_sha256msg1_epu32(msg[i & 3], msg[(i + 1) & 3]);
+                next = _mm_add_epi32(next, _mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4));
+                msg[i & 3] = _mm_sha256msg2_epu32(next, msg[(i + 3) & 3]);
+            }
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+
+        tmp = _mm_shuffle_epi32(state0, 0x1B);
+        state1 = _mm_shuffle_epi32(state1, 0xB1);
+        state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+        state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+    }
+
+    __attribute__((target("sha,sse4.1"))) void hash_shani(std::string_view message, sha256_2& hash)
+    {
+        Padded padded;
+        padded.init(message);
+
+        uint32_t state[8];
+        std::copy(H0, H0 + 8, state);
+        for (uint64_t i = 0; i < padded.blocks; i++) {
+            compress_shani(state, padded.block(i));
+        }
+
+        unsigned char first[32];
+        unsigned char block[64];
+        store_state(state, first);
+        make_second_block(first, block);
+        std::copy(H0, H0 + 8, state);
+        compress_shani(state, block);
+        store_state(state, hash.data());
+    }
+
+#define ROTR8(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+
+    __attribute__((target("avx2"))) inline void transpose_8x8(__m256i* r)
+    {
+        __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+        __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+        __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+        __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+        __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+        __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+        __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+        __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+
+        __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+        __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+        __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+        __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+        __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+        __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+        __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+        __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+        r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+        r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+        r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+        r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+        r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+        r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+        r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+        r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+    }
+
+    // Восемь независимых блоков за раз: в каждой 32-битной ячейке своё сообщение
+    __attribute__((target("avx2"))) void compress_avx2_x8(__m256i* state, const unsigned char* const* blocks)
+    {
+        const __m256i bswap = _mm256_set_epi8(
+            12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+            12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+        __m256i w[16];
+        for (int half = 0; half < 2; half++) {
+            for (int lane = 0; lane < 8; lane++) {
+                w[8 * half + lane] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks[lane] + 32 * half)), bswap);
+            }
+            transpose_8x8(&w[8 * half]);
+        }
+
+        __m256i a = state[0], b = state[1], c = state[2], d = state[3];
+        __m256i e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int i = 0; i < 64; i++) {
+            __m256i wi;
+            if (i < 16) {
+                wi = w[i];
+            } else {
+                __m256i w15 = w[(i - 15) & 15];
+                __m256i w2 = w[(i - 2) & 15];
+                __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(w15, 7), ROTR8(w15, 18)), _mm256_srli_epi32(w15, 3));
+                __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(w2, 17), ROTR8(w2, 19)), _mm256_srli_epi32(w2, 10));
+                wi = _mm256_add_epi32(_mm256_add_epi32(w[i & 15], s0), _mm256_add_epi32(w[(i - 7) & 15], s1));
+                w[i & 15] = wi;
+            }
+
+            __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(e, 6), ROTR8(e, 11)), ROTR8(e, 25));
+            __m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+            __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, s1), _mm256_add_epi32(ch, _mm256_add_epi32(_mm256_set1_epi32(K[i]), wi)));
+            __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(ROTR8(a, 2), ROTR8(a, 13)), ROTR8(a, 22));
+            __m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+            __m256i t2 = _mm256_add_epi32(s0, maj);
+
+            h = g;
+            g = f;
+            f = e;
+            e = _mm256_add_epi32(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = _mm256_add_epi32(t1, t2);
+        }
+
+        state[0] = _mm256_add_epi32(state[0], a);
+        state[1] = _mm256_add_epi32(state[1], b);
+        state[2] = _mm256_add_epi32(state[2], c);
+        state[3] = _mm256_add_epi32(state[3], d);
+        state[4] = _mm256_add_epi32(state[4], e);
+        state[5] = _mm256_add_epi32(state[5], f);
+        state[6] = _mm256_add_epi32(state[6], g);
+        state[7] = _mm256_add_epi32(state[7], h);
+    }
+
+#undef ROTR8
+
+    // Группа до восьми сообщений; сообщения отсортированы по числу блоков, поэтому
+    // завершившиеся раньше дорожки просто перестают обновлять своё состояние
+    __attribute__((target("avx2"))) void hash_group_avx2(const Padded* padded, uint64_t count, sha256_2* const* hashes)
+    {
+        static const unsigned char idle_block[64] = { 0 };
+
+        __m256i state[8];
+        for (int i = 0; i < 8; i++) {
+            state[i] = _mm256_set1_epi32(static_cast<int>(H0[i]));
+        }
+
+        uint64_t max_blocks = 0;
+        for (uint64_t lane = 0; lane < count; lane++) {
+            max_blocks = std::max(max_blocks, padded[lane].blocks);
+        }
+
+        const unsigned char* blocks[8];
+        for (uint64_t index = 0; index < max_blocks; index++) {
+            alignas(32) uint32_t active[8];
+            for (uint64_t lane = 0; lane < 8; lane++) {
+                bool live = lane < count && index < padded[lane].blocks;
+                blocks[lane] = live ? padded[lane].block(index) : idle_block;
+                active[lane] = live ? 0xffffffff : 0;
+            }
+
+            __m256i saved[8];
+            std::copy(state, state + 8, saved);
+            compress_avx2_x8(state, blocks);
+
+            __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i*>(active));
+            for (int i = 0; i < 8; i++) {
+                state[i] = _mm256_blendv_epi8(saved[i], state[i], mask);
+            }
+        }
+
+        // второй проход: 32 байта первого хеша в одном блоке
+        alignas(32) uint32_t words[8][8];
+        for (int i = 0; i < 8; i++) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(words[i]), state[i]);
+        }
+
+        unsigned char second[8][64];
+        for (uint64_t lane = 0; lane < 8; lane++) {
+            uint32_t first[8];
+            for (int i = 0; i < 8; i++) {
+                first[i] = words[i][lane];
+            }
+            unsigned char hash[32];
+            store_state(first, hash);
+            make_second_block(hash, second[lane]);
+            blocks[lane] = second[lane];
+        }
+
+        for (int i = 0; i < 8; i++) {
+            state[i] = _mm256_set1_epi32(static_cast<int>(H0[i]));
+        }
+        compress_avx2_x8(state, blocks);
+
+        for (int i = 0; i < 8; i++) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(words[i]), state[i]);
+        }
+        for (uint64_t lane = 0; lane < count; lane++) {
+            uint32_t result[8];
+            for (int i = 0; i < 8; i++) {
+                result[i] = words[i][lane];
+            }
+            store_state(result, hashes[lane]->data());
+        }
+    }
+
+}
+
+namespace sha256_kernels {
+
+    __attribute__((target("avx2"))) void hash_batch_avx2(const std::vector<std::string_view>& messages, std::vector<sha256_2>& hashes)
+    {
+        std::vector<uint64_t> order(messages.size());
+        for (uint64_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&messages](uint64_t lh, uint64_t rh) {
+            return messages[lh].size() < messages[rh].size();
+        });
+
+        Padded padded[8];
+        sha256_2* outs[8];
+        for (uint64_t start = 0; start < order.size(); start += 8) {
+            uint64_t count = std::min<uint64_t>(8, order.size() - start);
+            for (uint64_t lane = 0; lane < count; lane++) {
+                padded[lane].init(messages[order[start + lane]]);
+                outs[lane] = &hashes[order[start + lane]];
+            }
+            hash_group_avx2(padded, count, outs);
+        }
+    }
+
+    void hash_batch_shani(const std::vector<std::string_view>& messages, std::vector<sha256_2>& hashes)
+    {
+        for (uint64_t i = 0; i < messages.size(); i++) {
+            hash_shani(messages[i], hashes[i]);
+        }
+    }
+
+    void hash_batch_openssl(const std::vector<std::string_view>& messages, std::vector<sha256_2>& hashes)
+    {
+        for (uint64_t i = 0; i < messages.size(); i++) {
+            hashes[i] = get_sha256(messages[i]);
+        }
+    }
+
+}
+
+namespace {
+
+    using BatchFunction = void (*)(const std::vector<std::string_view>&, std::vector<sha256_2>&);
+
+    // SHA-NI считает одно сообщение быстрее восьми дорожек AVX2, без расширений остаётся OpenSSL
+    BatchFunction get_batch()
+    {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1")) {
+            return sha256_kernels::hash_batch_shani;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return sha256_kernels::hash_batch_avx2;
+        }
+        return sha256_kernels::hash_batch_openssl;
+    }
+
+}
+
+void get_sha256_batch(const std::vector<std::string_view>& messages, std::vector<sha256_2>& hashes)
+{
+    static const BatchFunction hash_batch = get_batch();
+
+    hashes.resize(messages.size());
+    hash_batch(messages, hashes);
+}
+
+}
@@ -0,0 +1,15 @@
+#ifndef SHA256_BATCH_HPP
+#define SHA256_BATCH_HPP
+
+#include "meta_crypto.h"
+
+namespace metahash::crypto::sha256_kernels {
+
+// Реализации get_sha256_batch; вызывать только если процессор поддерживает нужные расширения
+__attribute__((target("avx2"))) void hash_batch_avx2(const std::vector<std::string_view>& messages, std::vector<sha256_2>& hashes);
+void hash_batch_shani(const std::vector<std::string_view>& messages, std::vector<sha256_2>& hashes);
+void hash_batch_openssl(const std::vector<std::string_view>& messages, std::vector<sha256_2>& hashes);
+
+}
+
+#endif // SHA256_BATCH_HPP
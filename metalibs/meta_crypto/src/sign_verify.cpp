@@ -0,0 +1,630 @@
+#include "meta_crypto.h"
+
+#include <meta_constants.hpp>
+
+#include <openssl/bn.h>
+#include <openssl/ec.h>
+#include <openssl/obj_mac.h>
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
+
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace metahash::crypto {
+
+namespace {
+
+    // Элемент поля secp256k1, четыре 64-битных слова от младшего к старшему, всегда меньше p
+    struct Field {
+        uint64_t n[4];
+    };
+
+    const Field FIELD_P = { { 0xFFFFFFFEFFFFFC2FULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL } };
+    const Field FIELD_ONE = { { 1, 0, 0, 0 } };
+
+    // 2^256 mod p
+    const uint64_t FIELD_C = 0x1000003D1ULL;
+
+    using uint128_t = unsigned __int128;
+
+    bool field_is_zero(const Field& a)
+    {
+        return (a.n[0] | a.n[1] | a.n[2] | a.n[3]) == 0;
+    }
+
+    bool field_equal(const Field& a, const Field& b)
+    {
+        return a.n[0] == b.n[0] && a.n[1] == b.n[1] && a.n[2] == b.n[2] && a.n[3] == b.n[3];
+    }
+
+    // r = a - b по модулю 2^256, возвращает заём
+    uint64_t sub_256(const uint64_t* a, const uint64_t* b, uint64_t* r)
+    {
+        uint64_t borrow = 0;
+        for (int i = 0; i < 4; i++) {
+            uint128_t d = uint128_t(a[i]) - b[i] - borrow;
+            r[i] = uint64_t(d);
+            borrow = uint64_t(d >> 64) & 1;
+        }
+        return borrow;
+    }
+
+    Field field_add(const Field& a, const Field& b)
+    {
+        Field sum;
+        uint64_t carry = 0;
+        for (int i = 0; i < 4; i++) {
+            uint128_t s = uint128_t(a.n[i]) + b.n[i] + carry;
+            sum.n[i] = uint64_t(s);
+            carry = uint64_t(s >> 64);
+        }
+
+        Field reduced;
+        uint64_t borrow = sub_256(sum.n, FIELD_P.n, reduced.n);
+        return (carry || !borrow) ? reduced : sum;
+    }
+
+    Field field_sub(const Field& a, const Field& b)
+    {
+        Field diff;
+        if (sub_256(a.n, b.n, diff.n)) {
+            uint64_t carry = 0;
+            for (int i = 0; i < 4; i++) {
+                uint128_t s = uint128_t(diff.n[i]) + FIELD_P.n[i] + carry;
+                diff.n[i] = uint64_t(s);
+                carry = uint64_t(s >> 64);
+            }
+        }
+        return diff;
+    }
+
+    Field field_mul(const Field& a, const Field& b)
+    {
+        uint64_t t[8] = { 0 };
+        for (int i = 0; i < 4; i++) {
+            uint64_t carry = 0;
+            for (int j = 0; j < 4; j++) {
+                uint128_t acc = uint128_t(a.n[i]) * b.n[j] + t[i + j] + carry;
+                t[i + j] = uint64_t(acc);
+                carry = uint64_t(acc >> 64);
+            }
+            t[i + 4] = carry;
+        }
+
+        // старшая половина переносится вниз умножением на 2^256 mod p, дважды
+        Field r;
+        uint64_t carry = 0;
+        for (int i = 0; i < 4; i++) {
+            uint128_t acc = uint128_t(t[i + 4]) * FIELD_C + t[i] + carry;
+            r.n[i] = uint64_t(acc);
+            carry = uint64_t(acc >> 64);
+        }
+
+        uint128_t acc = uint128_t(carry) * FIELD_C + r.n[0];
+        r.n[0] = uint64_t(acc);
+        uint64_t top = uint64_t(acc >> 64);
+        for (int i = 1; i < 4; i++) {
+            acc = uint128_t(r.n[i]) + top;
+            r.n[i] = uint64_t(acc);
+            top = uint64_t(acc >> 64);
+        }
+        if (top) {
+            acc = uint128_t(r.n[0]) + FIELD_C;
+            r.n[0] = uint64_t(acc);
+            top = uint64_t(acc >> 64);
+            for (int i = 1; i < 4 && top; i++) {
+                acc = uint128_t(r.n[i]) + top;
+                r.n[i] = uint64_t(acc);
+                top = uint64_t(acc >> 64);
+            }
+        }
+
+        Field reduced;
+        return sub_256(r.n, FIELD_P.n, reduced.n) ? r : reduced;
+    }
+
+    Field field_sqr(const Field& a)
+    {
+        return field_mul(a, a);
+    }
+
+    // a^(p-2), нужно только при построении таблиц
+    Field field_inv(const Field& a)
+    {
+        Field exponent;
+        sub_256(FIELD_P.n, Field { { 2, 0, 0, 0 } }.n, exponent.n);
+
+        Field result = FIELD_ONE;
+        for (int i = 255; i >= 0; i--) {
+            result = field_sqr(result);
+            if ((exponent.n[i / 64] >> (i % 64)) & 1) {
+                result = field_mul(result, a);
+            }
+        }
+        return result;
+    }
+
+    Field field_from_bytes(const unsigned char* bytes)
+    {
+        Field a;
+        for (int i = 0; i < 4; i++) {
+            a.n[3 - i] = 0;
+            for (int j = 0; j < 8; j++) {
+                a.n[3 - i] = (a.n[3 - i] << 8) | bytes[8 * i + j];
+            }
+        }
+        return a;
+    }
+
+    struct Affine {
+        Field x;
+        Field y;
+    };
+
+    struct Jacobian {
+        Field x;
+        Field y;
+        Field z;
+        bool infinity;
+    };
+
+    Jacobian point_double(const Jacobian& p)
+    {
+        if (p.infinity || field_is_zero(p.y)) {
+            return Jacobian { {}, {}, {}, true };
+        }
+
+        // dbl-2009-l, a = 0
+        Field a = field_sqr(p.x);
+        Field b = field_sqr(p.y);
+        Field c = field_sqr(b);
+        Field d = field_sub(field_sub(field_sqr(field_add(p.x, b)), a), c);
+        d = field_add(d, d);
+        Field e = field_add(field_add(a, a), a);
+        Field f = field_sqr(e);
+
+        Jacobian r;
+        r.infinity = false;
+        r.x = field_sub(f, field_add(d, d));
+        Field c8 = field_add(c, c);
+        c8 = field_add(c8, c8);
+        c8 = field_add(c8, c8);
+        r.y = field_sub(field_mul(e, field_sub(d, r.x)), c8);
+        Field yz = field_mul(p.y, p.z);
+        r.z = field_add(yz, yz);
+        return r;
+    }
+
+    Jacobian point_add(const Jacobian& p, const Affine& q)
+    {
+        if (p.infinity) {
+            return Jacobian { q.x, q.y, FIELD_ONE, false };
+        }
+
+        // madd-2007-bl
+        Field z1z1 = field_sqr(p.z);
+        Field u2 = field_mul(q.x, z1z1);
+        Field s2 = field_mul(field_mul(q.y, p.z), z1z1);
+        Field h = field_sub(u2, p.x);
+        Field s = field_sub(s2, p.y);
+
+        if (field_is_zero(h)) {
+            if (field_is_zero(s)) {
+                return point_double(p);
+            }
+            return Jacobian { {}, {}, {}, true };
+        }
+
+        Field hh = field_sqr(h);
+        Field i = field_add(hh, hh);
+        i = field_add(i, i);
+        Field j = field_mul(h, i);
+        Field r = field_add(s, s);
+        Field v = field_mul(p.x, i);
+
+        Jacobian res;
+        res.infinity = false;
+        res.x = field_sub(field_sub(field_sqr(r), j), field_add(v, v));
+        Field y1j = field_mul(p.y, j);
+        res.y = field_sub(field_mul(r, field_sub(v, res.x)), field_add(y1j, y1j));
+        res.z = field_sub(field_sub(field_sqr(field_add(p.z, h)), z1z1), hh);
+        return res;
+    }
+
+    // Перевод строки таблицы в аффинные координаты одной инверсией
+    void to_affine(const std::vector<Jacobian>& points, Affine* out)
+    {
+        std::vector<Field> prefix(points.size());
+        Field acc = FIELD_ONE;
+        for (uint64_t i = 0; i < points.size(); i++) {
+            prefix[i] = acc;
+            acc = field_mul(acc, points[i].z);
+        }
+
+        Field inv = field_inv(acc);
+        for (uint64_t i = points.size(); i-- > 0;) {
+            Field z_inv = field_mul(inv, prefix[i]);
+            inv = field_mul(inv, points[i].z);
+
+            Field z_inv2 = field_sqr(z_inv);
+            out[i].x = field_mul(points[i].x, z_inv2);
+            out[i].y = field_mul(points[i].y, field_mul(z_inv2, z_inv));
+        }
+    }
+
+    // Кратные точки по окнам: rows[i][d - 1] = d * 2^(bits * i) * P
+    class PointTable {
+    private:
+        uint8_t bits;
+        std::vector<Affine> points;
+
+    public:
+        PointTable(const Affine& point, uint8_t window_bits)
+            : bits(window_bits)
+        {
+            const uint64_t row_size = (1u << bits) - 1;
+            const uint64_t row_count = (256 + bits - 1) / bits;
+            points.resize(row_size * row_count);
+
+            Affine base = point;
+            std::vector<Jacobian> row(row_size);
+            for (uint64_t i = 0; i < row_count; i++) {
+                row[0] = Jacobian { base.x, base.y, FIELD_ONE, false };
+                for (uint64_t d = 1; d < row_size; d++) {
+                    row[d] = point_add(row[d - 1], base);
+                }
+                to_affine(row, &points[i * row_size]);
+
+                std::vector<Jacobian> next = { point_double(row[row_size / 2]) };
+                to_affine(next, &base);
+            }
+        }
+
+        void add_multiple(Jacobian& acc, const uint64_t* scalar) const
+        {
+            const uint64_t row_size = (1u << bits) - 1;
+            const uint64_t row_count = (256 + bits - 1) / bits;
+            for (uint64_t i = 0; i < row_count; i++) {
+                // окно может пересекать границу слов, если его ширина не делит 64
+                uint64_t bit = i * bits;
+                uint64_t word = bit / 64;
+                uint64_t shift = bit % 64;
+                uint64_t digit = scalar[word] >> shift;
+                if (shift + bits > 64 && word + 1 < 4) {
+                    digit |= scalar[word + 1] << (64 - shift);
+                }
+                digit &= row_size;
+                if (digit) {
+                    acc = point_add(acc, points[i * row_size + digit - 1]);
+                }
+            }
+        }
+    };
+
+    struct Curve {
+        EC_GROUP* group;
+        BIGNUM* order;
+        BIGNUM* prime;
+        std::unique_ptr<PointTable> generator;
+
+        Curve()
+            : group(EC_GROUP_new_by_curve_name(NID_secp256k1))
+            , order(BN_new())
+            , prime(BN_new())
+        {
+            EC_GROUP_get_curve(group, prime, nullptr, nullptr, nullptr);
+            BN_copy(order, EC_GROUP_get0_order(group));
+
+            unsigned char bytes[32];
+            BIGNUM* x = BN_new();
+            BIGNUM* y = BN_new();
+            EC_POINT_get_affine_coordinates(group, EC_GROUP_get0_generator(group), x, y, nullptr);
+            Affine g;
+            BN_bn2binpad(x, bytes, 32);
+            g.x = field_from_bytes(bytes);
+            BN_bn2binpad(y, bytes, 32);
+            g.y = field_from_bytes(bytes);
+            BN_free(x);
+            BN_free(y);
+
+            generator = std::make_unique<PointTable>(g, SIGN_GENERATOR_WINDOW_BITS);
+        }
+    };
+
+    const Curve& get_curve()
+    {
+        static const Curve curve;
+        return curve;
+    }
+
+    void scalar_from_bn(const BIGNUM* bn, uint64_t* scalar)
+    {
+        unsigned char bytes[32];
+        BN_bn2binpad(bn, bytes, 32);
+        Field f = field_from_bytes(bytes);
+        std::memcpy(scalar, f.n, sizeof(f.n));
+    }
+
+    // Та же проверка, что ECDSA_do_verify, но u2 * Q берётся из таблицы ключа
+    bool verify_with_table(const PointTable& key_table, const unsigned char* digest, const ECDSA_SIG* signature)
+    {
+        const auto& curve = get_curve();
+        const BIGNUM* r = ECDSA_SIG_get0_r(signature);
+        const BIGNUM* s = ECDSA_SIG_get0_s(signature);
+
+        if (BN_is_zero(r) || BN_is_negative(r) || BN_ucmp(r, curve.order) >= 0
+            || BN_is_zero(s) || BN_is_negative(s) || BN_ucmp(s, curve.order) >= 0) {
+            return false;
+        }
+
+        // контекст на поток, чтобы не создавать его на каждую проверку
+        static thread_local std::unique_ptr<BN_CTX, decltype(&BN_CTX_free)> thread_ctx(BN_CTX_new(), BN_CTX_free);
+        BN_CTX* ctx = thread_ctx.get();
+        BN_CTX_start(ctx);
+        BIGNUM* w = BN_CTX_get(ctx);
+        BIGNUM* u1 = BN_CTX_get(ctx);
+        BIGNUM* u2 = BN_CTX_get(ctx);
+        BIGNUM* r_plus_n = BN_CTX_get(ctx);
+
+        bool ok = r_plus_n
+            && BN_mod_inverse(w, s, curve.order, ctx)
+            && BN_bin2bn(digest, 32, u1)
+            && BN_mod_mul(u1, u1, w, curve.order, ctx)
+            && BN_mod_mul(u2, r, w, curve.order, ctx)
+            && BN_add(r_plus_n, r, curve.order);
+
+        bool valid = false;
+        if (ok) {
+            uint64_t scalar1[4];
+            uint64_t scalar2[4];
+            scalar_from_bn(u1, scalar1);
+            scalar_from_bn(u2, scalar2);
+
+            Jacobian point { {}, {}, {}, true };
+            curve.generator->add_multiple(point, scalar1);
+            key_table.add_multiple(point, scalar2);
+
+            if (!point.infinity) {
+                // x(R) mod n == r без инверсии: x = r или x = r + n, если это меньше p
+                unsigned char bytes[32];
+                Field z2 = field_sqr(point.z);
+
+                BN_bn2binpad(r, bytes, 32);
+                valid = field_equal(field_mul(field_from_bytes(bytes), z2), point.x);
+                if (!valid && BN_ucmp(r_plus_n, curve.prime) < 0) {
+                    BN_bn2binpad(r_plus_n, bytes, 32);
+                    valid = field_equal(field_mul(field_from_bytes(bytes), z2), point.x);
+                }
+            }
+        }
+
+        BN_CTX_end(ctx);
+        return valid;
+    }
+
+    bool get_secp256k1_point(EVP_PKEY* pubkey, Affine& point)
+    {
+        BIGNUM* x = BN_new();
+        BIGNUM* y = BN_new();
+        bool ok = false;
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        char group_name[64];
+        size_t group_name_size = 0;
+        ok = EVP_PKEY_get_group_name(pubkey, group_name, sizeof(group_name), &group_name_size)
+            && std::string_view(group_name, group_name_size) == SN_secp256k1
+            && EVP_PKEY_get_bn_param(pubkey, OSSL_PKEY_PARAM_EC_PUB_X, &x)
+            && EVP_PKEY_get_bn_param(pubkey, OSSL_PKEY_PARAM_EC_PUB_Y, &y);
+#else
+        EC_KEY* ec_key = EVP_PKEY_get1_EC_KEY(pubkey);
+        ok = ec_key
+            && EC_GROUP_get_curve_name(EC_KEY_get0_group(ec_key)) == NID_secp256k1
+            && EC_POINT_get_affine_coordinates(EC_KEY_get0_group(ec_key), EC_KEY_get0_public_key(ec_key), x, y, nullptr);
+        EC_KEY_free(ec_key);
+#endif
+
+        if (ok) {
+            unsigned char bytes[32];
+            BN_bn2binpad(x, bytes, 32);
+            point.x = field_from_bytes(bytes);
+            BN_bn2binpad(y, bytes, 32);
+            point.y = field_from_bytes(bytes);
+        }
+
+        BN_free(x);
+        BN_free(y);
+        return ok;
+    }
+
+    std::shared_ptr<const PointTable> make_key_table(std::string_view pubk)
+    {
+        EVP_PKEY* pubkey = ReadPublicKey(pubk);
+        if (!pubkey) {
+            return nullptr;
+        }
+
+        std::shared_ptr<const PointTable> table;
+        Affine point;
+        if (get_secp256k1_point(pubkey, point)) {
+            table = std::make_shared<PointTable>(point, SIGN_KEY_WINDOW_BITS);
+        }
+
+        EVP_PKEY_free(pubkey);
+        return table;
+    }
+
+    bool check_sign_openssl(std::string_view data, std::string_view sign, std::string_view pubk)
+    {
+        EVP_PKEY* pubkey = ReadPublicKey(pubk);
+        if (!pubkey) {
+            return false;
+        }
+        ECDSA_SIG* signature = ReadSignature(sign);
+        if (!signature) {
+            EVP_PKEY_free(pubkey);
+            return false;
+        }
+
+        std::vector<char> data_as_vector(data.begin(), data.end());
+        bool valid = CheckBufferSignature(pubkey, data_as_vector, signature);
+
+        EVP_PKEY_free(pubkey);
+        ECDSA_SIG_free(signature);
+        return valid;
+    }
+
+    // Таблицы для часто проверяемых ключей. Считаются только успешные проверки, чтобы чужие ключи
+    // с мусорными подписями не занимали места; при нехватке места вытесняется давно не нужная таблица.
+    class KeyTables {
+    private:
+        struct Entry {
+            uint64_t uses = 0;
+            std::atomic<uint64_t> last_used = 0;
+            std::shared_ptr<const PointTable> table;
+            std::unique_ptr<const std::string> key; // ключ карты ссылается на эту строку
+        };
+
+        struct Shard {
+            std::shared_mutex lock;
+            std::unordered_map<std::string_view, Entry> keys;
+        };
+
+        // Владелец таблицы в очереди вытеснения. Узлы unordered_map не переезжают,
+        // а записи с таблицами из карты не удаляются, поэтому указатель на запись живёт, пока владелец в очереди.
+        struct Owner {
+            Shard* shard;
+            Entry* entry;
+            uint64_t queued_at;
+        };
+
+        static const uint64_t SHARD_COUNT = 16;
+        Shard shards[SHARD_COUNT];
+
+        std::atomic<uint64_t> clock = 0;
+        std::mutex tables_lock;
+        std::list<Owner> owners; // от давно поставленных в очередь к недавним
+
+        Shard& get_shard(std::string_view pubk)
+        {
+            return shards[std::hash<std::string_view>()(pubk) % SHARD_COUNT];
+        }
+
+        // вызывается под tables_lock. get не трогает очередь, только время использования:
+        // таблица, которой пользовались после постановки в очередь, переставляется в конец
+        bool evict_oldest()
+        {
+            for (uint64_t checked = 0, count = owners.size(); !owners.empty(); checked++) {
+                auto owner = owners.front();
+                owners.pop_front();
+
+                uint64_t last_used = owner.entry->last_used;
+                if (last_used > owner.queued_at && checked < count) {
+                    owner.queued_at = last_used;
+                    owners.push_back(owner);
+                    continue;
+                }
+
+                // ключ снова должен набрать успешные проверки, чтобы вернуть таблицу
+                std::unique_lock lock(owner.shard->lock);
+                owner.entry->table = nullptr;
+                owner.entry->uses = 0;
+                return true;
+            }
+            return false;
+        }
+
+    public:
+        std::shared_ptr<const PointTable> get(std::string_view pubk)
+        {
+            auto& shard = get_shard(pubk);
+            std::shared_lock lock(shard.lock);
+            auto it = shard.keys.find(pubk);
+            if (it != shard.keys.end() && it->second.table) {
+                it->second.last_used = clock.fetch_add(1);
+                return it->second.table;
+            }
+            return nullptr;
+        }
+
+        void add_success(std::string_view pubk)
+        {
+            auto& shard = get_shard(pubk);
+            {
+                std::unique_lock lock(shard.lock);
+                if (shard.keys.size() >= SIGN_KEY_COUNTER_LIMIT) {
+                    // редкие ключи забываются, ключи с таблицами остаются
+                    for (auto it = shard.keys.begin(); it != shard.keys.end();) {
+                        it = it->second.table ? std::next(it) : shard.keys.erase(it);
+                    }
+                }
+
+                auto it = shard.keys.find(pubk);
+                if (it == shard.keys.end()) {
+                    auto key = std::make_unique<const std::string>(pubk);
+                    it = shard.keys.try_emplace(*key).first;
+                    it->second.key = std::move(key);
+                }
+                auto& entry = it->second;
+                if (entry.table || ++entry.uses != SIGN_KEY_TABLE_MIN_USES) {
+                    return;
+                }
+            }
+
+            auto table = make_key_table(pubk);
+            if (!table) {
+                return;
+            }
+
+            std::lock_guard tables_guard(tables_lock);
+            if (owners.size() >= SIGN_KEY_TABLE_MAX && !evict_oldest()) {
+                return;
+            }
+
+            std::unique_lock lock(shard.lock);
+            auto it = shard.keys.find(pubk);
+            if (it != shard.keys.end() && !it->second.table) {
+                auto& entry = it->second;
+                entry.table = table;
+                entry.last_used = clock.fetch_add(1);
+                owners.push_back({ &shard, &entry, entry.last_used });
+            }
+        }
+    };
+
+}
+
+bool verify_sign(std::string_view data, std::string_view sign, std::string_view pubk)
+{
+    static KeyTables key_tables;
+
+    auto table = key_tables.get(pubk);
+    if (!table) {
+        bool valid = check_sign_openssl(data, sign, pubk);
+        if (valid) {
+            key_tables.add_success(pubk);
+        }
+        return valid;
+    }
+
+    ECDSA_SIG* signature = ReadSignature(sign);
+    if (!signature) {
+        return false;
+    }
+
+    unsigned char digest[32];
+    SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), digest);
+
+    bool valid = verify_with_table(*table, digest, signature);
+    ECDSA_SIG_free(signature);
+    return valid;
+}
+
+}
@@ -0,0 +1,230 @@
+#include <hex_codec.hpp>
+#include <meta_crypto.h>
+#include <meta_test.hpp>
+
+#include <cctype>
+#include <iostream>
+#include <limits>
+#include <random>
+
+using namespace metahash;
+using test::check;
+
+namespace {
+
+// длиннее блока AVX2 (32 байта) с неполным хвостом, чтобы пройти все ветки каждого ядра
+const uint64_t MAX_SIZE = 100;
+
+unsigned char reference_value(char c)
+{
+    static const std::string lower = "0123456789abcdef";
+    static const std::string upper = "0123456789ABCDEF";
+    if (auto pos = lower.find(c); pos != std::string::npos) {
+        return pos;
+    }
+    if (auto pos = upper.find(c); pos != std::string::npos) {
+        return pos;
+    }
+    return 0;
+}
+
+std::string reference_encode(const std::vector<unsigned char>& bin)
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    for (auto byte : bin) {
+        hex += digits[byte >> 4];
+        hex += digits[byte & 0x0f];
+    }
+    return hex;
+}
+
+std::vector<unsigned char> reference_decode(const std::string& hex)
+{
+    std::vector<unsigned char> bin;
+    for (uint64_t i = 0; i + 1 < hex.size(); i += 2) {
+        bin.push_back((reference_value(hex[i]) << 4) | reference_value(hex[i + 1]));
+    }
+    if (hex.size() % 2) {
+        bin.push_back(reference_value(hex.back()) << 4);
+    }
+    return bin;
+}
+
+using EncodeFunction = void (*)(const unsigned char*, uint64_t, char*);
+using DecodeFunction = void (*)(const char*, uint64_t, unsigned char*);
+
+void check_kernels(const std::string& name, EncodeFunction encode, DecodeFunction decode)
+{
+    std::mt19937_64 rng(42);
+
+    // символы по обе стороны от диапазонов 0-9, a-f, A-F и байты со старшим битом
+    static const std::string invalid = { '/', ':', '@', 'G', '`', 'g', 'x', ' ', '\0', '\x80', '\xff' };
+
+    for (uint64_t size = 0; size <= MAX_SIZE; size++) {
+        std::vector<unsigned char> bin(size);
+        for (auto& byte : bin) {
+            byte = static_cast<unsigned char>(rng());
+        }
+
+        std::string hex(2 * size, '\0');
+        encode(bin.data(), size, hex.data());
+        check(hex == reference_encode(bin), name + " encode, size " + std::to_string(size));
+
+        std::vector<unsigned char> decoded(size);
+        decode(hex.data(), size, decoded.data());
+        check(decoded == bin, name + " decode, size " + std::to_string(size));
+
+        std::string upper = hex;
+        for (auto& c : upper) {
+            c = std::toupper(c);
+        }
+        decode(upper.data(), size, decoded.data());
+        check(decoded == bin, name + " decode upper case, size " + std::to_string(size));
+
+        // неверные цифры дают нулевой полубайт, соседние не портят
+        std::string broken = hex;
+        for (uint64_t i = 0; i < broken.size(); i += 1 + rng() % 5) {
+            broken[i] = invalid[rng() % invalid.size()];
+        }
+        decode(broken.data(), size, decoded.data());
+        check(decoded == reference_decode(broken), name + " decode invalid digits, size " + std::to_string(size));
+    }
+}
+
+void check_hex()
+{
+    __builtin_cpu_init();
+
+    check_kernels("scalar", crypto::hex_kernels::encode_scalar, crypto::hex_kernels::decode_scalar);
+
+    if (__builtin_cpu_supports("sse4.1")) {
+        check_kernels("sse4", crypto::hex_kernels::encode_sse4, crypto::hex_kernels::decode_sse4);
+    } else {
+        std::cout << "sse4.1 not supported, skipped" << std::endl;
+    }
+
+    if (__builtin_cpu_supports("avx2")) {
+        check_kernels("avx2", crypto::hex_kernels::encode_avx2, crypto::hex_kernels::decode_avx2);
+    } else {
+        std::cout << "avx2 not supported, skipped" << std::endl;
+    }
+
+    using Bytes = std::vector<unsigned char>;
+
+    check(crypto::hex2bin("") == Bytes(), "hex2bin empty");
+    check(crypto::hex2bin("0a1B") == Bytes({ 0x0a, 0x1b }), "hex2bin without prefix");
+    check(crypto::hex2bin("0x0a1B") == Bytes({ 0x0a, 0x1b }), "hex2bin with prefix");
+    check(crypto::hex2bin("abc") == Bytes({ 0xab, 0xc0 }), "hex2bin odd length");
+    check(crypto::hex2bin("0xabc") == Bytes({ 0xab, 0xc0 }), "hex2bin odd length with prefix");
+    check(crypto::hex2bin("0x1") == Bytes({ 0x10 }), "hex2bin single digit with prefix");
+    // одно "0x" без цифр и "0X" префиксом не считаются
+    check(crypto::hex2bin("0x") == Bytes({ 0x00 }), "hex2bin bare prefix");
+    check(crypto::hex2bin("0X12") == Bytes({ 0x00, 0x12 }), "hex2bin upper case prefix");
+    check(crypto::hex2bin("0xzz12") == Bytes({ 0x00, 0x12 }), "hex2bin invalid digits");
+
+    std::mt19937_64 rng(7);
+    for (uint64_t size = 0; size <= MAX_SIZE; size++) {
+        Bytes bin(size);
+        for (auto& byte : bin) {
+            byte = static_cast<unsigned char>(rng());
+        }
+        auto hex = crypto::bin2hex(bin);
+        check(hex == reference_encode(bin), "bin2hex, size " + std::to_string(size));
+        check(crypto::hex2bin(hex) == bin, "hex2bin, size " + std::to_string(size));
+        check(size == 0 || crypto::hex2bin("0x" + hex) == bin, "hex2bin with prefix, size " + std::to_string(size));
+    }
+}
+
+void check_byte_reader()
+{
+    const std::string abc = "abc";
+    std::string_view sw;
+
+    {
+        crypto::ByteReader reader(abc);
+        check(!reader.read(sw, 4) && reader.position() == 0, "read past end moves offset");
+        check(reader.read(sw, 2) && sw == "ab" && reader.remaining() == 1, "read inside bounds");
+        check(!reader.read(sw, std::numeric_limits<uint64_t>::max()) && reader.position() == 2, "read with huge size");
+        check(reader.read(sw, 1) && sw == "c" && reader.remaining() == 0, "read to end");
+        check(reader.read(sw, 0) && sw.empty(), "empty read at end");
+        check(!reader.read(sw, 1), "read after end");
+    }
+
+    {
+        crypto::ByteReader reader(abc, 10);
+        check(reader.position() == abc.size() && reader.remaining() == 0, "offset clamped to size");
+        uint64_t value = 0;
+        check(!reader.read_varint(value), "varint at end");
+    }
+
+    // varint, у которого не хватает байт значения
+    for (uint64_t value : { uint64_t(0x1234), uint64_t(0x12345678), uint64_t(0x123456789a) }) {
+        std::vector<char> buff;
+        crypto::ByteWriter(buff).write_varint(value);
+        for (uint64_t size = 0; size < buff.size(); size++) {
+            crypto::ByteReader reader(std::string_view(buff.data(), size));
+            uint64_t got = 0;
+            check(!reader.read_varint(got) && reader.position() == 0, "truncated varint " + std::to_string(value) + ", size " + std::to_string(size));
+        }
+        crypto::ByteReader reader(std::string_view(buff.data(), buff.size()));
+        uint64_t got = 0;
+        check(reader.read_varint(got) && got == value && reader.remaining() == 0, "varint " + std::to_string(value));
+    }
+
+    // кадры всех размеров varint, обрыв в любом месте не сдвигает позицию
+    std::vector<std::string> payloads = { "x", std::string(0xf0, 'a'), std::string(300, 'b'), std::string(70000, 'c') };
+    std::vector<char> buff;
+    {
+        crypto::ByteWriter writer(buff);
+        for (const auto& payload : payloads) {
+            writer.write_frame(payload);
+        }
+        writer.write_varint(0);
+    }
+
+    {
+        crypto::ByteReader reader(std::string_view(buff.data(), buff.size()));
+        std::vector<std::string_view> frames;
+        check(reader.read_frames(frames) && reader.remaining() == 0, "read_frames with terminator");
+        check(frames.size() == payloads.size(), "read_frames count");
+        for (uint64_t i = 0; i < frames.size() && i < payloads.size(); i++) {
+            check(frames[i] == payloads[i], "frame " + std::to_string(i));
+        }
+    }
+
+    for (uint64_t size : { uint64_t(0), uint64_t(1), uint64_t(2), uint64_t(buff.size() - 1), uint64_t(buff.size() - 2), uint64_t(buff.size() - 70000) }) {
+        crypto::ByteReader reader(std::string_view(buff.data(), size));
+        std::vector<std::string_view> frames;
+        check(!reader.read_frames(frames), "read_frames without terminator, size " + std::to_string(size));
+
+        uint64_t read_size = 0;
+        for (const auto& frame : frames) {
+            read_size += crypto::get_varint_size(frame.size()) + frame.size();
+        }
+        check(reader.position() == read_size, "position after truncated frame, size " + std::to_string(size));
+
+        std::string_view frame;
+        check(!reader.read_frame(frame) && reader.position() == read_size, "truncated frame keeps position, size " + std::to_string(size));
+    }
+
+    {
+        // заявленная длина кадра больше всего буфера
+        std::vector<char> huge;
+        crypto::ByteWriter(huge).write_varint(std::numeric_limits<uint64_t>::max());
+        huge.push_back('z');
+        crypto::ByteReader reader(std::string_view(huge.data(), huge.size()));
+        std::string_view frame;
+        check(!reader.read_frame(frame) && reader.position() == 0, "frame with huge length");
+    }
+}
+
+}
+
+int main()
+{
+    check_hex();
+    check_byte_reader();
+
+    return test::result();
+}
@@ -0,0 +1,92 @@
+#include <meta_crypto.h>
+#include <meta_test.hpp>
+#include <sha256_batch.hpp>
+
+#include <openssl/sha.h>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+using namespace metahash;
+using test::check;
+using crypto::sha256_2;
+
+namespace {
+
+// границы паддинга: 55 и 56 байт - длина ещё помещается в блок или уже нет, 119 - то же для второго блока
+const uint64_t MAX_LENGTH = 200;
+
+sha256_2 reference_sha256(std::string_view message)
+{
+    sha256_2 first;
+    sha256_2 second;
+    SHA256(reinterpret_cast<const unsigned char*>(message.data()), message.size(), first.data());
+    SHA256(first.data(), first.size(), second.data());
+    return second;
+}
+
+void check_kernel(const std::string& name, void (*hash_batch)(const std::vector<std::string_view>&, std::vector<sha256_2>&), const std::vector<std::string_view>& messages)
+{
+    // по одному сообщению: в AVX2 заняты не все дорожки
+    for (const auto& message : messages) {
+        std::vector<std::string_view> single = { message };
+        std::vector<sha256_2> hashes(1);
+        hash_batch(single, hashes);
+        check(hashes[0] == crypto::get_sha256(message), name + " single, length " + std::to_string(message.size()));
+    }
+
+    // все длины вперемешку, в конце неполная группа из восьми
+    std::vector<std::string_view> shuffled(messages);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64(7));
+    std::vector<sha256_2> hashes(shuffled.size());
+    hash_batch(shuffled, hashes);
+    for (uint64_t i = 0; i < shuffled.size(); i++) {
+        check(hashes[i] == crypto::get_sha256(shuffled[i]), name + " batch, length " + std::to_string(shuffled[i].size()));
+    }
+}
+
+}
+
+int main()
+{
+    std::mt19937_64 rng(42);
+
+    std::string buffer(MAX_LENGTH, '\0');
+    for (auto& c : buffer) {
+        c = static_cast<char>(rng());
+    }
+
+    std::vector<std::string_view> messages;
+    for (uint64_t length = 0; length <= MAX_LENGTH; length++) {
+        messages.emplace_back(buffer.data(), length);
+    }
+
+    for (const auto& message : messages) {
+        check(crypto::get_sha256(message) == reference_sha256(message), "get_sha256, length " + std::to_string(message.size()));
+    }
+
+    __builtin_cpu_init();
+
+    check_kernel("openssl", crypto::sha256_kernels::hash_batch_openssl, messages);
+
+    if (__builtin_cpu_supports("avx2")) {
+        check_kernel("avx2", crypto::sha256_kernels::hash_batch_avx2, messages);
+    } else {
+        std::cout << "avx2 not supported, skipped" << std::endl;
+    }
+
+    if (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1")) {
+        check_kernel("sha-ni", crypto::sha256_kernels::hash_batch_shani, messages);
+    } else {
+        std::cout << "sha-ni not supported, skipped" << std::endl;
+    }
+
+    std::vector<sha256_2> hashes;
+    crypto::get_sha256_batch(messages, hashes);
+    for (uint64_t i = 0; i < messages.size(); i++) {
+        check(hashes[i] == crypto::get_sha256(messages[i]), "get_sha256_batch, length " + std::to_string(messages[i].size()));
+    }
+
+    return test::result();
+}
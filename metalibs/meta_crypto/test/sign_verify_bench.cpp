@@ -0,0 +1,95 @@
+#include <meta_constants.hpp>
+#include <meta_crypto.h>
+
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+#include <openssl/x509.h>
+
+#include <chrono>
+#include <iostream>
+
+using namespace metahash;
+
+namespace {
+
+const uint64_t SIGNATURE_COUNT = 2000;
+
+struct Signed {
+    std::string data;
+    std::vector<char> sign;
+};
+
+std::vector<char> make_private_key()
+{
+    EVP_PKEY_CTX* param_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    EVP_PKEY* params = nullptr;
+    EVP_PKEY_paramgen_init(param_ctx);
+    EVP_PKEY_CTX_set_ec_paramgen_curve_nid(param_ctx, NID_secp256k1);
+    EVP_PKEY_paramgen(param_ctx, &params);
+
+    EVP_PKEY_CTX* key_ctx = EVP_PKEY_CTX_new(params, nullptr);
+    EVP_PKEY* pkey = nullptr;
+    EVP_PKEY_keygen_init(key_ctx);
+    EVP_PKEY_keygen(key_ctx, &pkey);
+
+    unsigned char* der = nullptr;
+    int der_size = i2d_PrivateKey(pkey, &der);
+    std::vector<char> private_key(der, der + der_size);
+
+    OPENSSL_free(der);
+    EVP_PKEY_free(pkey);
+    EVP_PKEY_CTX_free(key_ctx);
+    EVP_PKEY_free(params);
+    EVP_PKEY_CTX_free(param_ctx);
+    return private_key;
+}
+
+std::vector<Signed> make_signatures(crypto::Signer& signer)
+{
+    std::vector<Signed> signatures;
+    for (uint64_t i = 0; i < SIGNATURE_COUNT; i++) {
+        std::string data = "transaction " + std::to_string(i);
+        signatures.push_back({ data, signer.sign(data) });
+    }
+    return signatures;
+}
+
+double verify_all(const std::vector<Signed>& signatures, const std::vector<char>& pub_key, uint64_t& valid)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& item : signatures) {
+        valid += crypto::check_sign(item.data, item.sign, pub_key);
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / signatures.size();
+}
+
+}
+
+int main()
+{
+    uint64_t valid = 0;
+
+    // у каждого холодного ключа меньше SIGN_KEY_TABLE_MIN_USES проверок, таблица не строится
+    double cold_us = 0;
+    for (uint64_t i = 0; i < SIGNATURE_COUNT / (SIGN_KEY_TABLE_MIN_USES - 1); i++) {
+        crypto::Signer signer(make_private_key());
+        std::vector<Signed> signatures;
+        for (uint64_t j = 0; j < SIGN_KEY_TABLE_MIN_USES - 1; j++) {
+            std::string data = "transaction " + std::to_string(j);
+            signatures.push_back({ data, signer.sign(data) });
+        }
+        cold_us += verify_all(signatures, signer.get_pub_key(), valid) * signatures.size();
+    }
+    cold_us /= SIGNATURE_COUNT / (SIGN_KEY_TABLE_MIN_USES - 1) * (SIGN_KEY_TABLE_MIN_USES - 1);
+
+    crypto::Signer hot_signer(make_private_key());
+    auto hot_signatures = make_signatures(hot_signer);
+    verify_all(hot_signatures, hot_signer.get_pub_key(), valid);
+    double hot_us = verify_all(hot_signatures, hot_signer.get_pub_key(), valid);
+
+    std::cout << "openssl_us_per_verify=" << cold_us
+              << " table_us_per_verify=" << hot_us
+              << " speedup=" << cold_us / hot_us
+              << " valid=" << valid << std::endl;
+    return 0;
+}
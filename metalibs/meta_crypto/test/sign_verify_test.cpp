@@ -0,0 +1,256 @@
+// эталоном служит ECDSA_do_verify, он объявлен устаревшим в OpenSSL 3
+#define OPENSSL_SUPPRESS_DEPRECATED
+
+#include <meta_constants.hpp>
+#include <meta_crypto.h>
+#include <meta_test.hpp>
+
+#include <openssl/ec.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+#include <openssl/sha.h>
+#include <openssl/x509.h>
+
+#include <iostream>
+#include <random>
+
+using namespace metahash;
+using test::check;
+
+namespace {
+
+// сколько успешных проверок сделать ключом, чтобы дальше он шёл через таблицу
+const uint64_t WARM_UP_USES = SIGN_KEY_TABLE_MIN_USES + 4;
+// больше SIGN_KEY_TABLE_MAX, чтобы таблицы вытеснялись
+const uint64_t EVICTION_KEY_COUNT = SIGN_KEY_TABLE_MAX + 16;
+
+struct Key {
+    int curve_nid;
+    EVP_PKEY* pkey;
+    std::string pub_key;
+};
+
+Key make_key(int curve_nid)
+{
+    EVP_PKEY_CTX* param_ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    EVP_PKEY* params = nullptr;
+    EVP_PKEY_paramgen_init(param_ctx);
+    EVP_PKEY_CTX_set_ec_paramgen_curve_nid(param_ctx, curve_nid);
+    EVP_PKEY_paramgen(param_ctx, &params);
+
+    EVP_PKEY_CTX* key_ctx = EVP_PKEY_CTX_new(params, nullptr);
+    EVP_PKEY* pkey = nullptr;
+    EVP_PKEY_keygen_init(key_ctx);
+    EVP_PKEY_keygen(key_ctx, &pkey);
+
+    EVP_PKEY_CTX_free(key_ctx);
+    EVP_PKEY_free(params);
+    EVP_PKEY_CTX_free(param_ctx);
+
+    unsigned char* der = nullptr;
+    int der_size = i2d_PUBKEY(pkey, &der);
+    Key key { curve_nid, pkey, std::string(reinterpret_cast<char*>(der), der_size) };
+    OPENSSL_free(der);
+    return key;
+}
+
+std::array<unsigned char, 32> digest_of(const std::string& data)
+{
+    std::array<unsigned char, 32> digest;
+    SHA256(reinterpret_cast<const unsigned char*>(data.data()), data.size(), digest.data());
+    return digest;
+}
+
+ECDSA_SIG* sign_digest(const Key& key, const std::array<unsigned char, 32>& digest)
+{
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new(key.pkey, nullptr);
+    EVP_PKEY_sign_init(ctx);
+    size_t size = 0;
+    EVP_PKEY_sign(ctx, nullptr, &size, digest.data(), digest.size());
+    std::vector<unsigned char> der(size);
+    EVP_PKEY_sign(ctx, der.data(), &size, digest.data(), digest.size());
+    EVP_PKEY_CTX_free(ctx);
+
+    const unsigned char* p = der.data();
+    return d2i_ECDSA_SIG(nullptr, &p, size);
+}
+
+std::string encode(const ECDSA_SIG* signature)
+{
+    unsigned char* der = nullptr;
+    int size = i2d_ECDSA_SIG(signature, &der);
+    if (size <= 0) {
+        return std::string();
+    }
+    std::string encoded(reinterpret_cast<char*>(der), size);
+    OPENSSL_free(der);
+    return encoded;
+}
+
+bool reference_verify(const std::string& data, const std::string& sign, const std::string& pub_key)
+{
+    const auto* key_p = reinterpret_cast<const unsigned char*>(pub_key.data());
+    EVP_PKEY* pkey = d2i_PUBKEY(nullptr, &key_p, pub_key.size());
+    const auto* sign_p = reinterpret_cast<const unsigned char*>(sign.data());
+    ECDSA_SIG* signature = d2i_ECDSA_SIG(nullptr, &sign_p, sign.size());
+
+    bool valid = false;
+    if (pkey && signature) {
+        EC_KEY* ec_key = EVP_PKEY_get1_EC_KEY(pkey);
+        auto digest = digest_of(data);
+        valid = ec_key && ECDSA_do_verify(digest.data(), digest.size(), signature, ec_key) == 1;
+        EC_KEY_free(ec_key);
+    }
+
+    ECDSA_SIG_free(signature);
+    EVP_PKEY_free(pkey);
+    return valid;
+}
+
+void compare(const std::string& data, const std::string& sign, const std::string& pub_key, const std::string& name)
+{
+    bool expected = reference_verify(data, sign, pub_key);
+    bool got = crypto::check_sign(data, sign, pub_key);
+    check(got == expected, name + ": expected " + std::to_string(expected) + " got " + std::to_string(got));
+}
+
+ECDSA_SIG* make_signature(const BIGNUM* r, const BIGNUM* s)
+{
+    ECDSA_SIG* signature = ECDSA_SIG_new();
+    ECDSA_SIG_set0(signature, BN_dup(r), BN_dup(s));
+    return signature;
+}
+
+// подпись и её искажения для одного ключа и сообщения
+void check_signature_cases(const Key& key, const std::string& data, const std::string& path)
+{
+    EC_GROUP* group = EC_GROUP_new_by_curve_name(key.curve_nid);
+    const BIGNUM* order = EC_GROUP_get0_order(group);
+
+    auto digest = digest_of(data);
+    ECDSA_SIG* signature = sign_digest(key, digest);
+    const BIGNUM* r = ECDSA_SIG_get0_r(signature);
+    const BIGNUM* s = ECDSA_SIG_get0_s(signature);
+
+    BIGNUM* value = BN_new();
+    BIGNUM* zero = BN_new();
+    BN_zero(zero);
+
+    auto check_sig = [&](ECDSA_SIG* variant, const std::string& name) {
+        compare(data, encode(variant), key.pub_key, path + " " + name);
+        ECDSA_SIG_free(variant);
+    };
+
+    std::string valid = encode(signature);
+    compare(data, valid, key.pub_key, path + " valid");
+    compare(data + "x", valid, key.pub_key, path + " other message");
+    compare(data, valid.substr(0, valid.size() - 1), key.pub_key, path + " truncated signature");
+
+    BN_sub(value, order, s);
+    check_sig(make_signature(r, value), "negated s");
+
+    BN_add(value, s, BN_value_one());
+    check_sig(make_signature(r, value), "tampered s");
+
+    BN_add(value, r, BN_value_one());
+    check_sig(make_signature(value, s), "tampered r");
+
+    check_sig(make_signature(s, r), "swapped r and s");
+    check_sig(make_signature(r, zero), "zero s");
+    check_sig(make_signature(zero, s), "zero r");
+    check_sig(make_signature(order, s), "r equal to n");
+
+    BN_add(value, s, order);
+    check_sig(make_signature(r, value), "s above n");
+
+    BN_add(value, r, order);
+    check_sig(make_signature(value, s), "r plus n");
+
+    BN_free(zero);
+    BN_free(value);
+    ECDSA_SIG_free(signature);
+    EC_GROUP_free(group);
+}
+
+void warm_up(const Key& key)
+{
+    for (uint64_t i = 0; i < WARM_UP_USES; i++) {
+        std::string data = "warm up " + std::to_string(i);
+        ECDSA_SIG* signature = sign_digest(key, digest_of(data));
+        check(crypto::check_sign(data, encode(signature), key.pub_key), "warm up: valid signature rejected");
+        ECDSA_SIG_free(signature);
+    }
+}
+
+void check_key(const Key& key, const std::string& name)
+{
+    for (int message = 0; message < 4; message++) {
+        check_signature_cases(key, "message " + std::to_string(message), name);
+    }
+}
+
+}
+
+int main()
+{
+    std::mt19937_64 rng(1);
+
+    std::vector<Key> keys;
+    for (int i = 0; i < 4; i++) {
+        keys.push_back(make_key(NID_secp256k1));
+    }
+    Key other_curve = make_key(NID_X9_62_prime256v1);
+
+    // холодные ключи: проверка идёт через OpenSSL
+    for (const auto& key : keys) {
+        check_key(key, "cold");
+    }
+    check_key(other_curve, "prime256v1");
+
+    // после WARM_UP_USES успешных проверок у ключа есть таблица
+    for (const auto& key : keys) {
+        warm_up(key);
+        check_key(key, "table");
+    }
+    warm_up(other_curve);
+    check_key(other_curve, "prime256v1 warm");
+
+    // испорченные ключи
+    for (const auto& key : keys) {
+        std::string data = "bad key";
+        ECDSA_SIG* signature = sign_digest(key, digest_of(data));
+        std::string sign = encode(signature);
+        ECDSA_SIG_free(signature);
+
+        std::string broken = key.pub_key;
+        broken[broken.size() - 1] ^= 1;
+        compare(data, sign, broken, "point off the curve");
+        compare(data, sign, key.pub_key.substr(0, key.pub_key.size() - 1), "truncated key");
+        compare(data, sign, std::string(key.pub_key.size(), char(rng())), "garbage key");
+        compare(data, sign, other_curve.pub_key, "key of another curve");
+        compare(data, sign, keys[(&key - keys.data() + 1) % keys.size()].pub_key, "other key");
+    }
+
+    // таблиц больше, чем помещается: вытеснение не должно менять результат
+    std::vector<Key> many_keys;
+    for (uint64_t i = 0; i < EVICTION_KEY_COUNT; i++) {
+        many_keys.push_back(make_key(NID_secp256k1));
+        warm_up(many_keys.back());
+    }
+    for (const auto& key : keys) {
+        check_key(key, "after eviction");
+    }
+    for (uint64_t i = 0; i < 8; i++) {
+        check_signature_cases(many_keys[rng() % many_keys.size()], "evicting", "many keys");
+    }
+
+    for (auto& key : keys) {
+        EVP_PKEY_free(key.pkey);
+    }
+    for (auto& key : many_keys) {
+        EVP_PKEY_free(key.pkey);
+    }
+    EVP_PKEY_free(other_curve.pkey);
+
+    return test::result();
+}
@@ -10,6 +10,8 @@
 
 namespace metahash::network {
 
+using AllowedAddresses = pool::RcuSnapshot<std::unordered_set<std::string, crypto::Hasher>>;
+
 class Request {
 public:
     uint64_t request_id = 0;
@@ -21,7 +23,7 @@ public:
     std::string sender_mh_addr;
     std::string remote_ip_address;
 
-    int8_t parse(char*, size_t, std::unordered_set<std::string, crypto::Hasher>& allowed_addreses);
+    int8_t parse(char*, size_t, AllowedAddresses& allowed_addreses);
 
 private:
     std::vector<char> request_full;
@@ -67,7 +69,7 @@ private:
     };
 
 public:
-    explicit Connection(boost::asio::io_context& io_context, std::function<std::vector<char>(Request&)> handler, crypto::Signer& signer, std::unordered_set<std::string, crypto::Hasher>& allowed_addreses);
+    explicit Connection(boost::asio::io_context& io_context, std::function<std::vector<char>(Request&)> handler, crypto::Signer& signer, AllowedAddresses& allowed_addreses);
 
     static void start(std::shared_ptr<Connection>);
 
@@ -84,7 +86,7 @@ public:
 
     std::function<std::vector<char>(Request&)> request_handler;
     crypto::Signer& signer;
-    std::unordered_set<std::string, crypto::Hasher>& allowed_addreses;
+    AllowedAddresses& allowed_addreses;
 };
 
 class meta_server {
@@ -108,7 +110,7 @@ private:
 
     std::function<std::vector<char>(Request&)> request_handler;
     crypto::Signer& signer;
-    std::unordered_set<std::string, crypto::Hasher> allowed_addreses;
+    AllowedAddresses allowed_addreses;
 
     std::shared_ptr<Connection> new_connection;
 };
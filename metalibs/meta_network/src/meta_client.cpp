@@ -48,18 +48,15 @@ void meta_client::send_message(uint64_t request_type, const std::vector<char>& m
     const std::vector<char> public_key = signer.get_pub_key();
     const std::vector<char> sign = signer.sign(message);
 
-    write_buff.insert(write_buff.end(), reinterpret_cast<char*>(&magic), (reinterpret_cast<char*>(&magic) + sizeof(uint32_t)));
-    crypto::append_varint(write_buff, request_id);
-    crypto::append_varint(write_buff, request_type);
-
-    crypto::append_varint(write_buff, public_key.size());
-    write_buff.insert(write_buff.end(), public_key.begin(), public_key.end());
-
-    crypto::append_varint(write_buff, sign.size());
-    write_buff.insert(write_buff.end(), sign.begin(), sign.end());
-
-    crypto::append_varint(write_buff, message.size());
-    write_buff.insert(write_buff.end(), message.begin(), message.end());
+    crypto::ByteWriter writer(write_buff);
+    writer.reserve(sizeof(uint32_t) + 6 * 9 + public_key.size() + sign.size() + message.size());
+
+    writer.write(&magic, sizeof(uint32_t));
+    writer.write_varint(request_id);
+    writer.write_varint(request_type);
+    writer.write_frame(public_key);
+    writer.write_frame(sign);
+    writer.write_frame(message);
 
     tasks.enqueue(new Task { write_buff, callback });
 }
@@ -70,21 +70,24 @@ int8_t ClientConnection::Response::parse(char* buff_data, size_t buff_size, cons
 
 bool ClientConnection::Response::read_varint(uint64_t& varint)
 {
-    auto previous_offset = offset;
-    offset += crypto::read_varint(varint, std::string_view(&request_full[offset], request_full.size() - offset));
-    return offset != previous_offset;
+    crypto::ByteReader reader(std::string_view(request_full.data(), request_full.size()), offset);
+    if (!reader.read_varint(varint)) {
+        return false;
+    }
+    offset = reader.position();
+    return true;
 }
 
 bool ClientConnection::Response::fill_sw(std::vector<char>& sw, uint64_t sw_size)
 {
-    if (offset + sw_size > request_full.size()) {
+    crypto::ByteReader reader(std::string_view(request_full.data(), request_full.size()), offset);
+    std::string_view part;
+    if (!reader.read(part, sw_size)) {
         return false;
-    } else {
-        sw.clear();
-        sw.insert(sw.end(), &request_full[offset], &request_full[offset] + sw_size);
-        offset += sw_size;
-        return true;
     }
+    sw.assign(part.begin(), part.end());
+    offset = reader.position();
+    return true;
 }
 
 }
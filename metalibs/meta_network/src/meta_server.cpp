@@ -61,7 +61,7 @@ void meta_server::handle_accept(const boost::system::error_code& e)
 }
 void meta_server::update_allowed_addreses(std::unordered_set<std::string, crypto::Hasher> _allowed_addreses)
 {
-    allowed_addreses = std::move(_allowed_addreses);
+    allowed_addreses.publish(std::move(_allowed_addreses));
 }
 
 }
\ No newline at end of file
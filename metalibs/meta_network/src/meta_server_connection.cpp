@@ -30,7 +30,7 @@ namespace statics {
     static const std::string invalid_sign = R"({"result":"error","error":"invalid sign"})";
 }
 
-Connection::Connection(boost::asio::io_context& io_context, std::function<std::vector<char>(Request&)> handler, crypto::Signer& signer, std::unordered_set<std::string, crypto::Hasher>& allowed_addreses)
+Connection::Connection(boost::asio::io_context& io_context, std::function<std::vector<char>(Request&)> handler, crypto::Signer& signer, AllowedAddresses& allowed_addreses)
     : serial_execution(io_context)
     , socket(serial_execution)
     , request_handler(std::move(handler))
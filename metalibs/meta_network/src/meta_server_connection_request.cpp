@@ -5,23 +5,25 @@ namespace metahash::network {
 
 bool Request::read_varint(uint64_t& varint)
 {
-    auto previous_offset = offset;
-    offset += crypto::read_varint(varint, std::string_view(&request_full[offset], request_full.size() - offset));
-    return offset != previous_offset;
+    crypto::ByteReader reader(std::string_view(request_full.data(), request_full.size()), offset);
+    if (!reader.read_varint(varint)) {
+        return false;
+    }
+    offset = reader.position();
+    return true;
 }
 
 bool Request::fill_sw(std::string_view& sw, uint64_t sw_size)
 {
-    if (offset + sw_size > request_full.size()) {
+    crypto::ByteReader reader(std::string_view(request_full.data(), request_full.size()), offset);
+    if (!reader.read(sw, sw_size)) {
         return false;
-    } else {
-        sw = std::string_view(&request_full[offset], sw_size);
-        offset += sw_size;
-        return true;
     }
+    offset = reader.position();
+    return true;
 }
 
-int8_t Request::parse(char* buff_data, size_t buff_size, std::unordered_set<std::string, crypto::Hasher>& allowed_addreses)
+int8_t Request::parse(char* buff_data, size_t buff_size, AllowedAddresses& allowed_addreses)
 {
     request_full.insert(request_full.end(), buff_data, buff_data + buff_size);
 
@@ -52,8 +54,9 @@ int8_t Request::parse(char* buff_data, size_t buff_size, std::unordered_set<std:
     if (public_key.empty()) {
         if (fill_sw(public_key, public_key_size)) {
             sender_mh_addr = "0x" + crypto::bin2hex(crypto::get_address(public_key));
-            if (!allowed_addreses.empty()) {
-                if (allowed_addreses.find(sender_mh_addr) == allowed_addreses.end()) {
+            auto allowed = allowed_addreses.read();
+            if (!allowed->empty()) {
+                if (allowed->find(sender_mh_addr) == allowed->end()) {
                     return statics::UNKNOWN_SENDER_METAHASH_ADDRESS;
                 }
             }
@@ -40,17 +40,14 @@ void Connection::Reply::serialize(crypto::Signer& _signer, uint64_t reply_id, st
     const auto sign = _signer.sign(message);
     uint32_t magic = METAHASH_MAGIC_NUMBER;
 
-    write_buff.insert(write_buff.end(), reinterpret_cast<char*>(&magic), (reinterpret_cast<char*>(&magic) + sizeof(uint32_t)));
-    crypto::append_varint(write_buff, reply_id);
+    crypto::ByteWriter writer(write_buff);
+    writer.reserve(sizeof(uint32_t) + 4 * 9 + public_key.size() + sign.size() + message.size());
 
-    crypto::append_varint(write_buff, public_key.size());
-    write_buff.insert(write_buff.end(), public_key.begin(), public_key.end());
-
-    crypto::append_varint(write_buff, sign.size());
-    write_buff.insert(write_buff.end(), sign.begin(), sign.end());
-
-    crypto::append_varint(write_buff, message.size());
-    write_buff.insert(write_buff.end(), message.begin(), message.end());
+    writer.write(&magic, sizeof(uint32_t));
+    writer.write_varint(reply_id);
+    writer.write_frame(public_key);
+    writer.write_frame(sign);
+    writer.write_frame(message);
 }
 
 boost::asio::const_buffer Connection::Reply::make_buff()
@@ -3,6 +3,13 @@
 
 #include <boost/asio.hpp>
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -10,6 +17,158 @@ namespace metahash::pool {
 
 std::tuple<std::vector<std::thread>, boost::asio::io_context::work> thread_pool(boost::asio::io_context& io_context, uint64_t thread_count);
 
+// Пул для вычислений: у каждого потока своя очередь, свободные потоки забирают задачи у занятых.
+// Задачи, поставленные из потока пула, попадают в его очередь, остальные - в общую.
+class CpuPool {
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex injected_lock;
+    std::deque<Task> injected;
+
+    std::mutex sleep_lock;
+    std::condition_variable wake_up;
+    std::atomic<uint64_t> queued = 0;
+    std::atomic<bool> stop = false;
+
+    std::vector<std::thread> threads;
+
+    static thread_local CpuPool* current_pool;
+    static thread_local uint64_t current_worker;
+
+    bool pop(Task& task);
+    void worker_loop(uint64_t index);
+
+public:
+    explicit CpuPool(uint64_t thread_count);
+    CpuPool(const CpuPool&) = delete;
+    CpuPool& operator=(const CpuPool&) = delete;
+    ~CpuPool();
+
+    void post(Task task);
+    // выполнить одну задачу в текущем потоке, если она есть; так ждущий поток помогает пулу
+    bool run_one();
+    // ждать обнуления counter: пока есть задачи - выполнять их, после короткого ожидания - спать
+    // до новой задачи или обнуления, не занимая ядро
+    void wait(const std::atomic<uint64_t>& counter);
+    // уменьшить counter и разбудить ждущих; после уменьшения counter может быть уже удалён
+    void finish(std::atomic<uint64_t>& counter);
+    uint64_t get_thread_count() const;
+};
+
+// Группа задач: wait() выполняет задачи пула, пока они есть, и засыпает, только когда их нет,
+// поэтому группы можно вкладывать друг в друга и ждать из любого потока.
+class TaskGroup {
+private:
+    CpuPool& pool;
+    std::atomic<uint64_t> pending = 0;
+
+public:
+    explicit TaskGroup(CpuPool& pool);
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+    ~TaskGroup();
+
+    void run(CpuPool::Task task);
+    void wait();
+};
+
+// body(begin, end) вызывается для непересекающихся отрезков [0, count) не короче grain.
+// Отрезки разбираются потоками по общему счётчику, на вызов - одна защёлка и не более
+// get_thread_count() задач в пуле, без выделений памяти на элемент.
+void parallel_for(CpuPool& pool, uint64_t count, uint64_t grain, const std::function<void(uint64_t, uint64_t)>& body);
+
+// Отложенное удаление по эпохам: читатель отмечается в счётчике своей эпохи, ничего не блокируя,
+// писатель не ждёт читателей - снятые с публикации объекты удаляются в reclaim(),
+// когда из эпохи, в которой они были видны, ушёл последний читатель.
+class EpochDomain {
+private:
+    std::atomic<uint64_t> epoch = 0;
+    std::array<std::atomic<uint64_t>, 2> readers {};
+
+    std::mutex retired_lock;
+    std::array<std::vector<std::function<void()>>, 2> retired;
+
+public:
+    class Guard {
+    private:
+        std::atomic<uint64_t>* counter;
+
+    public:
+        explicit Guard(EpochDomain& domain);
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard();
+    };
+
+    EpochDomain() = default;
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+    ~EpochDomain();
+
+    // объект уже недоступен новым читателям, deleter вызовется после ухода старых
+    void retire(std::function<void()> deleter);
+    void reclaim();
+};
+
+// Неизменяемый снимок данных (RCU): читатели не берут блокировок и ничего не копируют,
+// писатель публикует новую версию, а старую удаляет EpochDomain после ухода всех её читателей.
+template <typename T>
+class RcuSnapshot {
+private:
+    EpochDomain domain;
+    std::atomic<const T*> current;
+
+public:
+    class Reader {
+    private:
+        EpochDomain::Guard guard;
+        const T* data;
+
+    public:
+        explicit Reader(RcuSnapshot& snapshot)
+            : guard(snapshot.domain)
+            , data(snapshot.current.load())
+        {
+        }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const T& operator*() const { return *data; }
+        const T* operator->() const { return data; }
+    };
+
+    RcuSnapshot()
+        : current(new T())
+    {
+    }
+    RcuSnapshot(const RcuSnapshot&) = delete;
+    RcuSnapshot& operator=(const RcuSnapshot&) = delete;
+
+    ~RcuSnapshot()
+    {
+        delete current.load();
+    }
+
+    Reader read()
+    {
+        return Reader(*this);
+    }
+
+    void publish(T value)
+    {
+        const T* prev = current.exchange(new T(std::move(value)));
+        domain.retire([prev] { delete prev; });
+    }
+};
+
 }
 
 #endif /* META_POOL_HPP */
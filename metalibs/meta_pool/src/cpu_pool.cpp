@@ -0,0 +1,229 @@
+#include <meta_pool.hpp>
+
+#include <algorithm>
+
+namespace metahash::pool {
+
+thread_local CpuPool* CpuPool::current_pool = nullptr;
+thread_local uint64_t CpuPool::current_worker = 0;
+
+CpuPool::CpuPool(uint64_t thread_count)
+{
+    thread_count = std::max<uint64_t>(thread_count, 1);
+    for (uint64_t i = 0; i < thread_count; i++) {
+        workers.emplace_back(new Worker);
+    }
+    for (uint64_t i = 0; i < thread_count; i++) {
+        threads.emplace_back(&CpuPool::worker_loop, this, i);
+    }
+}
+
+CpuPool::~CpuPool()
+{
+    {
+        std::lock_guard lock(sleep_lock);
+        stop = true;
+    }
+    wake_up.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void CpuPool::post(Task task)
+{
+    if (current_pool == this) {
+        auto& worker = *workers[current_worker];
+        std::lock_guard lock(worker.lock);
+        worker.tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard lock(injected_lock);
+        injected.push_back(std::move(task));
+    }
+    queued++;
+
+    {
+        std::lock_guard lock(sleep_lock);
+    }
+    wake_up.notify_one();
+}
+
+bool CpuPool::pop(Task& task)
+{
+    if (queued.load() == 0) {
+        return false;
+    }
+
+    // своя очередь с конца - последние поставленные задачи ещё в кэше
+    if (current_pool == this) {
+        auto& worker = *workers[current_worker];
+        std::lock_guard lock(worker.lock);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard lock(injected_lock);
+        if (!injected.empty()) {
+            task = std::move(injected.front());
+            injected.pop_front();
+            queued--;
+            return true;
+        }
+    }
+
+    // чужие очереди с начала - там самые крупные, ещё не разделённые задачи
+    const uint64_t start = current_pool == this ? current_worker + 1 : 0;
+    for (uint64_t i = 0; i < workers.size(); i++) {
+        auto& worker = *workers[(start + i) % workers.size()];
+        std::lock_guard lock(worker.lock);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool CpuPool::run_one()
+{
+    Task task;
+    if (pop(task)) {
+        task();
+        return true;
+    }
+    return false;
+}
+
+void CpuPool::wait(const std::atomic<uint64_t>& counter)
+{
+    // недолго ждём без сна: короткие задачи других потоков обычно успевают закончиться
+    const uint64_t SPIN_COUNT = 64;
+
+    uint64_t idle = 0;
+    while (counter.load() != 0) {
+        if (run_one()) {
+            idle = 0;
+            continue;
+        }
+
+        if (idle++ < SPIN_COUNT) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock lock(sleep_lock);
+        wake_up.wait(lock, [this, &counter] { return counter.load() == 0 || queued.load() != 0; });
+        idle = 0;
+    }
+}
+
+void CpuPool::finish(std::atomic<uint64_t>& counter)
+{
+    // уменьшение под sleep_lock: ждущий не может проверить counter и уснуть между ним и notify
+    {
+        std::lock_guard lock(sleep_lock);
+        counter.fetch_sub(1);
+    }
+    wake_up.notify_all();
+}
+
+uint64_t CpuPool::get_thread_count() const
+{
+    return threads.size();
+}
+
+void CpuPool::worker_loop(uint64_t index)
+{
+    current_pool = this;
+    current_worker = index;
+
+    while (!stop) {
+        if (run_one()) {
+            continue;
+        }
+
+        std::unique_lock lock(sleep_lock);
+        wake_up.wait(lock, [this] { return stop || queued.load() != 0; });
+    }
+}
+
+TaskGroup::TaskGroup(CpuPool& pool)
+    : pool(pool)
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    wait();
+}
+
+void TaskGroup::run(CpuPool::Task task)
+{
+    pending++;
+    // после finish группа может быть уже удалена, поэтому this не захватывается
+    pool.post([&pool = pool, &pending = pending, task = std::move(task)] {
+        task();
+        pool.finish(pending);
+    });
+}
+
+void TaskGroup::wait()
+{
+    pool.wait(pending);
+}
+
+void parallel_for(CpuPool& pool, uint64_t count, uint64_t grain, const std::function<void(uint64_t, uint64_t)>& body)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // отрезок не короче grain, но и не мельче, чем нужно для выравнивания нагрузки:
+    // иначе общий счётчик становится узким местом на дешёвой работе
+    const uint64_t PARTS_PER_THREAD = 8;
+    const uint64_t participants = pool.get_thread_count() + 1;
+    const uint64_t step = std::max<uint64_t>({ grain, count / (participants * PARTS_PER_THREAD), 1 });
+    const uint64_t helpers = std::min(participants - 1, (count + step - 1) / step - 1);
+
+    // всё состояние вызова на стеке: счётчик отрезков и защёлка помощников
+    struct State {
+        CpuPool& pool;
+        const std::function<void(uint64_t, uint64_t)>& body;
+        const uint64_t count;
+        const uint64_t step;
+        std::atomic<uint64_t> next = 0;
+        std::atomic<uint64_t> active;
+
+        void run()
+        {
+            uint64_t begin;
+            while ((begin = next.fetch_add(step)) < count) {
+                body(begin, std::min(count, begin + step));
+            }
+        }
+    } state { pool, body, count, step, 0, helpers };
+
+    // замыкание из одной ссылки помещается в std::function без выделения памяти
+    for (uint64_t i = 0; i < helpers; i++) {
+        pool.post([&state] {
+            state.run();
+            // после finish состояние может быть уже снято со стека
+            CpuPool& pool = state.pool;
+            pool.finish(state.active);
+        });
+    }
+
+    state.run();
+    pool.wait(state.active);
+}
+
+}
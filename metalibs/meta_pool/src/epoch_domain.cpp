@@ -0,0 +1,64 @@
+#include <meta_pool.hpp>
+
+namespace metahash::pool {
+
+EpochDomain::Guard::Guard(EpochDomain& domain)
+{
+    // если писатель успел сменить эпоху между чтением и отметкой, отмечаемся заново
+    while (true) {
+        uint64_t current = domain.epoch.load();
+        counter = &domain.readers[current & 1];
+        counter->fetch_add(1);
+        if (domain.epoch.load() == current) {
+            break;
+        }
+        counter->fetch_sub(1);
+    }
+}
+
+EpochDomain::Guard::~Guard()
+{
+    counter->fetch_sub(1);
+}
+
+EpochDomain::~EpochDomain()
+{
+    for (auto& list : retired) {
+        for (auto& deleter : list) {
+            deleter();
+        }
+    }
+}
+
+void EpochDomain::retire(std::function<void()> deleter)
+{
+    {
+        std::lock_guard lock(retired_lock);
+        retired[epoch.load() & 1].push_back(std::move(deleter));
+    }
+    reclaim();
+}
+
+void EpochDomain::reclaim()
+{
+    std::vector<std::function<void()>> expired;
+    {
+        std::lock_guard lock(retired_lock);
+        uint64_t current = epoch.load();
+
+        // читатели прошлой эпохи ещё работают - подождём следующего вызова
+        if (readers[(current + 1) & 1].load() != 0) {
+            return;
+        }
+
+        // снятое в прошлой эпохе новым читателям уже не видно, старых не осталось
+        expired.swap(retired[(current + 1) & 1]);
+        epoch.store(current + 1);
+    }
+
+    for (auto& deleter : expired) {
+        deleter();
+    }
+}
+
+}
@@ -0,0 +1,91 @@
+#include <meta_pool.hpp>
+#include <meta_test.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <iostream>
+
+using namespace metahash;
+using test::check;
+
+namespace {
+
+const auto LONG_TASK = std::chrono::milliseconds(300);
+// ждущий поток может немного покрутиться перед сном, но не всё время длинной задачи
+const double MAX_WAIT_CPU_MS = 50;
+
+double thread_cpu_ms()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+void check_task_group_sleeps(pool::CpuPool& cpu_pool)
+{
+    std::atomic<bool> started = false;
+    pool::TaskGroup group(cpu_pool);
+    group.run([&started] {
+        started = true;
+        std::this_thread::sleep_for(LONG_TASK);
+    });
+
+    // задачу должен забрать поток пула, иначе ждать будет нечего
+    while (!started) {
+        std::this_thread::yield();
+    }
+
+    double start = thread_cpu_ms();
+    group.wait();
+    double spent = thread_cpu_ms() - start;
+    check(spent < MAX_WAIT_CPU_MS, "TaskGroup::wait spent " + std::to_string(spent) + " ms of CPU");
+}
+
+void check_parallel_for_sleeps(pool::CpuPool& cpu_pool)
+{
+    const auto caller = std::this_thread::get_id();
+
+    double start = thread_cpu_ms();
+    pool::parallel_for(cpu_pool, 2, 1, [caller](uint64_t, uint64_t) {
+        if (std::this_thread::get_id() != caller) {
+            std::this_thread::sleep_for(LONG_TASK);
+        }
+    });
+    double spent = thread_cpu_ms() - start;
+    check(spent < MAX_WAIT_CPU_MS, "parallel_for spent " + std::to_string(spent) + " ms of CPU");
+}
+
+void check_nested(pool::CpuPool& cpu_pool)
+{
+    const uint64_t OUTER = 64;
+    const uint64_t INNER = 1000;
+
+    std::atomic<uint64_t> sum = 0;
+    pool::TaskGroup group(cpu_pool);
+    for (uint64_t i = 0; i < OUTER; i++) {
+        group.run([&cpu_pool, &sum] {
+            pool::parallel_for(cpu_pool, INNER, 8, [&sum](uint64_t begin, uint64_t end) {
+                for (uint64_t j = begin; j < end; j++) {
+                    sum += j;
+                }
+            });
+        });
+    }
+    group.wait();
+    check(sum == OUTER * INNER * (INNER - 1) / 2, "nested parallel_for lost work: " + std::to_string(sum));
+}
+
+}
+
+int main()
+{
+    pool::CpuPool cpu_pool(2);
+
+    check_task_group_sleeps(cpu_pool);
+    check_parallel_for_sleeps(cpu_pool);
+    for (uint64_t i = 0; i < 100; i++) {
+        check_nested(cpu_pool);
+    }
+
+    return test::result();
+}
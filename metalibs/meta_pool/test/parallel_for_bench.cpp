@@ -0,0 +1,87 @@
+#include <meta_pool.hpp>
+
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <list>
+
+using namespace metahash;
+
+namespace {
+
+const uint64_t ITEM_COUNT = 50000;
+const uint64_t REPEAT_COUNT = 20;
+const uint64_t GRAIN = 16;
+
+uint64_t work(uint64_t i, uint64_t iterations)
+{
+    uint64_t x = i * 0x9E3779B97F4A7C15ull;
+    for (uint64_t k = 0; k < iterations; k++) {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+    }
+    return x;
+}
+
+template <typename F>
+double measure_ms(F&& run)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t r = 0; r < REPEAT_COUNT; r++) {
+        run();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / REPEAT_COUNT;
+}
+
+}
+
+int main()
+{
+    std::vector<uint64_t> out(ITEM_COUNT);
+
+    for (uint64_t thread_count : { 1, 3 }) {
+        pool::CpuPool cpu_pool(thread_count);
+
+        for (uint64_t iterations : { 0, 50, 500 }) {
+            // прежняя схема: задача и promise на каждый элемент
+            double promise_ms = measure_ms([&] {
+                std::list<std::future<void>> futures;
+                for (uint64_t i = 0; i < ITEM_COUNT; i++) {
+                    auto promise = std::make_shared<std::promise<void>>();
+                    futures.emplace_back(promise->get_future());
+                    cpu_pool.post([&out, i, iterations, promise] {
+                        out[i] = work(i, iterations);
+                        promise->set_value();
+                    });
+                }
+                for (auto& future : futures) {
+                    future.get();
+                }
+            });
+
+            double task_group_ms = measure_ms([&] {
+                pool::TaskGroup group(cpu_pool);
+                for (uint64_t i = 0; i < ITEM_COUNT; i++) {
+                    group.run([&out, i, iterations] {
+                        out[i] = work(i, iterations);
+                    });
+                }
+                group.wait();
+            });
+
+            double parallel_for_ms = measure_ms([&] {
+                pool::parallel_for(cpu_pool, ITEM_COUNT, GRAIN, [&out, iterations](uint64_t begin, uint64_t end) {
+                    for (uint64_t i = begin; i < end; i++) {
+                        out[i] = work(i, iterations);
+                    }
+                });
+            });
+
+            std::cout << "threads=" << thread_count
+                      << " iterations=" << iterations
+                      << " promise_ms=" << promise_ms
+                      << " task_group_ms=" << task_group_ms
+                      << " parallel_for_ms=" << parallel_for_ms << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <meta_pool.hpp>
+#include <meta_test.hpp>
+
+#include <iostream>
+
+using namespace metahash;
+using test::check;
+
+namespace {
+
+const uint64_t VERSION_COUNT = 200000;
+const uint64_t READER_COUNT = 4;
+
+std::vector<std::atomic<bool>> freed(VERSION_COUNT + 1);
+
+struct Version {
+    uint64_t number = 0;
+    std::array<uint64_t, 16> values {};
+
+    Version() = default;
+    explicit Version(uint64_t number)
+        : number(number)
+    {
+        values.fill(number);
+    }
+    Version(Version&& other)
+        : number(other.number)
+        , values(other.values)
+    {
+        other.number = 0;
+    }
+
+    ~Version()
+    {
+        if (number) {
+            freed[number] = true;
+        }
+    }
+};
+
+}
+
+int main()
+{
+    pool::RcuSnapshot<Version> snapshot;
+
+    std::atomic<bool> stop = false;
+    std::atomic<uint64_t> torn = 0;
+    std::atomic<uint64_t> use_after_free = 0;
+    std::atomic<uint64_t> reads = 0;
+
+    std::vector<std::thread> readers;
+    for (uint64_t r = 0; r < READER_COUNT; r++) {
+        readers.emplace_back([&] {
+            uint64_t local_reads = 0;
+            while (!stop) {
+                auto version = snapshot.read();
+                uint64_t number = version->number;
+                for (auto value : version->values) {
+                    if (value != number) {
+                        torn++;
+                    }
+                }
+                // пока Reader жив, его версия не должна быть удалена
+                if (number && freed[number]) {
+                    use_after_free++;
+                }
+                local_reads++;
+            }
+            reads += local_reads;
+        });
+    }
+
+    // писатель публикует, держа собственный Reader: publish() не ждёт читателей
+    for (uint64_t number = 1; number <= VERSION_COUNT; number++) {
+        auto held = snapshot.read();
+        snapshot.publish(Version(number));
+        check(!held->number || !freed[held->number], "version freed under the publishing thread's reader");
+    }
+
+    stop = true;
+    for (auto& thread : readers) {
+        thread.join();
+    }
+
+    check(torn == 0, "reader saw a partially written version");
+    check(use_after_free == 0, "version freed while a reader held it");
+    check(reads > 0, "readers made no progress");
+
+    // без читателей старые версии удаляются следующими публикациями
+    snapshot.publish(Version());
+    snapshot.publish(Version());
+    uint64_t freed_count = 0;
+    for (uint64_t number = 1; number <= VERSION_COUNT; number++) {
+        freed_count += freed[number];
+    }
+    check(freed_count == VERSION_COUNT, "old versions were not reclaimed: " + std::to_string(freed_count));
+
+    std::cout << "reads=" << reads << std::endl;
+    return test::result();
+}
@@ -0,0 +1,31 @@
+#ifndef META_TEST_HPP
+#define META_TEST_HPP
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace metahash::test {
+
+inline uint64_t case_count = 0;
+inline uint64_t fail_count = 0;
+
+inline void check(bool condition, const std::string& message)
+{
+    case_count++;
+    if (!condition) {
+        fail_count++;
+        std::cerr << "FAIL: " << message << std::endl;
+    }
+}
+
+// итог теста, возвращается из main
+inline int result()
+{
+    std::cout << case_count << " cases, " << fail_count << " failures" << std::endl;
+    return fail_count ? 1 : 0;
+}
+
+}
+
+#endif // META_TEST_HPP
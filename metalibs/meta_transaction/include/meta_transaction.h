@@ -4,7 +4,10 @@
 #include <array>
 #include <deque>
 #include <map>
+#include <set>
 #include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <meta_crypto.h>
@@ -53,6 +56,8 @@ public:
     ~TX();
 
     bool parse(std::string_view raw_data, bool check_sign_flag = true);
+    // хеш уже посчитан пачкой вместе с соседними транзакциями блока
+    bool parse(std::string_view raw_data, const sha256_2& tx_hash, bool check_sign_flag = true);
 
     bool fill_from_strings(
         std::string& param_to,
@@ -76,22 +81,18 @@ public:
         if (param_to.size() != 25)
             return false;
         std::vector<char> _raw_tx;
+        crypto::ByteWriter writer(_raw_tx);
+        writer.reserve(param_to.size() + param_data.size() + param_sign.size() + param_pub_key.size() + 6 * 9);
 
-        //        uint64_t bin_to_index = _raw_tx.size();
-        _raw_tx.insert(_raw_tx.end(), param_to.begin(), param_to.end());
+        writer.write(param_to);
 
-        crypto::append_varint(_raw_tx, param_value);
-        crypto::append_varint(_raw_tx, param_fee);
-        crypto::append_varint(_raw_tx, param_nonce);
+        writer.write_varint(param_value);
+        writer.write_varint(param_fee);
+        writer.write_varint(param_nonce);
 
-        crypto::append_varint(_raw_tx, param_data.size());
-        _raw_tx.insert(_raw_tx.end(), param_data.begin(), param_data.end());
-
-        crypto::append_varint(_raw_tx, param_sign.size());
-        _raw_tx.insert(_raw_tx.end(), param_sign.begin(), param_sign.end());
-
-        crypto::append_varint(_raw_tx, param_pub_key.size());
-        _raw_tx.insert(_raw_tx.end(), param_pub_key.begin(), param_pub_key.end());
+        writer.write_frame(param_data);
+        writer.write_frame(param_sign);
+        writer.write_frame(param_pub_key);
 
         std::string_view tx_sw(_raw_tx.data(), _raw_tx.size());
 
@@ -101,6 +102,7 @@ public:
 private:
     void clear();
     bool check_tx();
+    bool parse_tx(std::string_view raw_data, const sha256_2* tx_hash, bool check_sign_flag);
 };
 
 struct ApproveRecord {
@@ -110,7 +112,7 @@ struct ApproveRecord {
     std::string_view pub_key;
     bool approve;
 
-    bool parse(std::string_view);
+    bool parse(std::string_view, bool check_sign_flag = true);
     bool make(const sha256_2& approving_block_hash, crypto::Signer& signer);
     
     sha256_2 get_block_hash() const;
@@ -125,6 +127,61 @@ struct RejectedTXInfo {
     bool make(const sha256_2& tx_hash, uint64_t reason);
 };
 
+class Mempool {
+private:
+    using SenderQueue = std::multimap<uint64_t, TX*>;
+
+    struct Entry {
+        TX* tx;
+        SenderQueue::iterator sender_it;
+    };
+
+    // приоритет транзакции и её отправитель
+    using Head = std::pair<uint64_t, const std::string*>;
+    struct HeadLess {
+        bool operator()(const Head& lh, const Head& rh) const;
+    };
+
+    std::unordered_map<sha256_2, Entry, crypto::Hasher> by_hash;
+    std::unordered_map<std::string, SenderQueue, crypto::Hasher> by_sender;
+    // первая по nonce транзакция каждого отправителя по приоритету, pull() выдаёт с конца
+    std::set<Head, HeadLess> heads;
+    // последняя по nonce транзакция каждого отправителя по приоритету, вытесняются только они
+    std::set<Head, HeadLess> tails;
+    // выданные в шаблон блока; хеш держится, пока транзакция не применена или не отброшена
+    std::unordered_set<sha256_2, crypto::Hasher> pulled;
+
+    uint64_t bytes = 0;
+
+    const uint64_t max_count;
+    const uint64_t max_bytes;
+
+public:
+    Mempool(uint64_t max_count, uint64_t max_bytes);
+    Mempool(const Mempool&) = delete;
+    Mempool(Mempool&&) = delete;
+    Mempool& operator=(const Mempool& other) = delete;
+    Mempool& operator=(Mempool&& other) = delete;
+
+    ~Mempool();
+
+    bool insert(TX* tx);
+    std::vector<TX*> pull(uint64_t count);
+
+    bool empty() const;
+    uint64_t size() const;
+    uint64_t size_bytes() const;
+    void release(const std::vector<sha256_2>& hashes);
+
+private:
+    static uint64_t priority(const TX* tx);
+    void erase(const sha256_2& hash);
+    void unlink_head(const std::string& sender, const SenderQueue& queue);
+    void link_head(const std::string& sender, const SenderQueue& queue);
+    void unlink_tail(const std::string& sender, const SenderQueue& queue);
+    void link_tail(const std::string& sender, const SenderQueue& queue);
+};
+
 }
 
 #endif // META_TRANSACTION_H
@@ -11,14 +11,12 @@ bool ApproveRecord::make(
     std::vector<char> sign_buff = signer.sign(approving_block_hash);
 
     std::vector<char> record_raw;
+    crypto::ByteWriter writer(record_raw);
+    writer.reserve(approving_block_hash.size() + sign_buff.size() + PubKey.size() + 2 * 9);
 
-    record_raw.insert(record_raw.end(), approving_block_hash.begin(), approving_block_hash.end());
-
-    crypto::append_varint(record_raw, sign_buff.size());
-    record_raw.insert(record_raw.end(), sign_buff.begin(), sign_buff.end());
-
-    crypto::append_varint(record_raw, PubKey.size());
-    record_raw.insert(record_raw.end(), PubKey.begin(), PubKey.end());
+    writer.write(approving_block_hash);
+    writer.write_frame(sign_buff);
+    writer.write_frame(PubKey);
 
     std::string_view record_raw_sw(record_raw.data(), record_raw.size());
     return parse(record_raw_sw);
@@ -0,0 +1,177 @@
+#include <meta_log.hpp>
+#include <meta_transaction.h>
+
+#include <iterator>
+#include <limits>
+
+namespace metahash::transaction {
+
+Mempool::Mempool(uint64_t max_count, uint64_t max_bytes)
+    : max_count(max_count)
+    , max_bytes(max_bytes)
+{
+}
+
+Mempool::~Mempool()
+{
+    for (auto&& [hash, entry] : by_hash) {
+        delete entry.tx;
+    }
+}
+
+bool Mempool::HeadLess::operator()(const Head& lh, const Head& rh) const
+{
+    if (lh.first != rh.first) {
+        return lh.first < rh.first;
+    }
+    return *lh.second < *rh.second;
+}
+
+uint64_t Mempool::priority(const TX* tx)
+{
+    const uint64_t SCALE = 1024;
+    uint64_t tx_size = tx->raw_tx.empty() ? 1 : tx->raw_tx.size();
+
+    // fee * SCALE / tx_size без переполнения, огромная комиссия даёт максимальный приоритет
+    uint64_t whole = tx->fee / tx_size;
+    if (whole > std::numeric_limits<uint64_t>::max() / SCALE) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+    return whole * SCALE + (tx->fee % tx_size) * SCALE / tx_size;
+}
+
+bool Mempool::insert(TX* tx)
+{
+    if (by_hash.find(tx->hash) != by_hash.end() || pulled.find(tx->hash) != pulled.end()) {
+        delete tx;
+        return false;
+    }
+
+    if (tx->raw_tx.size() > max_bytes) {
+        DEBUG_COUT("transaction is too big for mempool");
+        delete tx;
+        return false;
+    }
+
+    uint64_t tx_priority = priority(tx);
+    while (!tails.empty() && (by_hash.size() + 1 > max_count || bytes + tx->raw_tx.size() > max_bytes)) {
+        // вытесняется только последняя по nonce транзакция отправителя:
+        // дыра в середине цепочки заблокировала бы все его следующие транзакции
+        auto victim = tails.begin();
+        if (victim->first >= tx_priority) {
+            DEBUG_COUT("mempool is full");
+            delete tx;
+            return false;
+        }
+
+        auto& victim_queue = by_sender.find(*victim->second)->second;
+        TX* victim_tx = std::prev(victim_queue.end())->second;
+        erase(victim_tx->hash);
+        delete victim_tx;
+    }
+
+    auto& [sender, sender_queue] = *by_sender.try_emplace(tx->addr_from).first;
+    unlink_head(sender, sender_queue);
+    unlink_tail(sender, sender_queue);
+    auto sender_it = sender_queue.insert({ tx->nonce, tx });
+    link_head(sender, sender_queue);
+    link_tail(sender, sender_queue);
+
+    by_hash.insert({ tx->hash, { tx, sender_it } });
+    bytes += tx->raw_tx.size();
+
+    return true;
+}
+
+std::vector<TX*> Mempool::pull(uint64_t count)
+{
+    std::vector<TX*> txs;
+    txs.reserve(std::min<uint64_t>(count, by_hash.size()));
+    // самый выгодный отправитель первым, транзакции одного отправителя по порядку nonce
+    while (txs.size() < count && !heads.empty()) {
+        auto& queue = by_sender.find(*std::prev(heads.end())->second)->second;
+        TX* tx = queue.begin()->second;
+
+        txs.push_back(tx);
+        pulled.insert(tx->hash);
+        erase(tx->hash);
+    }
+
+    return txs;
+}
+
+bool Mempool::empty() const
+{
+    return by_hash.empty();
+}
+
+uint64_t Mempool::size() const
+{
+    return by_hash.size();
+}
+
+uint64_t Mempool::size_bytes() const
+{
+    return bytes;
+}
+
+void Mempool::release(const std::vector<sha256_2>& hashes)
+{
+    for (const auto& hash : hashes) {
+        pulled.erase(hash);
+    }
+}
+
+void Mempool::erase(const sha256_2& hash)
+{
+    auto entry_it = by_hash.find(hash);
+    if (entry_it == by_hash.end()) {
+        return;
+    }
+    auto& entry = entry_it->second;
+
+    auto sender_queue_it = by_sender.find(entry.tx->addr_from);
+    unlink_head(sender_queue_it->first, sender_queue_it->second);
+    unlink_tail(sender_queue_it->first, sender_queue_it->second);
+    sender_queue_it->second.erase(entry.sender_it);
+    if (sender_queue_it->second.empty()) {
+        by_sender.erase(sender_queue_it);
+    } else {
+        link_head(sender_queue_it->first, sender_queue_it->second);
+        link_tail(sender_queue_it->first, sender_queue_it->second);
+    }
+
+    bytes -= entry.tx->raw_tx.size();
+
+    by_hash.erase(entry_it);
+}
+
+void Mempool::unlink_head(const std::string& sender, const SenderQueue& queue)
+{
+    if (!queue.empty()) {
+        heads.erase({ priority(queue.begin()->second), &sender });
+    }
+}
+
+void Mempool::link_head(const std::string& sender, const SenderQueue& queue)
+{
+    if (!queue.empty()) {
+        heads.insert({ priority(queue.begin()->second), &sender });
+    }
+}
+
+void Mempool::unlink_tail(const std::string& sender, const SenderQueue& queue)
+{
+    if (!queue.empty()) {
+        tails.erase({ priority(std::prev(queue.end())->second), &sender });
+    }
+}
+
+void Mempool::link_tail(const std::string& sender, const SenderQueue& queue)
+{
+    if (!queue.empty()) {
+        tails.insert({ priority(std::prev(queue.end())->second), &sender });
+    }
+}
+
+}
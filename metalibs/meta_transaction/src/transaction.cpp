@@ -3,19 +3,6 @@
 
 namespace metahash::transaction {
 
-bool read_varint(std::vector<char>& data, uint64_t& index, uint64_t& varint)
-{
-    uint8_t varint_size;
-    std::string_view varint_arr(&data[index], data.size() - index);
-    varint_size = crypto::read_varint(varint, varint_arr);
-    if (varint_size < 1) {
-        DEBUG_COUT("corrupt varint size");
-        return false;
-    }
-    index += varint_size;
-    return true;
-}
-
 bool TX::fill_from_strings(
     std::string& param_to,
     std::string param_value,
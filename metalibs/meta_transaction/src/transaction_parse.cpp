@@ -6,112 +6,104 @@
 
 namespace metahash::transaction {
 
-bool read_varint(std::vector<char>& data, uint64_t& index, uint64_t& varint)
+bool TX::parse(std::string_view raw_data, bool check_sign_flag)
 {
-    uint8_t varint_size;
-    std::string_view varint_arr(&data[index], data.size() - index);
-    varint_size = crypto::read_varint(varint, varint_arr);
-    if (varint_size < 1) {
-        DEBUG_COUT("corrupt varint size");
-        return false;
-    }
-    index += varint_size;
-    return true;
+    return parse_tx(raw_data, nullptr, check_sign_flag);
 }
 
-bool TX::parse(std::string_view raw_data, bool check_sign_flag)
+bool TX::parse(std::string_view raw_data, const sha256_2& tx_hash, bool check_sign_flag)
+{
+    return parse_tx(raw_data, &tx_hash, check_sign_flag);
+}
+
+bool TX::parse_tx(std::string_view raw_data, const sha256_2* tx_hash, bool check_sign_flag)
 {
     raw_tx.insert(raw_tx.end(), raw_data.begin(), raw_data.end());
 
-    uint64_t index = 0;
-    uint8_t varint_size;
+    crypto::ByteReader reader(std::string_view(raw_tx.data(), raw_tx.size()));
+    std::string_view field;
     uint64_t sign_data_size = 0;
 
     {
         const uint8_t toadr_size = 25;
-        if (index + toadr_size >= raw_tx.size()) {
+        if (reader.remaining() <= toadr_size) {
             DEBUG_COUT("corrupt addres size");
             return false;
         }
-        bin_to = std::string_view(&raw_tx[index], toadr_size);
-        index += toadr_size;
+        reader.read(field, toadr_size);
+        bin_to = field;
     }
 
-    if (!read_varint(raw_tx, index, value)) {
+    if (!reader.read_varint(value)) {
         DEBUG_COUT("corrupt value");
         return false;
     }
 
-    if (!read_varint(raw_tx, index, fee)) {
+    if (!reader.read_varint(fee)) {
         DEBUG_COUT("corrupt fee");
         return false;
     }
 
-    if (!read_varint(raw_tx, index, nonce)) {
+    if (!reader.read_varint(nonce)) {
         DEBUG_COUT("corrupt nonce");
         return false;
     }
 
     {
         uint64_t data_size;
-        if (!read_varint(raw_tx, index, data_size)) {
+        if (!reader.read_varint(data_size)) {
             DEBUG_COUT("corrupt data_size");
             return false;
         }
 
-        if (index + data_size >= raw_tx.size()) {
+        if (reader.remaining() <= data_size) {
             DEBUG_COUT("corrupt data size");
             return false;
         }
-        data = std::string_view(&raw_tx[index], data_size);
-        index += data_size;
+        reader.read(field, data_size);
+        data = field;
 
-        sign_data_size = index;
+        sign_data_size = reader.position();
     }
 
     {
         uint64_t sign_size;
-        if (!read_varint(raw_tx, index, sign_size)) {
+        if (!reader.read_varint(sign_size)) {
             DEBUG_COUT("corrupt sign_size");
             return false;
         }
 
-        if (index + sign_size >= raw_tx.size()) {
+        if (reader.remaining() <= sign_size) {
             DEBUG_COUT("corrupt sign size");
             return false;
         }
-        sign = std::string_view(&raw_tx[index], sign_size);
-        index += sign_size;
+        reader.read(field, sign_size);
+        sign = field;
     }
 
     {
         uint64_t pubk_size;
-        if (!read_varint(raw_tx, index, pubk_size)) {
+        if (!reader.read_varint(pubk_size)) {
             DEBUG_COUT("corrupt pubk_size");
             return false;
         }
 
-        if (pubk_size && (index + pubk_size > raw_tx.size())) {
+        if (!reader.read(field, pubk_size)) {
             DEBUG_COUT("corrupt pub_key size");
             return false;
         }
-        pub_key = std::string_view(&raw_tx[index], pubk_size);
-        index += pubk_size;
+        pub_key = field;
     }
 
-    tx_size = index;
+    tx_size = reader.position();
 
-    if (index < raw_tx.size()) {
-        std::string_view varint_arr(&raw_tx[index], raw_tx.size() - index);
-        varint_size = crypto::read_varint(state, varint_arr);
-        if (varint_size < 1) {
-            DEBUG_COUT("corrupt varint size - could not read tx state");
-        }
+    if (reader.remaining() && !reader.read_varint(state)) {
+        DEBUG_COUT("corrupt varint size - could not read tx state");
     }
 
     {
         data_for_sign = std::string_view(&raw_tx[0], sign_data_size);
-        hash = crypto::get_sha256(raw_tx);
+        hash = tx_hash ? *tx_hash : crypto::get_sha256(raw_tx);
     }
 
     check_sign_flag = state != TX_STATE_FEE && check_sign_flag;
@@ -0,0 +1,87 @@
+#include <meta_test.hpp>
+#include <meta_transaction.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <random>
+
+using namespace metahash;
+using test::check;
+
+namespace {
+
+const uint64_t SENDER_COUNT = 64;
+const uint64_t MAX_SENDER_TXS = 6;
+const uint64_t PULL_SIZE = 7;
+
+uint64_t reference_priority(const transaction::TX* tx)
+{
+    return static_cast<unsigned __int128>(tx->fee) * 1024 / tx->raw_tx.size();
+}
+
+transaction::TX* make_tx(const std::string& sender, uint64_t nonce, std::mt19937_64& rng)
+{
+    auto* tx = new transaction::TX;
+    tx->addr_from = sender;
+    tx->nonce = nonce;
+    tx->fee = rng() % 1000;
+    tx->raw_tx.resize(100 + rng() % 300);
+    for (auto& byte : tx->hash) {
+        byte = static_cast<unsigned char>(rng());
+    }
+    return tx;
+}
+
+}
+
+int main()
+{
+    std::mt19937_64 rng(42);
+
+    std::vector<transaction::TX*> txs;
+    for (uint64_t i = 0; i < SENDER_COUNT; i++) {
+        std::string sender = "sender " + std::to_string(i);
+        for (uint64_t nonce = 1, count = 1 + rng() % MAX_SENDER_TXS; nonce <= count; nonce++) {
+            txs.push_back(make_tx(sender, nonce, rng));
+        }
+    }
+    std::shuffle(txs.begin(), txs.end(), rng);
+
+    // ожидаемое содержимое: очереди отправителей по nonce
+    std::map<std::string, std::map<uint64_t, const transaction::TX*>> queues;
+    transaction::Mempool mempool(txs.size(), 1'000'000);
+    for (auto* tx : txs) {
+        queues[tx->addr_from][tx->nonce] = tx;
+        check(mempool.insert(tx), "insert " + tx->addr_from + " nonce " + std::to_string(tx->nonce));
+    }
+
+    uint64_t pulled_count = 0;
+    while (!mempool.empty()) {
+        for (auto* tx : mempool.pull(PULL_SIZE)) {
+            pulled_count++;
+            auto queue_it = queues.find(tx->addr_from);
+            if (queue_it == queues.end()) {
+                check(false, "pulled a transaction of an unknown sender");
+                continue;
+            }
+            auto& queue = queue_it->second;
+            check(queue.begin()->second == tx, "pulled out of nonce order for " + tx->addr_from);
+
+            uint64_t best = 0;
+            for (auto&& [sender, sender_queue] : queues) {
+                best = std::max(best, reference_priority(sender_queue.begin()->second));
+            }
+            check(reference_priority(tx) == best, "pulled a transaction below the best head priority");
+
+            queue.erase(queue.begin());
+            if (queue.empty()) {
+                queues.erase(queue_it);
+            }
+            delete tx;
+        }
+    }
+    check(pulled_count == txs.size(), "pulled " + std::to_string(pulled_count) + " of " + std::to_string(txs.size()));
+
+    return test::result();
+}
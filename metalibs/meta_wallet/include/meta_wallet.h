@@ -3,8 +3,10 @@
 
 #include <deque>
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <meta_crypto.h>
 #include <meta_transaction.h>
@@ -12,82 +14,198 @@
 namespace metahash::meta_wallet {
 
 class Wallet;
+class WalletMap;
+
+// Список делегирований. Порядок записей сохраняется, последняя запись адреса ищется
+// через индекс, удаление помечает запись. Копии разделяют данные до первого изменения.
+class DelegateList {
+public:
+    using Entry = std::pair<std::string, uint64_t>;
 
-class WalletMap {
 private:
-    std::unordered_map<std::string, Wallet*, crypto::Hasher> wallet_map;
-    std::deque<Wallet*> changed_wallets;
+    struct Data {
+        std::vector<Entry> entries;
+        std::vector<uint8_t> erased;
+        std::unordered_map<std::string, std::vector<uint64_t>, crypto::Hasher> positions;
+        uint64_t erased_count = 0;
+    };
+
+    std::shared_ptr<Data> data;
+
+    Data& mutable_data();
 
 public:
-    Wallet* get_wallet(const std::string&);
+    class iterator {
+    private:
+        const Data* data;
+        uint64_t position;
+
+        void skip_erased();
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Entry*;
+        using reference = const Entry&;
+
+        iterator(const Data* data, uint64_t position);
+
+        reference operator*() const;
+        pointer operator->() const;
+        iterator& operator++();
+        iterator operator++(int);
+        bool operator==(const iterator& other) const;
+        bool operator!=(const iterator& other) const;
+    };
 
-    auto begin() { return wallet_map.begin(); }
-    auto end() { return wallet_map.end(); }
+    uint64_t size() const;
+    bool empty() const;
+    bool shares(const DelegateList& other) const;
 
-    void apply_changes();
-    void clear_changes();
+    // Позиция последней записи адреса или -1
+    int64_t find_last(const std::string& addr) const;
+    const Entry& at(uint64_t position) const;
 
-private:
-    Wallet* wallet_factory(const std::string&);
+    void push_back(const std::string& addr, uint64_t value);
+    void pop_back();
+    void erase(uint64_t position);
+    void restore(uint64_t position);
+
+    bool needs_compaction() const;
+    DelegateList compacted() const;
+
+    iterator begin() const;
+    iterator end() const;
 };
 
-class Wallet {
-protected:
-    std::deque<Wallet*>& changed_wallets;
+struct WalletAdditions {
+    bool founder = false;
+    uint64_t used_limit = 0;
+    uint64_t limit = 0;
+
+    uint64_t delegated_from_sum = 0; // сумма средств делегированных этому кошельку
+    uint64_t delegated_to_sum = 0; // сумма средств делегированных этим кошельком
+
+    DelegateList delegated_from; // монеты делегированные с других кошельков
+    DelegateList delegate_to; // монеты делегированные другим кошелькам
+
+    DelegateList delegated_from_daly_snapshot; // монеты делегированные с других кошельков
+    DelegateList delegate_to_daly_snapshot; // монеты делегированные другим кошелькам
+};
 
-    uint64_t transaction_id = 1;
+// Срез кошелька для предварительной проверки входящих транзакций
+struct WalletState {
     uint64_t balance = 0;
+    uint64_t available = 0; // баланс за вычетом делегированных средств
+    uint64_t nonce = 1;
+    bool founder = false;
+    uint64_t limit_left = 0;
+};
 
-    uint64_t real_transaction_id = 1;
-    uint64_t real_balance = 0;
+// Журнал изменений: каждая запись хранит только старое значение изменённого поля,
+// commit() и rollback() работают за O(число изменений).
+class WalletJournal {
+private:
+    enum RecordType : uint8_t {
+        RECORD_VALUE,
+        RECORD_FLAG,
+        RECORD_ADDITION_CREATED,
+        RECORD_ADDITION_DETACHED,
+        RECORD_LIST_PUSH,
+        RECORD_LIST_ERASE,
+        RECORD_LIST_REPLACE,
+    };
+
+    struct Record {
+        RecordType type;
+        void* target;
+        uint64_t value;
+        Wallet* wallet;
+        WalletAdditions* addition;
+    };
 
 public:
-    explicit Wallet(std::deque<Wallet*>&);
-    Wallet(const Wallet&) = delete;
-    Wallet(Wallet&&) = delete;
-    Wallet& operator=(const Wallet& other) = delete;
-    Wallet& operator=(Wallet&& other) = delete;
+    // Отдельный журнал потока; после выполнения сливается в общий через merge()
+    class Segment {
+    private:
+        friend class WalletJournal;
+
+        std::deque<Record> records;
+        std::deque<DelegateList> replaced_lists;
+        std::deque<WalletAdditions*> detached_additions;
+        std::deque<Wallet*> changed_states;
+        std::deque<Wallet*> activated_wallets;
+    };
 
-    virtual ~Wallet() = default;
+private:
+    static thread_local Segment* thread_segment;
 
-    uint64_t get_value();
+    Segment segment;
 
-    virtual std::tuple<uint64_t, uint64_t, std::string> serialize() = 0;
-    virtual bool initialize(uint64_t, uint64_t, const std::string&);
+    Segment& current();
 
-    virtual void add(uint64_t value);
-    virtual uint64_t sub(Wallet* other, transaction::TX const* tx, uint64_t real_fee);
+public:
+    WalletJournal() = default;
+    WalletJournal(const WalletJournal&) = delete;
+    WalletJournal(WalletJournal&&) = delete;
+    WalletJournal& operator=(const WalletJournal& other) = delete;
+    WalletJournal& operator=(WalletJournal&& other) = delete;
 
-    virtual bool try_apply_method(Wallet* other, transaction::TX const* tx) = 0;
+    ~WalletJournal();
 
-    virtual void apply();
-    virtual void clear();
-};
+    void set(uint64_t& field, uint64_t value);
+    void set(bool& field, bool value);
 
-class CommonWallet : public Wallet {
-private:
-    struct WalletAdditions {
-        bool founder = false;
-        uint64_t used_limit = 0;
-        uint64_t limit = 0;
+    void addition_created(Wallet* wallet);
+    void addition_detached(Wallet* wallet);
 
-        uint64_t delegated_from_sum = 0; // сумма средств делегированных этому кошельку
-        uint64_t delegated_to_sum = 0; // сумма средств делегированных этим кошельком
+    void push_back(DelegateList& list, const std::string& addr, uint64_t value);
+    void erase(DelegateList& list, uint64_t index);
+    void replace(DelegateList& list, const DelegateList& new_list);
 
-        uint64_t state = 0;
-        uint64_t trust = 2;
+    // Кошельки, у которых менялось поле state; список не откатывается и может содержать лишние записи
+    void state_changed(Wallet* wallet);
+    std::deque<Wallet*> take_changed_states();
 
-        std::deque<std::pair<std::string, uint64_t>> delegated_from; // монеты делегированные с других кошельков
-        std::deque<std::pair<std::string, uint64_t>> delegate_to; // монеты делегированные другим кошелькам
+    // Кошельки, получившие дополнения, состояние или доверие; список тоже не откатывается
+    void activated(Wallet* wallet);
+    std::deque<Wallet*> take_activated();
 
-        std::deque<std::pair<std::string, uint64_t>> delegated_from_daly_snapshot; // монеты делегированные с других кошельков
-        std::deque<std::pair<std::string, uint64_t>> delegate_to_daly_snapshot; // монеты делегированные другим кошелькам
-    };
+    bool empty();
 
-    WalletAdditions* addition = nullptr;
-    WalletAdditions* real_addition = nullptr;
+    uint64_t savepoint();
+    void rollback_to(uint64_t savepoint);
 
+    static void redirect(Segment* thread_local_segment);
+    void merge(Segment& other);
+
+    void commit();
+    void rollback();
+};
+
+// Кошелёк - ссылка на строку в плотной таблице WalletMap
+class Wallet {
 private:
+    friend class WalletJournal;
+    friend class WalletMap;
+
+    WalletMap& map;
+    const uint64_t index;
+
+    WalletJournal& journal();
+    uint64_t& balance();
+    uint64_t& transaction_id();
+    uint64_t& state();
+    uint64_t& trust();
+    WalletAdditions*& addition();
+
+    void make_addition();
+    void drop_addition();
+
+    void mark_active();
+    bool is_active();
+
     bool try_delegate(Wallet* other, transaction::TX const* tx);
     bool try_undelegate(Wallet* other, transaction::TX const* tx);
     bool register_node(Wallet* other, transaction::TX const* tx);
@@ -95,15 +213,16 @@ private:
     uint64_t get_balance();
 
 public:
-    explicit CommonWallet(std::deque<Wallet*>&);
-    CommonWallet(const CommonWallet&) = delete;
-    CommonWallet(CommonWallet&&) = delete;
-    CommonWallet& operator=(const CommonWallet& other) = delete;
-    CommonWallet& operator=(CommonWallet&& other) = delete;
-
-    ~CommonWallet() override;
+    Wallet(WalletMap&, uint64_t);
+    Wallet(const Wallet&) = delete;
+    Wallet(Wallet&&) = delete;
+    Wallet& operator=(const Wallet& other) = delete;
+    Wallet& operator=(Wallet&& other) = delete;
 
+    const std::string& get_address();
+    uint64_t get_value();
     uint64_t get_delegated_from_sum();
+    WalletState get_wallet_state();
 
     uint64_t get_state();
     void set_state(uint64_t);
@@ -115,22 +234,105 @@ public:
 
     void set_founder_limit();
 
-    std::deque<std::pair<std::string, uint64_t>> get_delegate_to_list();
-    std::deque<std::pair<std::string, uint64_t>> get_delegated_from_list();
+    DelegateList get_delegate_to_list();
+    DelegateList get_delegated_from_list();
 
     void apply_delegates();
 
-    std::tuple<uint64_t, uint64_t, std::string> serialize() override;
-    bool initialize(uint64_t, uint64_t, const std::string& json) override;
+    std::tuple<uint64_t, uint64_t, std::string> serialize();
+    bool initialize(uint64_t, uint64_t, const std::string& json);
+
+    void add(uint64_t value);
+    uint64_t sub(Wallet* other, transaction::TX const* tx, uint64_t real_fee);
 
-    uint64_t sub(Wallet* other, transaction::TX const* tx, uint64_t real_fee) override;
+    bool try_apply_method(Wallet* other, transaction::TX const* tx);
+};
+
+// Кошельки хранятся по столбцам: адрес -> индекс, остальные поля - в отдельных массивах.
+// std::deque не перемещает элементы при добавлении, поэтому ссылки из журнала остаются валидными.
+class WalletMap {
+private:
+    friend class Wallet;
 
-    bool try_apply_method(Wallet* other, transaction::TX const* tx) override;
+    std::unordered_map<std::string, uint64_t, crypto::Hasher> wallet_index;
+    std::deque<const std::string*> addresses;
 
-    void apply() override;
-    void clear() override;
+    std::deque<uint64_t> balances;
+    std::deque<uint64_t> nonces;
+    std::deque<uint64_t> states;
+    std::deque<uint64_t> trusts;
+    std::deque<WalletAdditions*> additions;
+    std::deque<uint8_t> active;
+
+    std::deque<Wallet> wallets;
+
+    // Реестр кошельков, которые затрагивает суточный проход; может содержать лишние записи
+    std::vector<uint64_t> active_indexes;
+    uint64_t active_pruned_size = 0;
+
+    WalletJournal journal;
+
+    void update_active_wallets();
+    void prune_active_wallets();
+
+public:
+    class iterator {
+    private:
+        WalletMap* map;
+        uint64_t index;
+
+    public:
+        iterator(WalletMap* map, uint64_t index)
+            : map(map)
+            , index(index)
+        {
+        }
+
+        std::pair<const std::string&, Wallet*> operator*() const
+        {
+            return { *map->addresses[index], &map->wallets[index] };
+        }
+        iterator& operator++()
+        {
+            index++;
+            return *this;
+        }
+        bool operator!=(const iterator& other) const
+        {
+            return index != other.index;
+        }
+    };
+
+    WalletMap() = default;
+    WalletMap(const WalletMap&) = delete;
+    WalletMap(WalletMap&&) = delete;
+    WalletMap& operator=(const WalletMap& other) = delete;
+    WalletMap& operator=(WalletMap&& other) = delete;
+
+    ~WalletMap();
+
+    Wallet* get_wallet(const std::string&);
+    Wallet* find_wallet(const std::string&);
+    uint64_t size();
+    std::pair<const std::string&, Wallet*> at(uint64_t index);
+    const std::vector<uint64_t>& get_active_wallets();
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, wallets.size()); }
+
+    void apply_changes();
+    void clear_changes();
+
+    WalletJournal& get_journal();
 };
 
+inline WalletJournal& Wallet::journal() { return map.journal; }
+inline uint64_t& Wallet::balance() { return map.balances[index]; }
+inline uint64_t& Wallet::transaction_id() { return map.nonces[index]; }
+inline uint64_t& Wallet::state() { return map.states[index]; }
+inline uint64_t& Wallet::trust() { return map.trusts[index]; }
+inline WalletAdditions*& Wallet::addition() { return map.additions[index]; }
+
 }
 
 #endif // WALLET_H
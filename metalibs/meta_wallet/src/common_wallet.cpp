@@ -4,74 +4,80 @@
 
 namespace metahash::meta_wallet {
 
-CommonWallet::~CommonWallet()
+void Wallet::make_addition()
 {
-    delete real_addition;
-    delete addition;
+    if (!addition()) {
+        addition() = new WalletAdditions();
+        journal().addition_created(this);
+        mark_active();
+    }
+}
+
+void Wallet::mark_active()
+{
+    if (!map.active[index]) {
+        journal().activated(this);
+    }
 }
 
-CommonWallet::CommonWallet(std::deque<Wallet*>& _changed_wallets)
-    : Wallet(_changed_wallets)
+bool Wallet::is_active()
 {
+    return addition() || state() || trust() != 2;
 }
 
-uint64_t CommonWallet::sub(Wallet* other, transaction::TX const* tx, uint64_t real_fee)
+void Wallet::drop_addition()
+{
+    if (addition()) {
+        journal().addition_detached(this);
+        addition() = nullptr;
+    }
+}
+
+uint64_t Wallet::sub(Wallet* other, transaction::TX const* tx, uint64_t real_fee)
 {
     uint64_t total_sub = tx->value + real_fee;
+    auto* wallet_addition = addition();
 
     if (get_balance() < total_sub) {
         DEBUG_COUT("insuficent funds");
         return TX_REJECT_INSUFFICIENT_FUNDS_EXT;
     }
 
-    if (addition && addition->founder && addition->used_limit + total_sub > addition->limit) {
+    if (wallet_addition && wallet_addition->founder && wallet_addition->used_limit + total_sub > wallet_addition->limit) {
         DEBUG_COUT("founder limits");
         return TX_REJECT_FOUNDER_LIMIT;
     }
 
-    uint64_t sub_result = Wallet::sub(other, tx, real_fee);
-
-    if (addition && addition->founder && sub_result == 0) {
-        addition->used_limit += total_sub;
+    if (tx->fee < real_fee) {
+        DEBUG_COUT("insufficient fee");
+        return TX_REJECT_INSUFFICIENT_FEE;
     }
-
-    return sub_result;
-}
-
-void CommonWallet::apply()
-{
-    delete real_addition;
-
-    if (addition) {
-        real_addition = new WalletAdditions(*addition);
-    } else {
-        real_addition = nullptr;
+    if (balance() < total_sub) {
+        DEBUG_COUT("insuficent funds");
+        return TX_REJECT_INSUFFICIENT_FUNDS;
+    }
+    if (transaction_id() != tx->nonce) {
+        DEBUG_COUT("invalid nonce");
+        return TX_REJECT_INVALID_NONCE;
     }
 
-    Wallet::apply();
-}
+    journal().set(balance(), balance() - total_sub);
+    journal().set(transaction_id(), transaction_id() + 1);
 
-void CommonWallet::clear()
-{
-    delete addition;
+    other->add(tx->value);
 
-    if (real_addition) {
-        addition = new WalletAdditions(*real_addition);
-    } else {
-        addition = nullptr;
+    if (wallet_addition && wallet_addition->founder) {
+        journal().set(wallet_addition->used_limit, wallet_addition->used_limit + total_sub);
     }
 
-    Wallet::clear();
+    return 0;
 }
 
-void CommonWallet::set_founder_limit()
+void Wallet::set_founder_limit()
 {
-    if (!addition) {
-        addition = new WalletAdditions();
-    }
-    addition->founder = true;
-    addition->limit += FOUNDER_INITIAL_LIMIT;
-    changed_wallets.push_back(this);
+    make_addition();
+    journal().set(addition()->founder, true);
+    journal().set(addition()->limit, addition()->limit + FOUNDER_INITIAL_LIMIT);
 }
 
-}
\ No newline at end of file
+}
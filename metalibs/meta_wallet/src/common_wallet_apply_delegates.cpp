@@ -3,48 +3,42 @@
 
 namespace metahash::meta_wallet {
 
-void CommonWallet::apply_delegates()
+void Wallet::apply_delegates()
 {
-    if (addition) {
-        changed_wallets.push_back(this);
-
-        addition->delegated_from_daly_snapshot = addition->delegated_from;
-        addition->delegate_to_daly_snapshot = addition->delegate_to;
-
-        if (addition->founder) {
-            addition->limit += FOUNDER_DAILY_LIMIT_UP;
-            return;
+    if (addition()) {
+        if (!addition()->delegated_from_daly_snapshot.shares(addition()->delegated_from)) {
+            journal().replace(addition()->delegated_from_daly_snapshot, addition()->delegated_from);
         }
-        if (addition->state) {
-            return;
+        if (!addition()->delegate_to_daly_snapshot.shares(addition()->delegate_to)) {
+            journal().replace(addition()->delegate_to_daly_snapshot, addition()->delegate_to);
         }
-        if (addition->trust != 2) {
+
+        if (addition()->founder) {
+            journal().set(addition()->limit, addition()->limit + FOUNDER_DAILY_LIMIT_UP);
             return;
         }
-
-        if (addition->delegated_from_sum) {
+        if (addition()->delegated_from_sum) {
             return;
         }
-        if (addition->delegated_to_sum) {
+        if (addition()->delegated_to_sum) {
             return;
         }
 
-        if (!addition->delegated_from.empty()) {
+        if (!addition()->delegated_from.empty()) {
             return;
         }
-        if (!addition->delegate_to.empty()) {
+        if (!addition()->delegate_to.empty()) {
             return;
         }
 
-        if (!addition->delegated_from_daly_snapshot.empty()) {
+        if (!addition()->delegated_from_daly_snapshot.empty()) {
             return;
         }
-        if (!addition->delegate_to_daly_snapshot.empty()) {
+        if (!addition()->delegate_to_daly_snapshot.empty()) {
             return;
         }
 
-        delete addition;
-        addition = nullptr;
+        drop_addition();
     }
 }
 
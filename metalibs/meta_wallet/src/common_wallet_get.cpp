@@ -2,44 +2,49 @@
 
 namespace metahash::meta_wallet {
 
-uint64_t CommonWallet::get_balance()
+uint64_t Wallet::get_balance()
 {
-    if (addition) {
-        return (balance - addition->delegated_to_sum);
+    if (addition()) {
+        return (balance() - addition()->delegated_to_sum);
     }
-    return balance;
+    return balance();
 }
 
-uint64_t CommonWallet::get_delegated_from_sum()
+uint64_t Wallet::get_delegated_from_sum()
 {
-    if (addition) {
-        return addition->delegated_from_sum;
+    if (addition()) {
+        return addition()->delegated_from_sum;
     }
     return 0;
 }
 
-std::deque<std::pair<std::string, uint64_t>> CommonWallet::get_delegate_to_list()
+WalletState Wallet::get_wallet_state()
 {
-    std::deque<std::pair<std::string, uint64_t>> return_list;
-    if (addition) {
-        for (const auto& delegate_to_pair : addition->delegate_to_daly_snapshot) {
-            return_list.emplace_back(delegate_to_pair);
-        }
+    WalletState state;
+    state.balance = balance();
+    state.available = get_balance();
+    state.nonce = transaction_id();
+    if (addition() && addition()->founder) {
+        state.founder = true;
+        state.limit_left = addition()->limit > addition()->used_limit ? addition()->limit - addition()->used_limit : 0;
     }
-
-    return return_list;
+    return state;
 }
 
-std::deque<std::pair<std::string, uint64_t>> CommonWallet::get_delegated_from_list()
+DelegateList Wallet::get_delegate_to_list()
 {
-    std::deque<std::pair<std::string, uint64_t>> return_list;
-    if (addition) {
-        for (const auto& delegated_from_pair : addition->delegated_from_daly_snapshot) {
-            return_list.emplace_back(delegated_from_pair);
-        }
+    if (addition()) {
+        return addition()->delegate_to_daly_snapshot;
     }
+    return DelegateList();
+}
 
-    return return_list;
+DelegateList Wallet::get_delegated_from_list()
+{
+    if (addition()) {
+        return addition()->delegated_from_daly_snapshot;
+    }
+    return DelegateList();
 }
 
-}
\ No newline at end of file
+}
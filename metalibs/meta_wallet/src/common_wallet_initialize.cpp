@@ -5,10 +5,11 @@
 
 namespace metahash::meta_wallet {
 
-bool CommonWallet::initialize(uint64_t value, uint64_t nonce, const std::string& json)
+bool Wallet::initialize(uint64_t value, uint64_t nonce, const std::string& json)
 {
     //    DEBUG_COUT("#");
-    Wallet::initialize(value, nonce, "");
+    journal().set(balance(), value);
+    journal().set(transaction_id(), nonce);
 
     uint64_t state = 0;
     uint64_t trust = 2;
@@ -17,8 +18,8 @@ bool CommonWallet::initialize(uint64_t value, uint64_t nonce, const std::string&
     uint64_t used_limit = 0;
     uint64_t limit = 0;
 
-    std::deque<std::pair<std::string, uint64_t>> delegated_from;
-    std::deque<std::pair<std::string, uint64_t>> delegate_to;
+    DelegateList delegated_from;
+    DelegateList delegate_to;
 
     uint64_t delegated_from_sum = 0;
     uint64_t delegated_to_sum = 0;
@@ -28,12 +29,10 @@ bool CommonWallet::initialize(uint64_t value, uint64_t nonce, const std::string&
         rapidjson::Document rpc_json;
         if (!rpc_json.Parse(json.c_str()).HasParseError()) {
             if (rpc_json.HasMember("state") && rpc_json["state"].IsUint64()) {
-                got_additions = true;
                 state = rpc_json["state"].GetUint64();
             }
 
             if (rpc_json.HasMember("trust") && rpc_json["trust"].IsUint64()) {
-                got_additions = true;
                 trust = rpc_json["trust"].GetUint64() / 5;
             }
 
@@ -57,7 +56,7 @@ bool CommonWallet::initialize(uint64_t value, uint64_t nonce, const std::string&
                     auto& record = d_list[i];
 
                     if (record.HasMember("a") && record["a"].IsString() && record.HasMember("v") && record["v"].IsUint64()) {
-                        delegate_to.emplace_back(std::string(record["a"].GetString(), record["a"].GetStringLength()), record["v"].GetUint64());
+                        delegate_to.push_back(std::string(record["a"].GetString(), record["a"].GetStringLength()), record["v"].GetUint64());
                         delegated_to_sum += record["v"].GetUint64();
                     } else {
                         DEBUG_COUT("invalid pair");
@@ -73,7 +72,7 @@ bool CommonWallet::initialize(uint64_t value, uint64_t nonce, const std::string&
                         auto& record = d_list[i];
 
                         if (record.HasMember("a") && record["a"].IsString() && record.HasMember("v") && record["v"].IsUint64()) {
-                            delegate_to.emplace_back(std::string(record["a"].GetString(), record["a"].GetStringLength()), record["v"].GetUint64());
+                            delegate_to.push_back(std::string(record["a"].GetString(), record["a"].GetStringLength()), record["v"].GetUint64());
                             delegated_to_sum += record["v"].GetUint64();
                         } else {
                             DEBUG_COUT("invalid pair");
@@ -89,7 +88,7 @@ bool CommonWallet::initialize(uint64_t value, uint64_t nonce, const std::string&
                         auto& record = d_list[i];
 
                         if (record.HasMember("a") && record["a"].IsString() && record.HasMember("v") && record["v"].IsUint64()) {
-                            delegated_from.emplace_back(std::string(record["a"].GetString(), record["a"].GetStringLength()), record["v"].GetUint64());
+                            delegated_from.push_back(std::string(record["a"].GetString(), record["a"].GetStringLength()), record["v"].GetUint64());
                             delegated_from_sum += record["v"].GetUint64();
                         } else {
                             DEBUG_COUT("invalid pair");
@@ -107,31 +106,35 @@ bool CommonWallet::initialize(uint64_t value, uint64_t nonce, const std::string&
         }
     }
 
-    delete addition;
-    addition = nullptr;
+    if (this->state() != state) {
+        journal().set(this->state(), state);
+        journal().state_changed(this);
+        mark_active();
+    }
+    if (this->trust() != trust) {
+        journal().set(this->trust(), trust);
+        mark_active();
+    }
+
+    drop_addition();
 
     if (got_additions) {
-        delete addition;
-        addition = new WalletAdditions;
-
-        addition->founder = founder;
-        addition->used_limit = used_limit;
-        addition->limit = limit;
+        make_addition();
 
-        addition->state = state;
-        addition->trust = trust;
+        addition()->founder = founder;
+        addition()->used_limit = used_limit;
+        addition()->limit = limit;
 
-        addition->delegated_from = delegated_from;
-        addition->delegated_from_daly_snapshot = delegated_from;
+        addition()->delegated_from = delegated_from;
+        addition()->delegated_from_daly_snapshot = delegated_from;
 
-        addition->delegate_to = delegate_to;
-        addition->delegate_to_daly_snapshot = delegate_to;
+        addition()->delegate_to = delegate_to;
+        addition()->delegate_to_daly_snapshot = delegate_to;
 
-        addition->delegated_to_sum = delegated_to_sum;
-        addition->delegated_from_sum = delegated_from_sum;
+        addition()->delegated_to_sum = delegated_to_sum;
+        addition()->delegated_from_sum = delegated_from_sum;
     }
 
-    changed_wallets.push_back(this);
     return true;
 }
 
@@ -3,7 +3,7 @@
 
 namespace metahash::meta_wallet {
 
-bool CommonWallet::register_node(Wallet*, const transaction::TX* tx)
+bool Wallet::register_node(Wallet*, const transaction::TX* tx)
 {
     uint64_t w_state = get_state();
 
@@ -4,11 +4,11 @@
 
 namespace metahash::meta_wallet {
 
-std::tuple<uint64_t, uint64_t, std::string> CommonWallet::serialize()
+std::tuple<uint64_t, uint64_t, std::string> Wallet::serialize()
 {
     std::string data;
 
-    if (addition) {
+    if (addition() || state() || trust() != 2) {
         bool has_json = false;
 
         rapidjson::StringBuffer s;
@@ -16,16 +16,16 @@ std::tuple<uint64_t, uint64_t, std::string> CommonWallet::serialize()
 
         writer.StartObject();
 
-        if (addition->founder) {
+        if (addition() && addition()->founder) {
             has_json = true;
             writer.String("used_limit");
-            writer.Uint64(addition->used_limit);
+            writer.Uint64(addition()->used_limit);
 
             writer.String("limit");
-            writer.Uint64(addition->limit);
+            writer.Uint64(addition()->limit);
         }
 
-        if (addition->state || addition->trust != 2) {
+        if (state() || trust() != 2) {
             has_json = true;
             writer.String("state");
             writer.Uint64(get_state());
@@ -34,11 +34,11 @@ std::tuple<uint64_t, uint64_t, std::string> CommonWallet::serialize()
             writer.Uint64(get_trust() * 5);
         }
 
-        if (!addition->delegate_to_daly_snapshot.empty()) {
+        if (addition() && !addition()->delegate_to_daly_snapshot.empty()) {
             has_json = true;
             writer.String("delegate_to");
             writer.StartArray();
-            for (auto&& [a, v] : addition->delegate_to_daly_snapshot) {
+            for (auto&& [a, v] : addition()->delegate_to_daly_snapshot) {
                 writer.StartObject();
                 writer.String("a");
                 writer.String(a.c_str());
@@ -49,11 +49,11 @@ std::tuple<uint64_t, uint64_t, std::string> CommonWallet::serialize()
             writer.EndArray();
         }
 
-        if (!addition->delegated_from_daly_snapshot.empty()) {
+        if (addition() && !addition()->delegated_from_daly_snapshot.empty()) {
             has_json = true;
             writer.String("delegated_from");
             writer.StartArray();
-            for (auto&& [a, v] : addition->delegated_from_daly_snapshot) {
+            for (auto&& [a, v] : addition()->delegated_from_daly_snapshot) {
                 writer.StartObject();
                 writer.String("a");
                 writer.String(a.c_str());
@@ -71,7 +71,7 @@ std::tuple<uint64_t, uint64_t, std::string> CommonWallet::serialize()
         }
     }
 
-    return { balance, transaction_id, data };
+    return { balance(), transaction_id(), data };
 }
 
 }
\ No newline at end of file
@@ -2,66 +2,47 @@
 
 namespace metahash::meta_wallet {
 
-uint64_t CommonWallet::get_state()
+uint64_t Wallet::get_state()
 {
-    if (addition) {
-        return addition->state;
-    }
-    return 0;
+    return state();
 }
 
-void CommonWallet::set_state(uint64_t new_state)
+void Wallet::set_state(uint64_t new_state)
 {
-    if (!addition) {
-        addition = new WalletAdditions();
+    if (state() != new_state) {
+        journal().set(state(), new_state);
+        journal().state_changed(this);
+        mark_active();
     }
-    addition->state = new_state;
-    changed_wallets.push_back(this);
 }
 
-uint64_t CommonWallet::get_trust()
+uint64_t Wallet::get_trust()
 {
-    if (addition) {
-        return addition->trust;
-    }
-
-    return 2;
+    return trust();
 }
 
-void CommonWallet::add_trust()
+void Wallet::add_trust()
 {
-    if (!addition) {
-        addition = new WalletAdditions();
-    }
-    if (addition->trust < 200) {
-        addition->trust++;
+    if (trust() < 200) {
+        journal().set(trust(), trust() + 1);
     } else {
-        addition->trust = 200;
+        journal().set(trust(), 200);
     }
-    changed_wallets.push_back(this);
 }
 
-void CommonWallet::sub_trust()
+void Wallet::sub_trust()
 {
-    if (!addition) {
-        addition = new WalletAdditions();
-    }
-    if (addition->trust >= 12) {
-        addition->trust -= 10;
+    if (trust() >= 12) {
+        journal().set(trust(), trust() - 10);
     } else {
-        addition->trust = 2;
+        journal().set(trust(), 2);
     }
-    changed_wallets.push_back(this);
 }
 
-void CommonWallet::set_trust(uint64_t new_trust)
+void Wallet::set_trust(uint64_t new_trust)
 {
-    if (!addition) {
-        addition = new WalletAdditions();
-    }
-    addition->trust = new_trust;
-
-    changed_wallets.push_back(this);
+    journal().set(trust(), new_trust);
+    mark_active();
 }
 
-}
\ No newline at end of file
+}
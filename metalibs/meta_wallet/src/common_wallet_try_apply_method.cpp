@@ -3,7 +3,7 @@
 
 namespace metahash::meta_wallet {
 
-bool CommonWallet::try_apply_method(Wallet* other, transaction::TX const* tx)
+bool Wallet::try_apply_method(Wallet* other, transaction::TX const* tx)
 {
     if (!tx->json_rpc) {
         //        DEBUG_COUT("no json present");
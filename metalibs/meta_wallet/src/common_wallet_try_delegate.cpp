@@ -4,17 +4,13 @@
 
 namespace metahash::meta_wallet {
 
-bool CommonWallet::try_delegate(Wallet* other, transaction::TX const* tx)
+bool Wallet::try_delegate(Wallet* other, transaction::TX const* tx)
 {
     const auto& addr_to = tx->addr_to;
     const auto& addr_from = tx->addr_from;
     const auto& parameters = tx->json_rpc->parameters;
 
-    auto* wallet_to = dynamic_cast<CommonWallet*>(other);
-    if (!wallet_to) {
-        DEBUG_COUT("invalid wallet type");
-        return false;
-    }
+    auto* wallet_to = other;
 
     if (parameters.find("value") == parameters.end()) {
         DEBUG_COUT("#json error: no value in method parameters");
@@ -58,12 +54,12 @@ bool CommonWallet::try_delegate(Wallet* other, transaction::TX const* tx)
         return false;
     }
 
-    if (addition && addition->delegate_to.size() >= LIMIT_DELEGATE_TO) {
+    if (addition() && addition()->delegate_to.size() >= LIMIT_DELEGATE_TO) {
         DEBUG_COUT("> LIMIT_DELEGATE_TO");
         return false;
     }
 
-    if (wallet_to->addition && wallet_to->addition->delegated_from.size() >= LIMIT_DELEGATE_FROM) {
+    if (wallet_to->addition() && wallet_to->addition()->delegated_from.size() >= LIMIT_DELEGATE_FROM) {
         if (addr_to != MASTER_WALLET_COIN_FORGING
             && addr_to != MASTER_WALLET_NODE_FORGING) {
 
@@ -72,21 +68,15 @@ bool CommonWallet::try_delegate(Wallet* other, transaction::TX const* tx)
         }
     }
 
-    if (!addition) {
-        addition = new WalletAdditions();
-    }
-    if (!wallet_to->addition) {
-        wallet_to->addition = new WalletAdditions();
-    }
+    make_addition();
+    wallet_to->make_addition();
 
-    addition->delegate_to.emplace_back(addr_to, value);
-    addition->delegated_to_sum += value;
+    journal().push_back(addition()->delegate_to, addr_to, value);
+    journal().set(addition()->delegated_to_sum, addition()->delegated_to_sum + value);
 
-    wallet_to->addition->delegated_from.emplace_back(addr_from, value);
-    wallet_to->addition->delegated_from_sum += value;
+    journal().push_back(wallet_to->addition()->delegated_from, addr_from, value);
+    journal().set(wallet_to->addition()->delegated_from_sum, wallet_to->addition()->delegated_from_sum + value);
 
-    changed_wallets.push_back(this);
-    changed_wallets.push_back(wallet_to);
     return true;
 }
 
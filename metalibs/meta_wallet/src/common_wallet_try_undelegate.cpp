@@ -3,66 +3,41 @@
 
 namespace metahash::meta_wallet {
 
-bool CommonWallet::try_undelegate(Wallet* other, transaction::TX const* tx)
+bool Wallet::try_undelegate(Wallet* other, transaction::TX const* tx)
 {
     const auto& addr_to = tx->addr_to;
     const auto& addr_from = tx->addr_from;
 
-    auto* wallet_to = dynamic_cast<CommonWallet*>(other);
-    if (!wallet_to) {
-        DEBUG_COUT("invalid wallet type");
-        return false;
-    }
+    auto* wallet_to = other;
 
-    if (!addition) {
-        DEBUG_COUT("!addition");
+    if (!addition()) {
+        DEBUG_COUT("!addition()");
         return false;
     }
 
-    if (!wallet_to->addition) {
-        DEBUG_COUT("!other.addition");
+    if (!wallet_to->addition()) {
+        DEBUG_COUT("!other.addition()");
         return false;
     }
 
-    int64_t i_to = addition->delegate_to.size() - 1;
-
-    for (; i_to >= 0; i_to--) {
-        std::string f_addr;
-        uint64_t f_value;
-        std::tie(f_addr, f_value) = addition->delegate_to[i_to];
-
-        if (f_addr == addr_to) {
-            break;
-        }
-    }
+    int64_t i_to = addition()->delegate_to.find_last(addr_to);
     if (i_to < 0) {
         DEBUG_COUT("no addr_to");
         return false;
     }
 
-    int64_t i_from = wallet_to->addition->delegated_from.size() - 1;
-    for (; i_from >= 0; i_from--) {
-        std::string f_addr;
-        uint64_t f_value;
-        std::tie(f_addr, f_value) = wallet_to->addition->delegated_from[i_from];
-
-        if (f_addr == addr_from) {
-            break;
-        }
-    }
+    int64_t i_from = wallet_to->addition()->delegated_from.find_last(addr_from);
     if (i_from < 0) {
         DEBUG_COUT("no addr_from");
         return false;
     }
 
-    addition->delegated_to_sum -= addition->delegate_to[i_to].second;
-    addition->delegate_to.erase(addition->delegate_to.begin() + i_to);
+    journal().set(addition()->delegated_to_sum, addition()->delegated_to_sum - addition()->delegate_to.at(i_to).second);
+    journal().erase(addition()->delegate_to, i_to);
 
-    wallet_to->addition->delegated_from_sum -= wallet_to->addition->delegated_from[i_from].second;
-    wallet_to->addition->delegated_from.erase(wallet_to->addition->delegated_from.begin() + i_from);
+    journal().set(wallet_to->addition()->delegated_from_sum, wallet_to->addition()->delegated_from_sum - wallet_to->addition()->delegated_from.at(i_from).second);
+    journal().erase(wallet_to->addition()->delegated_from, i_from);
 
-    changed_wallets.push_back(this);
-    changed_wallets.push_back(wallet_to);
     return true;
 }
 
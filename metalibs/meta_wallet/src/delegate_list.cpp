@@ -0,0 +1,168 @@
+#include <meta_constants.hpp>
+#include <meta_wallet.h>
+
+#include <algorithm>
+
+namespace metahash::meta_wallet {
+
+DelegateList::Data& DelegateList::mutable_data()
+{
+    if (!data) {
+        data = std::make_shared<Data>();
+    } else if (data.use_count() > 1) {
+        data = std::make_shared<Data>(*data);
+    }
+    return *data;
+}
+
+uint64_t DelegateList::size() const
+{
+    return data ? data->entries.size() - data->erased_count : 0;
+}
+
+bool DelegateList::empty() const
+{
+    return size() == 0;
+}
+
+bool DelegateList::shares(const DelegateList& other) const
+{
+    return data == other.data;
+}
+
+int64_t DelegateList::find_last(const std::string& addr) const
+{
+    if (!data) {
+        return -1;
+    }
+    auto it = data->positions.find(addr);
+    if (it == data->positions.end() || it->second.empty()) {
+        return -1;
+    }
+    return it->second.back();
+}
+
+const DelegateList::Entry& DelegateList::at(uint64_t position) const
+{
+    return data->entries[position];
+}
+
+void DelegateList::push_back(const std::string& addr, uint64_t value)
+{
+    auto& d = mutable_data();
+    d.positions[addr].push_back(d.entries.size());
+    d.entries.emplace_back(addr, value);
+    d.erased.push_back(false);
+}
+
+void DelegateList::pop_back()
+{
+    auto& d = mutable_data();
+    auto it = d.positions.find(d.entries.back().first);
+    it->second.pop_back();
+    if (it->second.empty()) {
+        d.positions.erase(it);
+    }
+    d.entries.pop_back();
+    d.erased.pop_back();
+}
+
+void DelegateList::erase(uint64_t position)
+{
+    auto& d = mutable_data();
+    auto& positions = d.positions[d.entries[position].first];
+    for (auto it = positions.rbegin(); it != positions.rend(); it++) {
+        if (*it == position) {
+            positions.erase(std::next(it).base());
+            break;
+        }
+    }
+    if (positions.empty()) {
+        d.positions.erase(d.entries[position].first);
+    }
+    d.erased[position] = true;
+    d.erased_count++;
+}
+
+void DelegateList::restore(uint64_t position)
+{
+    auto& d = mutable_data();
+    auto& positions = d.positions[d.entries[position].first];
+    positions.insert(std::upper_bound(positions.begin(), positions.end(), position), position);
+    d.erased[position] = false;
+    d.erased_count--;
+}
+
+bool DelegateList::needs_compaction() const
+{
+    return data && data->erased_count > DELEGATE_LIST_COMPACT_MIN && data->erased_count * 2 > data->entries.size();
+}
+
+DelegateList DelegateList::compacted() const
+{
+    DelegateList list;
+    for (const auto& [addr, value] : *this) {
+        list.push_back(addr, value);
+    }
+    return list;
+}
+
+DelegateList::iterator DelegateList::begin() const
+{
+    return iterator(data.get(), 0);
+}
+
+DelegateList::iterator DelegateList::end() const
+{
+    return iterator(data.get(), data ? data->entries.size() : 0);
+}
+
+DelegateList::iterator::iterator(const Data* data, uint64_t position)
+    : data(data)
+    , position(position)
+{
+    skip_erased();
+}
+
+void DelegateList::iterator::skip_erased()
+{
+    while (data && position < data->entries.size() && data->erased[position]) {
+        position++;
+    }
+}
+
+DelegateList::iterator::reference DelegateList::iterator::operator*() const
+{
+    return data->entries[position];
+}
+
+DelegateList::iterator::pointer DelegateList::iterator::operator->() const
+{
+    return &data->entries[position];
+}
+
+DelegateList::iterator& DelegateList::iterator::operator++()
+{
+    position++;
+    skip_erased();
+    return *this;
+}
+
+DelegateList::iterator DelegateList::iterator::operator++(int)
+{
+    iterator prev = *this;
+    ++*this;
+    return prev;
+}
+
+bool DelegateList::iterator::operator==(const iterator& other) const
+{
+    return position == other.position;
+}
+
+bool DelegateList::iterator::operator!=(const iterator& other) const
+{
+    return position != other.position;
+}
+
+}
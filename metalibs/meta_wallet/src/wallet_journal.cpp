@@ -0,0 +1,177 @@
+#include <meta_wallet.h>
+
+namespace metahash::meta_wallet {
+
+thread_local WalletJournal::Segment* WalletJournal::thread_segment = nullptr;
+
+WalletJournal::~WalletJournal()
+{
+    commit();
+}
+
+WalletJournal::Segment& WalletJournal::current()
+{
+    return thread_segment ? *thread_segment : segment;
+}
+
+void WalletJournal::set(uint64_t& field, uint64_t value)
+{
+    current().records.push_back({ RECORD_VALUE, &field, field, nullptr, nullptr });
+    field = value;
+}
+
+void WalletJournal::set(bool& field, bool value)
+{
+    current().records.push_back({ RECORD_FLAG, &field, field, nullptr, nullptr });
+    field = value;
+}
+
+void WalletJournal::addition_created(Wallet* wallet)
+{
+    current().records.push_back({ RECORD_ADDITION_CREATED, nullptr, 0, wallet, wallet->addition() });
+}
+
+void WalletJournal::addition_detached(Wallet* wallet)
+{
+    auto& seg = current();
+    seg.records.push_back({ RECORD_ADDITION_DETACHED, nullptr, 0, wallet, wallet->addition() });
+    seg.detached_additions.push_back(wallet->addition());
+}
+
+void WalletJournal::push_back(DelegateList& list, const std::string& addr, uint64_t value)
+{
+    current().records.push_back({ RECORD_LIST_PUSH, &list, 0, nullptr, nullptr });
+    list.push_back(addr, value);
+}
+
+void WalletJournal::erase(DelegateList& list, uint64_t index)
+{
+    current().records.push_back({ RECORD_LIST_ERASE, &list, index, nullptr, nullptr });
+    list.erase(index);
+
+    // перестроение тоже журналируется, чтобы позиции в ранних записях остались верны
+    if (list.needs_compaction()) {
+        replace(list, list.compacted());
+    }
+}
+
+void WalletJournal::replace(DelegateList& list, const DelegateList& new_list)
+{
+    auto& seg = current();
+    seg.records.push_back({ RECORD_LIST_REPLACE, &list, seg.replaced_lists.size(), nullptr, nullptr });
+    seg.replaced_lists.push_back(std::move(list));
+    list = new_list;
+}
+
+void WalletJournal::state_changed(Wallet* wallet)
+{
+    current().changed_states.push_back(wallet);
+}
+
+std::deque<Wallet*> WalletJournal::take_changed_states()
+{
+    std::deque<Wallet*> wallets;
+    wallets.swap(segment.changed_states);
+    return wallets;
+}
+
+void WalletJournal::activated(Wallet* wallet)
+{
+    current().activated_wallets.push_back(wallet);
+}
+
+std::deque<Wallet*> WalletJournal::take_activated()
+{
+    std::deque<Wallet*> wallets;
+    wallets.swap(segment.activated_wallets);
+    return wallets;
+}
+
+bool WalletJournal::empty()
+{
+    return segment.records.empty();
+}
+
+void WalletJournal::redirect(Segment* thread_local_segment)
+{
+    thread_segment = thread_local_segment;
+}
+
+void WalletJournal::merge(Segment& other)
+{
+    uint64_t lists_offset = segment.replaced_lists.size();
+    for (auto& record : other.records) {
+        if (record.type == RECORD_LIST_REPLACE) {
+            record.value += lists_offset;
+        }
+        segment.records.push_back(std::move(record));
+    }
+    for (auto& list : other.replaced_lists) {
+        segment.replaced_lists.push_back(std::move(list));
+    }
+    segment.detached_additions.insert(segment.detached_additions.end(), other.detached_additions.begin(), other.detached_additions.end());
+    segment.changed_states.insert(segment.changed_states.end(), other.changed_states.begin(), other.changed_states.end());
+    segment.activated_wallets.insert(segment.activated_wallets.end(), other.activated_wallets.begin(), other.activated_wallets.end());
+
+    other.records.clear();
+    other.replaced_lists.clear();
+    other.detached_additions.clear();
+    other.changed_states.clear();
+    other.activated_wallets.clear();
+}
+
+void WalletJournal::commit()
+{
+    for (auto* addition : segment.detached_additions) {
+        delete addition;
+    }
+    segment.detached_additions.clear();
+    segment.replaced_lists.clear();
+    segment.records.clear();
+}
+
+void WalletJournal::rollback()
+{
+    rollback_to(0);
+}
+
+uint64_t WalletJournal::savepoint()
+{
+    return segment.records.size();
+}
+
+void WalletJournal::rollback_to(uint64_t savepoint)
+{
+    while (segment.records.size() > savepoint) {
+        auto& record = segment.records.back();
+        switch (record.type) {
+        case RECORD_VALUE:
+            *static_cast<uint64_t*>(record.target) = record.value;
+            break;
+        case RECORD_FLAG:
+            *static_cast<bool*>(record.target) = record.value;
+            break;
+        case RECORD_ADDITION_CREATED:
+            delete record.addition;
+            record.wallet->addition() = nullptr;
+            break;
+        case RECORD_ADDITION_DETACHED:
+            record.wallet->addition() = record.addition;
+            segment.detached_additions.pop_back();
+            break;
+        case RECORD_LIST_PUSH:
+            static_cast<DelegateList*>(record.target)->pop_back();
+            break;
+        case RECORD_LIST_ERASE:
+            static_cast<DelegateList*>(record.target)->restore(record.value);
+            break;
+        case RECORD_LIST_REPLACE:
+            *static_cast<DelegateList*>(record.target) = std::move(segment.replaced_lists[record.value]);
+            segment.replaced_lists.pop_back();
+            break;
+        }
+        segment.records.pop_back();
+    }
+}
+
+}
@@ -3,61 +3,109 @@
 
 namespace metahash::meta_wallet {
 
-Wallet* WalletMap::get_wallet(const std::string& address)
+WalletMap::~WalletMap()
 {
-    if (wallet_map.find(address) == wallet_map.end()) {
-        wallet_map.insert({ address, wallet_factory(address) });
+    for (auto* addition : additions) {
+        delete addition;
     }
-    return wallet_map.at(address);
 }
 
-Wallet* WalletMap::wallet_factory(const std::string& addr)
+Wallet* WalletMap::get_wallet(const std::string& address)
 {
-    auto bin_addr = crypto::hex2bin(addr);
-    if (bin_addr.size() != 25) {
+    auto it = wallet_index.find(address);
+    if (it != wallet_index.end()) {
+        return &wallets[it->second];
+    }
+
+    if (crypto::hex2bin(address).size() != 25) {
         return nullptr;
     }
 
-    uint8_t int_family = bin_addr[0];
+    uint64_t index = wallets.size();
+    it = wallet_index.emplace(address, index).first;
 
-    if (addr == MASTER_WALLET_COIN_FORGING) {
-        return new CommonWallet(changed_wallets);
-    }
-    if (addr == MASTER_WALLET_NODE_FORGING) {
-        return new CommonWallet(changed_wallets);
-    }
-    if (addr == SPECIAL_WALLET_COMISSIONS) {
-        return new CommonWallet(changed_wallets);
+    addresses.push_back(&it->first);
+    balances.push_back(0);
+    nonces.push_back(1);
+    states.push_back(0);
+    trusts.push_back(2);
+    additions.push_back(nullptr);
+    active.push_back(false);
+    wallets.emplace_back(*this, index);
+
+    return &wallets.back();
+}
+
+Wallet* WalletMap::find_wallet(const std::string& address)
+{
+    auto it = wallet_index.find(address);
+    if (it != wallet_index.end()) {
+        return &wallets[it->second];
     }
-    if (addr == STATE_FEE_WALLET) {
-        return new CommonWallet(changed_wallets);
+    return nullptr;
+}
+
+uint64_t WalletMap::size()
+{
+    return wallets.size();
+}
+
+std::pair<const std::string&, Wallet*> WalletMap::at(uint64_t index)
+{
+    return { *addresses[index], &wallets[index] };
+}
+
+const std::vector<uint64_t>& WalletMap::get_active_wallets()
+{
+    update_active_wallets();
+    return active_indexes;
+}
+
+void WalletMap::update_active_wallets()
+{
+    for (auto* wallet : journal.take_activated()) {
+        if (!active[wallet->index]) {
+            active[wallet->index] = true;
+            active_indexes.push_back(wallet->index);
+        }
     }
-    if (addr == ZERO_WALLET) {
-        return new CommonWallet(changed_wallets);
+}
+
+void WalletMap::prune_active_wallets()
+{
+    // только после commit/rollback: откат журнала не возвращает кошельки в реестр
+    update_active_wallets();
+    if (active_indexes.size() < active_pruned_size * 2 + ACTIVE_WALLETS_PRUNE_MIN) {
+        return;
     }
 
-    switch (int_family) {
-    case 0x00:
-        return new CommonWallet(changed_wallets);
-    default:
-        return new CommonWallet(changed_wallets);
+    uint64_t kept = 0;
+    for (auto index : active_indexes) {
+        if (wallets[index].is_active()) {
+            active_indexes[kept++] = index;
+        } else {
+            active[index] = false;
+        }
     }
+    active_indexes.resize(kept);
+    active_pruned_size = kept;
 }
 
 void WalletMap::apply_changes()
 {
-    for (auto wallet : changed_wallets) {
-        wallet->apply();
-    }
-    changed_wallets.clear();
+    journal.commit();
+    prune_active_wallets();
 }
 
 void WalletMap::clear_changes()
 {
-    for (auto wallet : changed_wallets) {
-        wallet->clear();
-    }
-    changed_wallets.clear();
+    journal.rollback();
+    prune_active_wallets();
 }
 
-}
\ No newline at end of file
+WalletJournal& WalletMap::get_journal()
+{
+    return journal;
+}
+
+}